@@ -2,6 +2,8 @@
 #include <skynav_msgs/current_pose.h>
 #include <skynav_msgs/current_velocity.h>
 #include <skynav_msgs/waypoint_check.h>
+#include <skynav_msgs/replan_srv.h>
+#include <skynav_msgs/EdgeTraversal.h>
 #include <string.h>
 #include <list>
 #include <boost/algorithm/string.hpp>
@@ -52,8 +54,8 @@ using namespace std;
 ros::NodeHandle* mNode;
 ros::NodeHandle* mNodeSLAM;
 
-ros::ServiceClient servClientCurrentPose, servClientWaypointCheck, servClientCurrentVelocity;
-ros::Publisher pubCmdVel, pubNavigationState, pubTargetPoseStamped;
+ros::ServiceClient servClientCurrentPose, servClientWaypointCheck, servClientCurrentVelocity, servClientReplan;
+ros::Publisher pubCmdVel, pubNavigationState, pubTargetPoseStamped, pubEdgeTraversal;
 
 list<PoseStamped>* mCurrentPath = new list<PoseStamped>;
 list<PoseStamped>* mOriginalPath = new list<PoseStamped>;
@@ -61,6 +63,14 @@ double mEndOrientation = 0;
 
 bool path_init=false;	//boolean if there is a current path initiated
 
+//the leg between two waypoints of the path that is being driven, reported to global_planner when it ends
+bool mLegActive = false;		//a leg is being driven
+bool mLegHasStart = false;		//a waypoint of the path has been reached, the next leg starts there
+Point mLegFrom;
+Point mLegTo;
+ros::Time mLegStartTime;
+unsigned int mLegAvoidances = 0;
+
 ros::Timer mCmdVelTimeout;
 uint8_t mNavigationState = NAV_READY; 	// initial navigation_state
 uint8_t mMovementState = MOV_READY;		// initial movement_state
@@ -92,6 +102,8 @@ void clearPath()
     mCurrentPath->clear(); 
     mOriginalPath->clear();
     path_init = false;
+    mLegActive = false;
+    mLegHasStart = false;
 }
 
 //update the current path.
@@ -130,6 +142,66 @@ double calcDistance(Point a, Point b)
 	return sqrt(pow((a.x - b.x),2) + pow((a.y - b.y),2));
 }
 
+//report how the current leg went, global_planner learns the cost of the roadmap edge from it
+void reportLeg(bool reached)
+{
+	if(!mLegActive){
+		return;
+	}
+	skynav_msgs::EdgeTraversal msg;
+	msg.header.stamp = ros::Time::now();
+	msg.header.frame_id = "/map";
+	msg.from = mLegFrom;
+	msg.to = mLegTo;
+	msg.expectedSeconds = calcDistance(mLegFrom, mLegTo) / MOTION_VELOCITY;
+	msg.actualSeconds = (ros::Time::now() - mLegStartTime).toSec();
+	msg.avoidances = mLegAvoidances;
+	msg.reached = reached;
+	pubEdgeTraversal.publish(msg);
+	mLegActive = false;
+}
+
+//a waypoint has been reached. it ends the current leg when it is the waypoint the leg runs to, and starts the next
+void waypointReached(const Point& waypoint)
+{
+	if(mLegActive && calcDistance(waypoint, mLegTo) > DISTANCE_ERROR_ALLOWED){
+		return;		//a detour waypoint
+	}
+	reportLeg(true);
+	mLegFrom = waypoint;
+	mLegHasStart = true;
+}
+
+//ask global_planner to repair the path to the goal around the objects, and follow the repaired path instead
+bool replanPath(const Pose& currentPose, const vector<Point>& obstacles)
+{
+	if(mOriginalPath->empty())
+	{
+		return false;
+	}
+	skynav_msgs::replan_srv srv;
+	srv.request.request = 1;
+	srv.request.currentPose.x = currentPose.position.x;
+	srv.request.currentPose.y = currentPose.position.y;
+	srv.request.goalPose.x = mOriginalPath->back().pose.position.x;
+	srv.request.goalPose.y = mOriginalPath->back().pose.position.y;
+	srv.request.goalPose.theta = mEndOrientation;
+	srv.request.obstacles = obstacles;
+
+	if(!servClientReplan.call(srv) || !srv.response.response || srv.response.path.poses.size() < 2)
+	{
+		ROS_WARN("replan failed, taking a detour instead");
+		return false;
+	}
+	//the first pose is the current position
+	mCurrentPath->assign(srv.response.path.poses.begin() + 1, srv.response.path.poses.end());
+	mOriginalPath->assign(srv.response.path.poses.begin() + 1, srv.response.path.poses.end());
+	mEndOrientation = mOriginalPath->back().pose.orientation.z;
+	reportLeg(false);	//the edge that was being driven is blocked
+	mLegHasStart = false;
+	return true;
+}
+
 void publishCmdVel(Twist twist)	
 {		
 	if(twist.linear.x > MOTION_VELOCITY){
@@ -239,7 +311,11 @@ void navigate()
 
         case NAV_READY: 	
         {						
-            if (!mCurrentPath->size() == 0){ 
+            if (!mCurrentPath->size() == 0){
+				//a waypoint stamped later that the robot is at already is a wait, global_planner lets another robot pass
+				if(ros::Time::now() < mCurrentPath->front().header.stamp && posesEqual(getCurrentPose(), mCurrentPath->front().pose)){
+					return;
+				}
 				ROS_WARN("NAV_READY");
 				
 				PoseStamped absoluteTargetPose = mCurrentPath->front(); // always use index 0, if target reached, delete 0 and use the new 0
@@ -249,6 +325,14 @@ void navigate()
 
 				pubTargetPoseStamped.publish(absoluteTargetPose);          
 				ROS_INFO("target pose: (%f, %f)", absoluteTargetPose.pose.position.x, absoluteTargetPose.pose.position.y);
+				
+				//a leg runs between two waypoints of the path, detours pushed in front of the target are part of it
+				if(!mLegActive && mLegHasStart){
+					mLegActive = true;
+					mLegTo = absoluteTargetPose.pose.position;
+					mLegStartTime = ros::Time::now();
+					mLegAvoidances = 0;
+				}
 				setMovementState(MOV_READY);
 				pubNavigationStateHelper(NAV_MOVING);
 			}else{
@@ -268,6 +352,7 @@ void navigate()
 				if (posesEqual(currentPose, targetPose.pose)) 
 				{ 
 					ROS_INFO("Location: (%f,%f)", currentPose.position.x, currentPose.position.y);
+					waypointReached(mCurrentPath->front().pose.position);
 					mCurrentPath->pop_front();
 					
 				}else{
@@ -275,6 +360,7 @@ void navigate()
 				}				
 			}else{
 				ROS_INFO("nav pose reached unchecked, continue"); 
+				waypointReached(mCurrentPath->front().pose.position);
 				mCurrentPath->pop_front();					
 			}
 			
@@ -504,6 +590,11 @@ void navigate()
 			//TODO create a check if new path is inefficient. in that case, dont push_front
 			if(servClientWaypointCheck.call(srv)){
 				if(srv.response.pathChanged){
+					mLegAvoidances++;
+				}
+				if(srv.response.pathChanged && replanPath(currentPose, srv.response.obstacles)){
+					ROS_INFO("path replanned around the objects");
+				}else if(srv.response.pathChanged){
 					PoseStamped nwWaypoint;
 					nwWaypoint.pose.position = srv.response.newPos;
 					mCurrentPath->push_front(nwWaypoint);	// be careful here!	
@@ -535,6 +626,7 @@ void navigate()
         {
             ROS_WARN("NAV_UNREACHABLE");
 			ROS_INFO("Could not reach target pose");
+			reportLeg(false);
 			clearPath();
 			pubNavigationStateHelper(NAV_STOP);  
         }
@@ -593,6 +685,7 @@ int main(int argc, char **argv)
     
     ros::NodeHandle n = ros::NodeHandle("");
     ros::NodeHandle n_localnav("/localnav");
+    ros::NodeHandle n_globalnav("/globalnav");
     
     mNode = new ros::NodeHandle("/control");
     mNodeSLAM = new ros::NodeHandle("/slam");
@@ -601,6 +694,7 @@ int main(int argc, char **argv)
     pubCmdVel = n.advertise<Twist>("/cmd_vel", 1);
     pubNavigationState = mNode->advertise<std_msgs::UInt8>("navigation_state", 0);
     pubTargetPoseStamped = mNode->advertise<geometry_msgs::PoseStamped>("target_pose", 1);
+    pubEdgeTraversal = mNode->advertise<skynav_msgs::EdgeTraversal>("edge_traversal", 10);
 
     //subs
     ros::Subscriber subCheckedWaypoints = mNode->subscribe("checked_waypoints", 1, subCheckedWaypointsCallback);
@@ -612,6 +706,7 @@ int main(int argc, char **argv)
     servClientCurrentVelocity = mNodeSLAM->serviceClient<skynav_msgs::current_velocity>("current_velocity");
     
     servClientWaypointCheck = n_localnav.serviceClient<skynav_msgs::waypoint_check>("path_check");
+    servClientReplan = n_globalnav.serviceClient<skynav_msgs::replan_srv>("replan");
 
     ros::Rate loop_rate(10); // loop at 10hz
 
@@ -0,0 +1,84 @@
+/*
+ * arena.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef ARENA_H_
+#define ARENA_H_
+#include <vector>
+#include <new>
+
+#define ARENA_BLOCK_SHIFT 10 //2^10 elements per block
+#define ARENA_BLOCK_SIZE (1u << ARENA_BLOCK_SHIFT)
+#define ARENA_BLOCK_MASK (ARENA_BLOCK_SIZE - 1)
+
+/*
+ * storage for the objects of a graph (nodes and edges).
+ * objects are copied into large contiguous blocks and addressed by their index, which never changes.
+ * a block is never moved, so pointers to an object stay valid until clear().
+ * adding an object only allocates when a block is full, clear() frees all objects block by block.
+ */
+template<class T>
+class Arena
+{
+public:
+  Arena()
+  {
+    mSize = 0;
+  }
+  virtual ~Arena()
+  {
+    clear();
+  }
+
+  //copy item into the arena and return its index
+  unsigned int add(const T& item)
+  {
+    if (mSize == v_mBlocks.size() * ARENA_BLOCK_SIZE)
+    {
+      v_mBlocks.push_back(static_cast<T*>(::operator new(sizeof(T) * ARENA_BLOCK_SIZE)));
+    }
+    new (v_mBlocks[mSize >> ARENA_BLOCK_SHIFT] + (mSize & ARENA_BLOCK_MASK)) T(item);
+    return mSize++;
+  }
+
+  T& operator[](unsigned int index)
+  {
+    return v_mBlocks[index >> ARENA_BLOCK_SHIFT][index & ARENA_BLOCK_MASK];
+  }
+
+  const T& operator[](unsigned int index) const
+  {
+    return v_mBlocks[index >> ARENA_BLOCK_SHIFT][index & ARENA_BLOCK_MASK];
+  }
+
+  unsigned int size() const
+  {
+    return mSize;
+  }
+
+  //destroy all objects and release the blocks
+  void clear()
+  {
+    for (unsigned int i = 0; i < mSize; i++)
+    {
+      (*this)[i].~T();
+    }
+    for (typename std::vector<T*>::iterator it = v_mBlocks.begin(); it != v_mBlocks.end(); it++)
+    {
+      ::operator delete(*it);
+    }
+    v_mBlocks.clear();
+    mSize = 0;
+  }
+
+private:
+  Arena(const Arena&);
+  Arena& operator=(const Arena&);
+
+  std::vector<T*> v_mBlocks; //the blocks of ARENA_BLOCK_SIZE objects
+  unsigned int mSize; //number of objects in the arena
+};
+
+#endif /* ARENA_H_ */
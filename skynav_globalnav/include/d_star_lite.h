@@ -0,0 +1,102 @@
+/*
+ * d_star_lite.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef D_STAR_LITE_H_
+#define D_STAR_LITE_H_
+#include <vector>
+#include <map>
+
+#include "graph.h"
+#include "search_graphs.h"
+
+/*
+ * incremental replanning on the map grid (D* Lite, Koenig and Likhachev). the search runs from the goal to the
+ * robot and keeps its costs between calls: when cells are blocked or freed, or the robot has moved on, replan()
+ * only repairs the part of the search that changed, instead of searching the whole grid again.
+ *
+ * the grid is a copy of the GridGraph it is made from, 8-connected without cutting corners of objects, and is
+ * changed with setBlocked(). setGoal() starts a new search. the path runs from the start to the goal, with
+ * waypoints only where its direction changes.
+ *
+ * objects the robot runs into are added with addObstacle() until a time: people and carts move on, so they do not
+ * stay walls of the grid for later goals. removeExpiredObstacles() frees their cells again, only the cells that
+ * were free on the GridGraph are blocked and freed by objects.
+ */
+class DStarLite
+{
+public:
+  DStarLite(const GridGraph &grid);
+  virtual ~DStarLite();
+
+  void setGoal(unsigned int x, unsigned int y);
+  void setStart(unsigned int x, unsigned int y);
+  void setBlocked(unsigned int x, unsigned int y, bool blocked);
+  void addObstacle(unsigned int x, unsigned int y, unsigned int inflation, double until);
+  void removeExpiredObstacles(double now);
+  bool replan();
+
+  bool hasGoal() const;
+  unsigned int getGoalX() const;
+  unsigned int getGoalY() const;
+  bool isBlocked(unsigned int x, unsigned int y) const;
+  const std::vector<Point>& getPath() const;
+  float getCost() const;
+  unsigned int getExpanded() const;
+
+private:
+  struct Key
+  {
+    float mFirst;
+    float mSecond;
+    bool operator<(const Key &other) const
+    {
+      return mFirst < other.mFirst || (mFirst == other.mFirst && mSecond < other.mSecond);
+    }
+  };
+  struct HeapEntry
+  {
+    Key mKey;
+    unsigned int mVertex;
+    unsigned int mPush; //entries of a vertex pushed before its last push are outdated
+  };
+  //std heap functions build a max heap, the comparison is reversed so the top has the lowest key
+  struct HeapCompare
+  {
+    bool operator()(const HeapEntry &a, const HeapEntry &b) const
+    {
+      return b.mKey < a.mKey;
+    }
+  };
+
+  Key calculateKey(unsigned int v) const;
+  float heuristic(unsigned int a, unsigned int b) const;
+  float edgeCost(unsigned int from, unsigned int direction) const;
+  unsigned int neighbour(unsigned int v, unsigned int direction) const;
+  bool hasNeighbour(unsigned int v, unsigned int direction) const;
+  void reset();
+  void updateVertex(unsigned int v);
+  void push(unsigned int v);
+  bool computeShortestPath();
+  bool extractPath();
+
+  std::vector<unsigned char> v_mBlocked;
+  std::map<unsigned int, double> mObstacles; //cells blocked by objects, with the time they are blocked until
+  unsigned int mWidth;
+  unsigned int mHeight;
+  std::vector<float> v_mG; //cost to the goal as of the last expansion
+  std::vector<float> v_mRhs; //cost to the goal through the best neighbour
+  std::vector<HeapEntry> v_mHeap; //open list, with lazy deletion of outdated entries
+  std::vector<unsigned int> v_mPushes; //number of times every vertex was pushed on the open list
+  unsigned int mGoal;
+  unsigned int mStart;
+  float mKeyModifier; //sum of the heuristic distances the start has moved, keeps the old heap keys valid
+  bool mFresh; //the goal changed, the next replan searches from scratch
+  unsigned int mExpanded;
+  float mCost;
+  std::vector<Point> v_mPath;
+};
+
+#endif /* D_STAR_LITE_H_ */
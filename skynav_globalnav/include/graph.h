@@ -16,24 +16,46 @@
 #include <sstream>
 #include <fstream>
 #include <time.h>
+#include <stdint.h>
 #include <algorithm>
 
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/shared_mutex.hpp>
+
+#include "arena.h"
+#include "tiled_grid.h"
+#include "map_pyramid.h"
+
+#define EDGE_LEARNING_RATE 0.2f //weight of a new traversal in the cost factor of an edge
+#define EDGE_AVOIDANCE_PENALTY 1.0f //cost factor added for every object that had to be avoided on an edge
+#define EDGE_COST_MAX 10.0f //cost factor of an edge that could not be traversed
 
 class Node;
 class Edge;
 class Graph;
 class PathFinder;
 class MapData;
+class ReservationTable;
+struct TimedWaypoint;
 
 namespace nodeTypes
 {
 enum nodeType
 {
-  Fixed_room, Fixed_door, Random_node, Not_Defined, Fixed_General
+  Fixed_room, Fixed_door, Random_node, Not_Defined, Fixed_General, Voronoi_node, Visibility_node
 };
 }
 typedef nodeTypes::nodeType nodeType;
 
+namespace roadmapTypes
+{
+enum roadmapType
+{
+  Random_roadmap, Voronoi_roadmap, Visibility_roadmap
+};
+}
+typedef roadmapTypes::roadmapType roadmapType;
+
 namespace spaceType
 {
 enum cSpace
@@ -53,20 +75,16 @@ struct Point
     this->mYpos = y;
   }
 };
+//the cells of a line. a Line is reused between lines, clearing it keeps its memory
 struct Line
 {
-  std::vector<Point*> mCoordinates;
-  Line(std::vector<Point*> coords)
+  std::vector<Point> mCoordinates;
+  Line()
   {
-    this->mCoordinates = coords;
   }
-  ~Line()
+  Line(const std::vector<Point> &coords)
   {
-    for (std::vector<Point*>::iterator it = mCoordinates.begin(); it != mCoordinates.end(); it++)
-    {
-      delete (*it);
-    }
-    mCoordinates.clear();
+    this->mCoordinates = coords;
   }
 };
 struct NeighbourDist
@@ -79,7 +97,19 @@ struct NeighbourDist
     this->dist = d;
   }
 };
-bool distSort(NeighbourDist* p_A, NeighbourDist* p_B);
+bool distSort(const NeighbourDist &A, const NeighbourDist &B);
+
+//an entry in the adjacency list of a node
+struct Adjacent
+{
+  unsigned int node; //id of the neighbour node
+  unsigned int edge; //id of the edge to the neighbour
+  Adjacent(unsigned int n, unsigned int e)
+  {
+    this->node = n;
+    this->edge = e;
+  }
+};
 
 class Node
 {
@@ -90,15 +120,10 @@ public:
   virtual ~Node();
   float estimateDist(unsigned int, unsigned int);
   bool compare(Node* p_node);
-  void addConnection(Node* p_adjacent);
-
-  std::vector<Node*> getAdjacencyList();
-  void setAdjacencyList(std::vector<Node*> adjacencyList);
-  float getF();
-  void setF(float f);
-  float getG();
-  void setG(float g);
-  float getH(Node* p_target);
+  void addConnection(unsigned int adjacentId, unsigned int edgeId);
+
+  const std::vector<Adjacent>& getAdjacencyList() const;
+  void setAdjacencyList(std::vector<Adjacent> adjacencyList);
   unsigned int getId();
   nodeType getType();
   void setType(nodeType e_type);
@@ -108,22 +133,17 @@ public:
   void setYpos(unsigned int ypos);
   Graph* getMGraph();
   void setMGraph(Graph* p_graph);
-  Node* getMParent();
-  void setMParent(Node* p_parent);
   void setTheta(float theta);
   float getTheta();
 
 private:
+  //search data (g, f, parent) is kept per query in a SearchState, so the roadmap itself is not modified by a query
   Graph* p_mGraph;
-  Node* p_mParent;
-  std::vector<Node*> mAdjacencyList;
-  unsigned int mID;
+  std::vector<Adjacent> mAdjacencyList;
+  unsigned int mID; //index of the node in the graph
   unsigned int mXpos;
   unsigned int mYpos;
   float mTheta;
-  float mG;
-  float mF;
-  float mH;
   nodeType mType;
 };
 
@@ -134,49 +154,80 @@ public:
   Edge(Node*, Node*);
   virtual ~Edge();
   float getLength();
-  float calcLenght();
+  float getCost();
+  float getCostFactor();
+  void setCostFactor(float factor);
+  void learnCost(float slowdown, unsigned int avoidances, bool reached);
   bool compare(Edge* p_edge);
 
-  Node* getA();
-  Node* getB();
+  unsigned int getA();
+  unsigned int getB();
+  double getBlockedUntil();
+  void setBlockedUntil(double time);
 
 private:
-  Node* p_mA;
-  Node* p_mB;
+  unsigned int mA; //id of node A
+  unsigned int mB; //id of node B
   float mLenght;
+  float mCostFactor; //learned from traversals, the cost of the edge is its length times this factor (>= 1)
+  double mBlockedUntil; //the edge crosses a temporary object until this time (MapData::getTime), queries leave it out.
+                        //infinite while it crosses an object added to the map after the roadmap was built
 };
 
 class Graph
 {
 public:
-  Graph(MapData* p_mapData);
+  Graph(MapData* p_mapData, roadmapType type = roadmapTypes::Random_roadmap);
+  Graph(MapData* p_mapData, roadmapType type, const std::string &roadmapFile);
   virtual ~Graph();
 
-  bool addNode(Node* p_node);
-  bool nodeExist(Node* p_node);
-  Node* returnNodeExist(Node* p_node);
+  Node* addNode(unsigned int xPos, unsigned int yPos, nodeType type);
+  bool nodeExist(unsigned int xPos, unsigned int yPos);
+  Node* returnNodeExist(unsigned int xPos, unsigned int yPos);
   bool addEdge(Node* p_A, Node* p_B);
-  bool edgeExist(Edge* p_edge);
+  bool edgeExist(Node* p_A, Node* p_B);
 
   Edge* getEdgeBetween(Node* p_A, Node* p_B);
-  std::vector<Node*> getPath()const;
-  bool findPath(unsigned int xStart, unsigned int yStart, float thStart, unsigned int xTarget, unsigned int yTarget, float thTarget);
-  std::vector<Node*> getAllNodes();
-  std::vector<Edge*> getAllEdges();
+  bool findPath(unsigned int xStart, unsigned int yStart, float thStart, unsigned int xTarget, unsigned int yTarget, float thTarget, std::vector<Node*> &v_pPath);
+  bool findTour(const std::vector<Point> &v_stops, std::vector<unsigned int> &v_order, std::vector<Node*> &v_pPath, float &cost);
+  bool findTimedPath(unsigned int xStart, unsigned int yStart, unsigned int xTarget, unsigned int yTarget,
+                     ReservationTable &table, unsigned int robot, double startTime, std::vector<TimedWaypoint> &v_path);
+  Node* getNode(unsigned int id);
+  Edge* getEdge(unsigned int id);
+  unsigned int getNodeCount() const;
+  unsigned int getEdgeCount() const;
+  const Arena<Node>& getAllNodes() const;
+  const Arena<Edge>& getAllEdges() const;
 
   bool tryCreateEdge(Node* A, Node* B);
   void createRandomRoadmap();
+  void createVoronoiRoadmap();
+  void createVisibilityRoadmap();
   Node* tryAddToRoadmap(unsigned int xPos, unsigned int yPos,float theta, nodeType type);
   bool updateFixedWaypoints();
+  bool reportTraversal(unsigned int xA, unsigned int yA, unsigned int xB, unsigned int yB, float slowdown,
+                       unsigned int avoidances, bool reached);
+  unsigned int applyMapChanges(const std::vector<Point> &v_cells);
   bool exportGraph(std::string filePath);
   bool importGraph(std::string filePath);
-  void print(bool path);
+  void print(const std::vector<Node*> &v_pPath);
 private:
-  std::vector<Node*> v_mNodes; //al nodes that make up the roadmap
-  std::vector<Edge*> v_mEdges; //all edges between the nodes on the roadmap
-  std::vector<Node*> v_mPath; //the nodes that make up te path from start to end
-  PathFinder* p_mAlgorithm; //the algorithm to find the path on the roadmap
+  void createRoadmap();
+  void connectNeighbours(Node* p_node);
+  PathFinder* acquireFinder();
+  void releaseFinder(PathFinder* p_finder);
+  bool invalidateBlockedEdges(const std::vector<Node*> &v_pPath, double now);
+
+  Arena<Node> mNodes; //al nodes that make up the roadmap, the id of a node is its index
+  Arena<Edge> mEdges; //all edges between the nodes on the roadmap, the id of an edge is its index
+  std::vector<NeighbourDist> v_mCandidates; //scratch list of candidate neighbours of a newly placed node
+  Line mEdgeLine; //scratch line for the collision check of a candidate edge
+  std::vector<PathFinder*> v_mIdleFinders; //pool of search workspaces, one is taken by every running query
   MapData* p_mMapData; //all usefull data known about the map
+  roadmapType mRoadmapType; //how the roadmap was created
+
+  boost::shared_mutex mRoadmapMutex; //queries share the roadmap, adding nodes or edges needs it exclusively
+  boost::mutex mFinderMutex; //guards the pool of idle search workspaces
 };
 
 class MapData
@@ -189,7 +240,7 @@ public:
   bool checkCCollision(unsigned int x, unsigned int y);
   bool checkPCollision(Node* p_node);
   bool checkLineCollission(Line* p_line);
-  Line* Bresenham(Point* A, Point* B);
+  void Bresenham(const Point &A, const Point &B, Line* p_line);
   unsigned int getMaxRandNodes() const;
   void setMaxRandNodes(unsigned int maxRNodes);
   float getMaxNDist() const;
@@ -200,14 +251,26 @@ public:
   unsigned int getYdimension() const;
   bool markNode(Node* point, cSpace e_cSpace);
   void parseOccupancyList(std::vector<int> &occupancyList);
+  void parseOccupancyTile(unsigned int tx, unsigned int ty, const int8_t* p_cells, int8_t uniform);
+  bool setCell(unsigned int x, unsigned int y, int8_t value);
   bool checkCoordinates(unsigned int xPos, unsigned int yPos);
-  std::vector<std::vector<cSpace> > getMapData() const;
-  std::vector<Node*> getFixedWPs() const;
+  cSpace getCell(unsigned int x, unsigned int y) const;
+  const TiledGrid<unsigned char>& getMapData() const;
+  void buildPyramid(unsigned int levels);
+  const MapPyramid& getPyramid() const;
+  const std::vector<Node*>& getFixedWPs() const;
   bool addFixedWPs(std::vector<Node*>);
   bool updateFixedWPs(std::vector<Node*>);
   void init();
   void update();
 
+  static double getTime();
+  void addTemporaryObstacles(const std::vector<Point> &v_cells, unsigned int radius, float lifetime);
+  bool hasTemporaryObstacles(double now);
+  bool checkTemporaryObstacle(unsigned int x, unsigned int y, double now);
+  double checkTemporaryLineCollision(Line* p_line, double now);
+  bool checkTemporaryPathCollision(const std::vector<Point> &v_path, double now);
+
   bool readFromFile();//TODO TEMP FUNCTION
 
 
@@ -215,11 +278,16 @@ private:
   unsigned int mMax_RNodes; //maximum number of random nodes placed for creating the roadmap
   float mMax_NDist; //maximum distance between placed nodes to create an edge between them for creating the roadmap
   unsigned int mMaxNConnect; //maximum number of edges a new placed node can form to neighbours.
-  std::vector<std::vector<cSpace> > v2dMap;
+  TiledGrid<unsigned char> mGrid; //the cSpace of every cell, tiles of free space take no memory
+  MapPyramid mPyramid; //the objects of mGrid at lower resolutions, empty until buildPyramid()
   std::vector<Node*> v_mFixedWPs;
   unsigned int mXdim;
   unsigned int mYdim;
   float mResolution;
+
+  TiledGrid<double> mTemporary; //per cell the time until which a temporary object covers it, allocated where one has
+  double mTemporaryUntil; //the time the last temporary object expires, after it the layer is empty
+  boost::shared_mutex mTemporaryMutex; //objects are added while queries check lines against the layer
 };
 #endif /* GRAPH_H_ */
 
@@ -0,0 +1,45 @@
+/*
+ * map_pyramid.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef MAP_PYRAMID_H_
+#define MAP_PYRAMID_H_
+#include <vector>
+
+#include "tiled_grid.h"
+
+/*
+ * the occupancy of a map at lower resolutions. a cell of level l covers 2^l by 2^l cells of the map and is occupied
+ * when any of them is an object (max pooling), so a level is conservative: free space at a coarse level is free on
+ * the map, but a narrow passage can be closed. level 0 is the map itself.
+ *
+ * the levels are built once per map, a changed cell of the map only updates the cells above it.
+ */
+class MapPyramid
+{
+public:
+  MapPyramid();
+  virtual ~MapPyramid();
+
+  void build(const TiledGrid<unsigned char> &grid, unsigned int levels);
+  void update(const TiledGrid<unsigned char> &grid, unsigned int x, unsigned int y);
+  void clear();
+
+  unsigned int getLevels() const;
+  unsigned int getWidth(unsigned int level) const;
+  unsigned int getHeight(unsigned int level) const;
+  bool isOccupied(unsigned int level, unsigned int x, unsigned int y) const;
+  void getLevel(unsigned int level, std::vector<signed char> &v_cells) const;
+
+private:
+  bool pool(const TiledGrid<unsigned char> &grid, unsigned int level, unsigned int x, unsigned int y) const;
+  unsigned char& cell(unsigned int level, unsigned int x, unsigned int y);
+
+  unsigned int mWidth; //cells of the map
+  unsigned int mHeight;
+  std::vector<std::vector<unsigned char> > v_mLevels; //level 1 and up, row by row, 1 for occupied cells
+};
+
+#endif /* MAP_PYRAMID_H_ */
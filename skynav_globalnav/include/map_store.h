@@ -0,0 +1,87 @@
+/*
+ * map_store.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef MAP_STORE_H_
+#define MAP_STORE_H_
+#include <ros/ros.h>
+#include <vector>
+#include <string>
+#include <map>
+
+#include "graph.h"
+
+//a waypoint of a path through several maps
+struct MapWaypoint
+{
+  std::string mMap;
+  unsigned int mXpos;
+  unsigned int mYpos;
+  MapWaypoint(const std::string &map, unsigned int x, unsigned int y)
+  {
+    this->mMap = map;
+    this->mXpos = x;
+    this->mYpos = y;
+  }
+};
+
+/*
+ * several named maps (the floors of a building), each with its roadmap, resident side by side.
+ * the roadmap of a map is built once when the map is added, a query selects the map it runs on by name.
+ *
+ * links join a point on one map to a point on another one (an elevator or a staircase) at a fixed cost.
+ * a query from one map to another runs over the link points: the legs between the start, the link points and the
+ * target on the same map are searched on that roadmap, only for the link points the search actually reaches.
+ *
+ * maps can be added, queried and removed from several threads at once. a map is only released when it is
+ * removed, so the Graph of a map stays valid while the map is in the store.
+ */
+class MapStore
+{
+public:
+  MapStore();
+  virtual ~MapStore();
+
+  bool addMap(const std::string &name, MapData* p_mapData, roadmapType type);
+  bool addMap(const std::string &name, MapData* p_mapData, Graph* p_graph);
+  bool removeMap(const std::string &name);
+  bool hasMap(const std::string &name);
+  Graph* getGraph(const std::string &name);
+  MapData* getMapData(const std::string &name);
+  std::vector<std::string> getMapNames();
+
+  bool addLink(const std::string &mapA, unsigned int xA, unsigned int yA, const std::string &mapB, unsigned int xB,
+               unsigned int yB, float cost);
+  unsigned int getLinkCount();
+
+  bool findPath(const std::string &startMap, unsigned int xStart, unsigned int yStart, const std::string &targetMap,
+                unsigned int xTarget, unsigned int yTarget, std::vector<MapWaypoint> &v_path, float &cost);
+
+private:
+  struct MapEntry
+  {
+    MapData* p_mMapData;
+    Graph* p_mGraph;
+    bool mOwned; //the store releases the map and its roadmap when it is removed
+  };
+  //a point on a map the cross-map search runs over: the start, the target or one end of a link
+  struct Stop
+  {
+    std::string mMap;
+    unsigned int mXpos;
+    unsigned int mYpos;
+    int mLink; //the other end of the link this point is an end of, or -1
+    float mLinkCost;
+  };
+
+  void releaseEntry(MapEntry &entry);
+  bool findLeg(Graph* p_graph, const Stop &from, const Stop &to, std::vector<Node*> &v_leg, float &cost);
+
+  std::map<std::string, MapEntry> mMaps;
+  std::vector<Stop> v_mLinkEnds; //the two ends of link i at 2 * i and 2 * i + 1
+  boost::shared_mutex mStoreMutex; //adding or removing maps and links needs it exclusively
+};
+
+#endif /* MAP_STORE_H_ */
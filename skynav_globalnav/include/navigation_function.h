@@ -0,0 +1,83 @@
+/*
+ * navigation_function.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef NAVIGATION_FUNCTION_H_
+#define NAVIGATION_FUNCTION_H_
+#include <vector>
+#include <map>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "graph.h"
+#include "search_graphs.h"
+
+/*
+ * navigation function of one goal cell: the cost-to-go from every cell of a grid to the goal,
+ * computed once by a Dijkstra wavefront from the goal. a path to the goal is found by gradient descent
+ * from the start cell, which takes a number of steps equal to the path length and does not search.
+ */
+class NavigationFunction
+{
+public:
+  NavigationFunction(boost::shared_ptr<const GridGraph> p_grid, unsigned int xGoal, unsigned int yGoal);
+  virtual ~NavigationFunction();
+
+  bool isReachable(unsigned int x, unsigned int y) const;
+  float getCost(unsigned int x, unsigned int y) const;
+  bool descend(unsigned int xStart, unsigned int yStart, std::vector<Point> &v_path) const;
+
+  unsigned int getGoalX() const;
+  unsigned int getGoalY() const;
+
+private:
+  boost::shared_ptr<const GridGraph> p_mGrid;
+  std::vector<float> v_mCost; //cost from every cell to the goal, infinity when the goal cannot be reached
+  unsigned int mGoal; //vertex id of the goal cell
+};
+
+/*
+ * the navigation functions of the fixed waypoints of a map.
+ * rebuild() takes a snapshot of the map and computes the functions in background threads, one waypoint per thread
+ * at a time. queries use find() and fall back to the roadmap while the function of their goal is not ready.
+ * invalidate() drops all functions, builds that are still running for an old map are discarded when they finish.
+ * rebuild() does not wait for them, they stop on their own and are released by a later rebuild() or wait().
+ */
+class NavigationFunctionCache
+{
+public:
+  NavigationFunctionCache(unsigned int inflation, unsigned int threads = 0);
+  virtual ~NavigationFunctionCache();
+
+  void rebuild(MapData* p_mapData);
+  void rebuild(MapData* p_mapData, boost::shared_ptr<const GridGraph> p_grid);
+  void invalidate();
+  void wait();
+
+  boost::shared_ptr<const NavigationFunction> find(unsigned int xGoal, unsigned int yGoal) const;
+  unsigned int getReadyCount() const;
+
+private:
+  void buildWorker(unsigned int generation);
+  void retireBuilders();
+
+  unsigned int mInflation; //cells around objects that are blocked for the navigation functions
+  unsigned int mThreads; //number of build threads, 0 uses one thread per core
+  boost::thread_group* p_mBuilders; //threads building the functions, only used by the owner of the cache
+  unsigned int mBuildersGeneration; //the generation p_mBuilders build
+  std::vector<std::pair<unsigned int, boost::thread_group*> > v_mRetired; //builders of older generations by
+                                                                          //generation, only used by the owner
+  mutable boost::mutex mMutex; //guards all members below
+  unsigned int mGeneration; //incremented for every map, builds of older generations are discarded
+  boost::shared_ptr<const GridGraph> p_mGrid; //snapshot of the map the functions are built on
+  std::vector<Point> v_mGoals; //fixed waypoints of the current generation
+  unsigned int mNextGoal; //index in v_mGoals of the next waypoint to build
+  std::map<unsigned int, unsigned int> mRunning; //builders that have not stopped yet, by generation
+  std::map<std::pair<unsigned int, unsigned int>, boost::shared_ptr<const NavigationFunction> > mFunctions; //ready functions by goal cell
+};
+
+#endif /* NAVIGATION_FUNCTION_H_ */
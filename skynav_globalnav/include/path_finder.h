@@ -9,23 +9,29 @@
 #define PATH_FINDER_H_
 #include <ros/ros.h> // You must include this to do things with ROS.
 #include "graph.h"
+#include "search_graphs.h"
 #include <iostream>
 
+/*
+ * A* search on the roadmap of a graph. a PathFinder holds all data of one running query,
+ * the graph is only read. use one PathFinder per thread to query the same graph concurrently.
+ * the search itself is AStarSearch on the roadmap with the euclidean heuristic, see search_core.h
+ */
 class PathFinder
 {
 public:
   PathFinder(Graph* p_graph);
   virtual ~PathFinder();
 
-  bool findPath(Node* p_start, Node* p_target);
-  bool isInList(Node* p_node, std::vector<Node*> &v_pList);
-  bool delFromList(Node* p_node, std::vector<Node*> &v_pList);
-  Node* getLowestF(std::vector<Node*> v_pList);
-  std::vector<Node*> reconstructPath(std::vector<Node*> &v_pPath, Node* p_wp);
-  std::vector<Node*> getPath();
+  bool findPath(Node* p_start, Node* p_target, double now = RoadmapGraph::ALL_EDGES);
+  const std::vector<Node*>& getPath() const;
+  unsigned int getExpanded() const;
 
 private:
   Graph* p_mGraph;
+  RoadmapGraph mRoadmap;
+  AStarSearch<RoadmapGraph, EuclideanHeuristic, float> mSearch; //search data for the current query
+  std::vector<unsigned int> v_mPathIds; //node ids of the found path
   std::vector<Node*> mPath;
   Node* p_mStart;
   Node* p_mTarget;
@@ -0,0 +1,20 @@
+/*
+ * polyline.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef POLYLINE_H_
+#define POLYLINE_H_
+#include <vector>
+
+#include "graph.h"
+
+/*
+ * Douglas-Peucker simplification of a chain of cells: the result keeps the first and the last point and
+ * only those points in between that are needed to stay within tolerance (in cells) of the original chain.
+ * v_result is replaced, it may not be v_points
+ */
+void simplifyPolyline(const std::vector<Point> &v_points, float tolerance, std::vector<Point> &v_result);
+
+#endif /* POLYLINE_H_ */
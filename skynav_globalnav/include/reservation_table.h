@@ -0,0 +1,85 @@
+/*
+ * reservation_table.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef RESERVATION_TABLE_H_
+#define RESERVATION_TABLE_H_
+#include <vector>
+#include <map>
+#include <boost/thread/mutex.hpp>
+
+#include "graph.h"
+
+//a waypoint of a path in space and time, the robot is planned to be at the node at this time (MapData::getTime)
+struct TimedWaypoint
+{
+  Node* p_mNode;
+  double mTime;
+  TimedWaypoint(Node* p_node, double time)
+  {
+    this->p_mNode = p_node;
+    this->mTime = time;
+  }
+};
+
+/*
+ * the planned trajectories of several robots on one roadmap, for prioritised planning: every robot is planned in
+ * turn around the trajectories reserved before it.
+ *
+ * time is divided in ticks. a robot reserves the node it is at in every tick, and the edge it drives along in every
+ * tick it spends on it, so two robots never meet at a node nor on an edge, head-on or otherwise. after its target is
+ * reached a robot keeps the target for the hold time, the others route around it or wait.
+ *
+ * reservePath() runs a time-expanded A* over (node, tick): a robot drives an edge at its speed, or waits a tick at a
+ * node, whichever keeps clear of the reservations. the path found is reserved for the robot at once, replacing its
+ * earlier reservations, so planning is atomic with respect to the other robots.
+ */
+class ReservationTable
+{
+public:
+  ReservationTable(float tick, float speed, float hold);
+  virtual ~ReservationTable();
+
+  bool reservePath(Graph* p_graph, Node* p_start, Node* p_target, unsigned int robot, double startTime,
+                   std::vector<TimedWaypoint> &v_path);
+  void release(unsigned int robot);
+  void clear();
+  void prune(double now);
+
+  bool isNodeFree(unsigned int node, double time, unsigned int robot);
+  bool isEdgeFree(unsigned int edge, double time, unsigned int robot);
+  unsigned int getReservationCount();
+  unsigned int getExpanded() const;
+
+private:
+  typedef unsigned long long Key; //a tick in the high word, a node or edge id in the low word
+  struct Arrival
+  {
+    unsigned int mNode;
+    unsigned int mTick;
+    unsigned int mPrevious; //index of the state the node was reached from
+  };
+
+  static Key key(unsigned int tick, unsigned int id);
+  unsigned int toTick(double time) const;
+  double toTime(unsigned int tick) const;
+  unsigned int travelTicks(Edge* p_edge) const;
+  bool nodeFree(unsigned int node, unsigned int tick, unsigned int robot) const;
+  bool edgeFree(unsigned int edge, unsigned int first, unsigned int last, unsigned int robot) const;
+  void releaseLocked(unsigned int robot);
+  void reserve(std::map<Key, unsigned int> &reservations, Key k, unsigned int robot);
+
+  float mTick; //seconds per tick
+  float mSpeed; //map cells per second
+  unsigned int mHoldTicks; //ticks a robot keeps its target after reaching it
+  double mEpoch; //time of tick 0
+  std::map<Key, unsigned int> mNodeReservations; //the robot that holds a node in a tick
+  std::map<Key, unsigned int> mEdgeReservations; //the robot that drives an edge in a tick
+  std::vector<Arrival> v_mStates; //scratch list of the states reached by a search
+  unsigned int mExpanded;
+  boost::mutex mTableMutex;
+};
+
+#endif /* RESERVATION_TABLE_H_ */
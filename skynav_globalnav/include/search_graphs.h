@@ -0,0 +1,186 @@
+/*
+ * search_graphs.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef SEARCH_GRAPHS_H_
+#define SEARCH_GRAPHS_H_
+#include <vector>
+
+#include "graph.h"
+#include "search_core.h"
+
+/*
+ * graph representations for AStarSearch, see search_core.h for the interface.
+ */
+
+/*
+ * the roadmap Graph itself, vertex ids are node ids. follows the node and edge arenas.
+ * edges that are blocked by temporary objects at the time set with setTime() are left out, by default none are.
+ */
+class RoadmapGraph
+{
+public:
+  static const double ALL_EDGES; //a time after all temporary objects expire, only edges blocked by the map are left out
+
+  RoadmapGraph(Graph* p_graph);
+
+  void setTime(double now)
+  {
+    mNow = now;
+  }
+
+  unsigned int size() const
+  {
+    return p_mGraph->getNodeCount();
+  }
+  unsigned int getX(unsigned int v) const
+  {
+    return p_mGraph->getNode(v)->getXpos();
+  }
+  unsigned int getY(unsigned int v) const
+  {
+    return p_mGraph->getNode(v)->getYpos();
+  }
+  template<class SearchT>
+  void expand(unsigned int v, SearchT &search) const
+  {
+    const std::vector<Adjacent> &v_adjacencyList = p_mGraph->getNode(v)->getAdjacencyList();
+    for (std::vector<Adjacent>::const_iterator it = v_adjacencyList.begin(); it != v_adjacencyList.end(); it++)
+    {
+      Edge* p_edge = p_mGraph->getEdge((*it).edge);
+      if (p_edge->getBlockedUntil() <= mNow)
+      {
+        search.relax(v, (*it).node, p_edge->getCost());
+      }
+    }
+  }
+
+private:
+  Graph* p_mGraph;
+  double mNow;
+};
+
+/*
+ * compressed sparse row copy of a roadmap Graph: the neighbours of all vertices in one array,
+ * with the neighbours of vertex v at [offset[v], offset[v + 1]). vertex ids are node ids.
+ * a snapshot, rebuild after nodes or edges are added to the graph.
+ */
+class CsrGraph
+{
+public:
+  CsrGraph();
+  CsrGraph(Graph* p_graph);
+
+  void build(Graph* p_graph);
+
+  unsigned int size() const
+  {
+    return v_mX.size();
+  }
+  unsigned int getX(unsigned int v) const
+  {
+    return v_mX[v];
+  }
+  unsigned int getY(unsigned int v) const
+  {
+    return v_mY[v];
+  }
+  template<class SearchT>
+  void expand(unsigned int v, SearchT &search) const
+  {
+    for (unsigned int i = v_mOffsets[v]; i < v_mOffsets[v + 1]; i++)
+    {
+      search.relax(v, v_mTargets[i], v_mLengths[i]);
+    }
+  }
+
+private:
+  std::vector<unsigned int> v_mOffsets; //first neighbour of every vertex, plus the end
+  std::vector<unsigned int> v_mTargets; //neighbour vertex ids
+  std::vector<float> v_mLengths; //edge costs, same order as v_mTargets
+  std::vector<unsigned int> v_mX;
+  std::vector<unsigned int> v_mY;
+};
+
+/*
+ * the occupancy grid of a MapData as an 8-connected graph. vertex id of cell (x, y) is y * width + x.
+ * diagonal steps past the corner of an object are not allowed.
+ * objects can be inflated by a number of cells, so paths keep that distance from them.
+ * a snapshot, rebuild after the map changes. large maps are built by several threads, see build().
+ */
+class GridGraph
+{
+public:
+  GridGraph();
+  GridGraph(MapData* p_mapData, unsigned int inflation = 0, unsigned int threads = 1);
+
+  void build(MapData* p_mapData, unsigned int inflation = 0, unsigned int threads = 1);
+
+  unsigned int size() const
+  {
+    return v_mBlocked.size();
+  }
+  unsigned int getX(unsigned int v) const
+  {
+    return v % mWidth;
+  }
+  unsigned int getY(unsigned int v) const
+  {
+    return v / mWidth;
+  }
+  unsigned int getWidth() const
+  {
+    return mWidth;
+  }
+  unsigned int getHeight() const
+  {
+    return mHeight;
+  }
+  unsigned int getVertex(unsigned int x, unsigned int y) const
+  {
+    return y * mWidth + x;
+  }
+  bool isBlocked(unsigned int v) const
+  {
+    return v_mBlocked[v] != 0;
+  }
+  template<class SearchT>
+  void expand(unsigned int v, SearchT &search) const
+  {
+    unsigned int x = getX(v);
+    unsigned int y = getY(v);
+    bool left = x > 0 && !v_mBlocked[v - 1];
+    bool right = x + 1 < mWidth && !v_mBlocked[v + 1];
+    bool up = y > 0 && !v_mBlocked[v - mWidth];
+    bool down = y + 1 < mHeight && !v_mBlocked[v + mWidth];
+
+    if (left)
+      search.relax(v, v - 1, 1);
+    if (right)
+      search.relax(v, v + 1, 1);
+    if (up)
+      search.relax(v, v - mWidth, 1);
+    if (down)
+      search.relax(v, v + mWidth, 1);
+    if (left && up && !v_mBlocked[v - mWidth - 1])
+      search.relax(v, v - mWidth - 1, SQRT2);
+    if (right && up && !v_mBlocked[v - mWidth + 1])
+      search.relax(v, v - mWidth + 1, SQRT2);
+    if (left && down && !v_mBlocked[v + mWidth - 1])
+      search.relax(v, v + mWidth - 1, SQRT2);
+    if (right && down && !v_mBlocked[v + mWidth + 1])
+      search.relax(v, v + mWidth + 1, SQRT2);
+  }
+
+private:
+  void buildBands(const TiledGrid<unsigned char>* p_cells, const unsigned int* p_halfWidths, unsigned int inflation,
+                  unsigned int first, unsigned int step);
+
+  std::vector<unsigned char> v_mBlocked; //1 for cells occupied by an object
+  unsigned int mWidth;
+  unsigned int mHeight;
+};
+
+#endif /* SEARCH_GRAPHS_H_ */
@@ -0,0 +1,80 @@
+/*
+ * theta_star.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef THETA_STAR_H_
+#define THETA_STAR_H_
+#include <vector>
+
+#include "graph.h"
+#include "search_graphs.h"
+
+/*
+ * any-angle search on a grid (Theta*). like A* on the 8-connected grid, but a vertex may take the parent of the
+ * vertex it is reached from as its own parent when there is line of sight between them. the parents form a path
+ * of straight segments at any angle, with waypoints only where the path bends around an object.
+ *
+ * Lazy Theta* assumes line of sight when a vertex is reached and only checks it when the vertex is expanded,
+ * which needs far fewer line of sight checks for paths of about the same length.
+ *
+ * the search data is reused between queries, a ThetaStar that is reused does not allocate during a search.
+ * one ThetaStar serves one query at a time.
+ */
+class ThetaStar
+{
+public:
+  ThetaStar(const GridGraph &grid);
+  virtual ~ThetaStar();
+
+  bool search(unsigned int xStart, unsigned int yStart, unsigned int xTarget, unsigned int yTarget, bool lazy);
+  const std::vector<Point>& getPath() const;
+  float getCost() const;
+  unsigned int getExpanded() const;
+  unsigned int getSightChecks() const;
+
+  bool lineOfSight(unsigned int from, unsigned int to);
+
+  //called by the grid for every neighbour of an expanded vertex
+  void relax(unsigned int from, unsigned int to, float length);
+
+private:
+  struct HeapEntry
+  {
+    float f;
+    float g;
+    unsigned int v;
+  };
+  //reversed comparison, std heap functions keep the largest element on top
+  struct HeapCompare
+  {
+    bool operator()(const HeapEntry &a, const HeapEntry &b) const
+    {
+      return a.f > b.f || (a.f == b.f && a.g < b.g);
+    }
+  };
+  //finds the closed neighbour through which a vertex is reached cheapest, for Lazy Theta*
+  struct ClosedNeighbour
+  {
+    ThetaStar* p_mSearch;
+    unsigned int mBest;
+    float mBestG;
+    void relax(unsigned int from, unsigned int to, float length);
+  };
+
+  float distance(unsigned int a, unsigned int b) const;
+  void update(unsigned int v, unsigned int parent, float g);
+
+  const GridGraph &mGrid;
+  BasicSearchState<float> mState;
+  std::vector<HeapEntry> v_mHeap; //open list
+  std::vector<Point> v_mPath; //waypoints of the last path, from start to target
+  unsigned int mTarget;
+  bool mLazy;
+  float mCost;
+  unsigned int mExpanded;
+  unsigned int mSightChecks;
+};
+
+#endif /* THETA_STAR_H_ */
@@ -0,0 +1,40 @@
+/*
+ * tour.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef TOUR_H_
+#define TOUR_H_
+#include <vector>
+
+/*
+ * the order in which to visit a set of stops, given the cost between every pair of stops.
+ * the tour starts at stop 0 and ends at the last stop visited, it does not return.
+ * costs are assumed symmetric, as on the roadmap.
+ * nearestNeighbour() builds a first order, improve() shortens it with 2-opt and or-opt moves until neither helps.
+ */
+class Tour
+{
+public:
+  Tour(const std::vector<float> &v_costs, unsigned int stops);
+  virtual ~Tour();
+
+  void nearestNeighbour();
+  void improve();
+
+  const std::vector<unsigned int>& getOrder() const;
+  void setOrder(const std::vector<unsigned int> &v_order);
+  float getCost() const;
+
+private:
+  float cost(unsigned int a, unsigned int b) const;
+  bool twoOpt();
+  bool orOpt();
+
+  std::vector<float> v_mCosts; //cost from stop a to stop b at a * stops + b
+  unsigned int mStops;
+  std::vector<unsigned int> v_mOrder; //stops in visiting order, starting with stop 0
+};
+
+#endif /* TOUR_H_ */
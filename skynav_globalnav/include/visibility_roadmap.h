@@ -0,0 +1,76 @@
+/*
+ * visibility_roadmap.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef VISIBILITY_ROADMAP_H_
+#define VISIBILITY_ROADMAP_H_
+#include <vector>
+
+#include "graph.h"
+#include "search_graphs.h"
+
+class ThetaStar;
+
+#define VISIBILITY_INFLATION 1 //cells the objects are grown by, the radius of the robot
+#define VISIBILITY_TOLERANCE 1.0f //largest distance in cells between an object outline and the polygon that replaces it
+
+/*
+ * reduced visibility graph of a map: the nodes sit at the convex corners of the objects, the edges join every
+ * pair of corners that see each other and that a shortest path can run between (the edge touches both objects
+ * without entering the angle of their corners). for maps of straight walls this is a small graph on which
+ * the shortest paths are optimal.
+ *
+ * build() grows the objects by the inflation (as GridGraph does), traces the outline of every object,
+ * simplifies it to a polygon within VISIBILITY_TOLERANCE (less where the corners at the ends of a side would not see
+ * each other past the cells that were cut off), and takes the free cell outside every convex polygon
+ * corner as node. a staircase of cells along a slanted wall so usually only gives nodes at its ends.
+ * the nodes are numbered in the order of the map, the result only depends on the map.
+ */
+class VisibilityRoadmap
+{
+public:
+  VisibilityRoadmap(unsigned int inflation = VISIBILITY_INFLATION);
+  virtual ~VisibilityRoadmap();
+
+  void build(MapData* p_mapData);
+
+  const std::vector<Point>& getNodes() const;
+  const std::vector<std::pair<unsigned int, unsigned int> >& getEdges() const;
+  const std::vector<std::vector<Point> >& getPolygons() const;
+
+private:
+  //a convex corner of an object polygon, with the polygon corners before and after it
+  struct Corner
+  {
+    unsigned int mCell; //free cell outside the corner, the node
+    unsigned int mIndex; //index of the corner in its polygon
+    float mX; //the corner itself, on the boundary between cells
+    float mY;
+    float mPreviousX;
+    float mPreviousY;
+    float mNextX;
+    float mNextY;
+  };
+
+  bool isFree(int x, int y) const;
+  void traceContours(ThetaStar &sight);
+  void traceContour(ThetaStar &sight, unsigned int x, unsigned int y, unsigned int direction);
+  void addCorners(const std::vector<Point> &v_polygon);
+  bool seeAlongSides(ThetaStar &sight, unsigned int first, unsigned int polygonSize);
+  void connectCorners(ThetaStar &sight);
+  bool isTangent(const Corner &corner, float dx, float dy) const;
+
+  unsigned int mInflation;
+  GridGraph mGrid; //the map with the inflated objects
+  std::vector<unsigned char> v_mTraced; //per free cell, the sides towards an object that are part of a traced outline
+  std::vector<Point> v_mContour; //scratch, the corners of one outline
+  std::vector<Point> v_mPolygon; //scratch, the simplified outline
+  std::vector<Corner> v_mCorners;
+  std::vector<std::vector<Point> > v_mPolygons; //the simplified outlines, corners are on the boundaries between cells
+  std::vector<Point> v_mNodes; //the nodes, in map coordinates
+  std::vector<std::pair<unsigned int, unsigned int> > v_mEdges; //edges, as indices in v_mNodes
+};
+
+#endif /* VISIBILITY_ROADMAP_H_ */
@@ -6,8 +6,14 @@
  * Jurriaan Voskes
  */
 #include <ros/ros.h>
+#include <ros/package.h>
 #include <iostream>
 #include <stdio.h>
+#include <map>
+#include <deque>
+#include <cstdio>
+#include <climits>
+#include <cstdlib>
 
 #include <nav_msgs/OccupancyGrid.h>
 
@@ -17,16 +23,24 @@
 #include <skynav_msgs/environment_srv.h>
 #include <skynav_msgs/mapreader_srv.h>
 #include <skynav_msgs/edit_fixedWPs_srv.h>
+#include <skynav_msgs/map_edit_srv.h>
+#include <skynav_msgs/map_changes_srv.h>
+#include <skynav_msgs/MapPatch.h>
+#include <skynav_slam/shared_map.h>
+
+#include "environment_store.h"
 
 const int LOOP_RATE = 1;
 const int NO_LOOP = 0;
+const unsigned int MAP_HISTORY = 64; //edits kept as patches, changes since older edits are sent as the edited cells
+const std::string STORE_FILE = "environment.store"; //the maps with their fixed waypoints, in the package directory
 
 struct Map_Info
 {
   float mapHight;
   float mapWidth;
   float resolution;
-  std::vector<int8_t> mOccupancydata;
+  Shared_Map mOccupancydata; //the cells, in the shared memory segment of map_reader
 
   Map_Info()
   {
@@ -34,10 +48,6 @@ struct Map_Info
     this->mapWidth = 0;
     this->resolution = 1;
   }
-  ~Map_Info()
-  {
-    mOccupancydata.clear();
-  }
 };
 
 struct Node
@@ -50,6 +60,7 @@ struct Node
   {
     this->xPos = x;
     this->yPos = y;
+    this->theta = 0;
     this->type = type;
   }
 };
@@ -63,6 +74,10 @@ private:
   int loop_rate_;
   Map_Info* p_mMap_Info;
   std::string s_mMap_Filepath;
+  std::string s_mMap_Name; //the name of the map in the store
+  int64_t map_size_; //size of the map file when it was loaded
+  int64_t map_time_; //modification time of the map file when it was loaded
+  EnvironmentStore store_; //the maps loaded before, the last one is loaded again when the first request comes in
 
   //publishers
   //ros::Publisher environment_pub_;
@@ -71,6 +86,9 @@ private:
   ros::ServiceServer receive_newMap_srv_;
   ros::ServiceServer receive_fixedWPs_srv_;
   ros::Publisher re_init_pub_;
+  ros::Publisher map_updates_pub_;
+  ros::ServiceServer map_edit_srv_;
+  ros::ServiceServer map_changes_srv_;
 
   // subscribers
   ros::ServiceClient getMapRead_;
@@ -78,6 +96,18 @@ private:
 
   std::vector<Node*> v_pFixedWPs;
 
+  unsigned int map_edit_; //edits made to the map since it was loaded
+  std::map<unsigned int, int8_t> m_mEditedCells; //every cell edited since the map was loaded (y * width + x), its value now
+  std::deque<skynav_msgs::MapPatch> d_mHistory; //the last MAP_HISTORY edits
+
+  void clearEdits();
+  void setFixedWPs(const std::vector<StoredWaypoint> &v_waypoints);
+  void setMapFile(const std::string &filePath);
+  bool loadStoredMap();
+  void storeMap();
+  static std::string roadmapFile(const std::string &name);
+  void editedRuns(std::vector<skynav_msgs::CellRun> &v_runs);
+
 public:
   Environment(std::string node_name, int loop_rate);
   virtual ~Environment()
@@ -100,6 +130,8 @@ public:
   bool respond_newMap(skynav_msgs::mapreader_srv::Request &req, skynav_msgs::mapreader_srv::Response &res);
   bool respond_fixedWPs(skynav_msgs::edit_fixedWPs_srv::Request &req,
                         skynav_msgs::edit_fixedWPs_srv::Response &res);
+  bool respond_mapEdit(skynav_msgs::map_edit_srv::Request &req, skynav_msgs::map_edit_srv::Response &res);
+  bool respond_mapChanges(skynav_msgs::map_changes_srv::Request &req, skynav_msgs::map_changes_srv::Response &res);
   bool getMapRead(std::string filePath);
 };
 
@@ -114,10 +146,13 @@ Environment::Environment(std::string node_name, int loop_rate) :
   re_init_pub_ = node_->advertise<skynav_msgs::user_init>("user_init", 10);
   
   pubOccupancyGrid = node_->advertise<nav_msgs::OccupancyGrid>("occupancy_grid", 1);
+  map_updates_pub_ = node_->advertise<skynav_msgs::MapPatch>("map_updates", 10);
 
   environment_srv_ = node_->advertiseService("environment_req", &Environment::respond_environment, this);
   receive_newMap_srv_ = node_->advertiseService("update_map_req", &Environment::respond_newMap, this);
   receive_fixedWPs_srv_ = node_->advertiseService("edit_fixedWPs", &Environment::respond_fixedWPs, this);
+  map_edit_srv_ = node_->advertiseService("map_edit", &Environment::respond_mapEdit, this);
+  map_changes_srv_ = node_->advertiseService("map_changes", &Environment::respond_mapChanges, this);
 
   send_fixedWPS_srv_ = node_->serviceClient<skynav_msgs::edit_fixedWPs_srv>("update_fixed_waypoints");
 
@@ -125,6 +160,15 @@ Environment::Environment(std::string node_name, int loop_rate) :
 
   this->p_mMap_Info = new Map_Info();
   s_mMap_Filepath = "";
+  map_size_ = 0;
+  map_time_ = 0;
+  map_edit_ = 0;
+
+  //only the index is mapped, the map itself is read when it is first asked for
+  if (store_.open(ros::package::getPath("skynav_globalnav") + "/" + STORE_FILE))
+  {
+    ROS_INFO("%u maps in the environment store", store_.getMapCount());
+  }
 }
 
 /*
@@ -138,6 +182,10 @@ bool Environment::respond_environment(skynav_msgs::environment_srv::Request &req
   {
     skynav_msgs::environment_info msg;
     ROS_INFO("environment received request");
+    if (s_mMap_Filepath.empty())
+    {
+      loadStoredMap(); //no map given since startup, continue with the one loaded last
+    }
     if (!s_mMap_Filepath.empty()) //check if the filepath has been set, if not.. return false because no map has been loaded yet
     {
       ROS_INFO(" path: %s", s_mMap_Filepath.c_str());
@@ -145,12 +193,11 @@ bool Environment::respond_environment(skynav_msgs::environment_srv::Request &req
       msg.map.info.width = this->p_mMap_Info->mapWidth;
       msg.map.info.height = this->p_mMap_Info->mapHight;
       msg.map.info.resolution = this->p_mMap_Info->resolution;
-      msg.map.data.resize(this->p_mMap_Info->mapWidth * this->p_mMap_Info->mapHight);
-      std::vector<int8_t> data = this->p_mMap_Info->mOccupancydata;
-      for (uint i = 0; i < data.size(); i++)
-      {
-        msg.map.data[i] = data[i];
-      }
+      //only the segment of the cells is passed on, global_planner maps it
+      msg.map_segment = this->p_mMap_Info->mOccupancydata.getName();
+      msg.map_version = this->p_mMap_Info->mOccupancydata.getVersion();
+      msg.map_edits = map_edit_; //the segment holds the map as loaded, the edits are fetched with map_changes
+      msg.roadmap_file = roadmapFile(s_mMap_Name);
       for (std::vector<Node*>::iterator it = this->v_pFixedWPs.begin(); it != this->v_pFixedWPs.end(); it++)
       {
         geometry_msgs::Pose2D tmp_pose;
@@ -188,13 +235,25 @@ bool Environment::respond_newMap(skynav_msgs::mapreader_srv::Request &req,
     ROS_INFO("new map update requested");
     if (getMapRead(req.file_path)) //call the mapreader for parsing the given map
     {
-      this->s_mMap_Filepath = req.file_path;
+      setMapFile(req.file_path);
+      clearEdits();
 
-      for (std::vector<Node*>::iterator it = v_pFixedWPs.begin(); it != v_pFixedWPs.end(); it++)
+      //a map that was loaded before gets its fixed waypoints back, unless its file was replaced since: the waypoints
+      //and the roadmap belong to the old file. the roadmap is removed, global_planner builds a new one
+      StoredMap stored;
+      if (!store_.findMap(s_mMap_Name, stored))
+      {
+        stored.v_waypoints.clear();
+      }
+      else if (!EnvironmentStore::isUnchanged(stored))
       {
-        delete (*it);
+        ROS_WARN("map file %s changed since it was stored, its fixed waypoints and roadmap are dropped",
+                 stored.mapFile.c_str());
+        std::remove(stored.roadmapFile.c_str());
+        stored.v_waypoints.clear();
       }
-      this->v_pFixedWPs.clear();
+      setFixedWPs(stored.v_waypoints);
+      storeMap();
 
       res.response = 1;
       res.map.info.height = this->p_mMap_Info->mapHight;
@@ -202,13 +261,11 @@ bool Environment::respond_newMap(skynav_msgs::mapreader_srv::Request &req,
       //todo
       res.map.info.resolution = this->p_mMap_Info->resolution;
 
-      res.map.data.resize(this->p_mMap_Info->mapWidth * this->p_mMap_Info->mapHight);
-      std::vector<int8_t> data = this->p_mMap_Info->mOccupancydata;
-      for (uint i = 0; i < data.size(); i++)
-      {
-        res.map.data[i] = data[i];
-      }
-      data.clear(); //delete the temporary vector data<int>
+      //the gui draws the cells from the response
+      res.map.data.resize(res.map.info.width * res.map.info.height);
+      this->p_mMap_Info->mOccupancydata.copyTo(&res.map.data[0]);
+      res.segment = this->p_mMap_Info->mOccupancydata.getName();
+      res.version = this->p_mMap_Info->mOccupancydata.getVersion();
 
       skynav_msgs::user_init msg;
       msg.state = 1;
@@ -235,26 +292,30 @@ bool Environment::getMapRead(std::string filePath)
     if (getMapRead_.call(srv))
     {
       //process map data
+      if (!this->p_mMap_Info->mOccupancydata.open(srv.response.segment, srv.response.version))
+      {
+        ROS_ERROR("map segment %s of SLAM/mapreader can not be opened", srv.response.segment.c_str());
+        return false;
+      }
       this->p_mMap_Info->mapHight = srv.response.map.info.height;
       this->p_mMap_Info->mapWidth = srv.response.map.info.width;
       this->p_mMap_Info->resolution = srv.response.map.info.resolution;
 
-      this->p_mMap_Info->mOccupancydata.clear();
-      for (uint i = 0; i < srv.response.map.data.size(); i++)
-      {
-        this->p_mMap_Info->mOccupancydata.push_back(srv.response.map.data[i]);
-      }
-
       ROS_INFO("map H %f", this->p_mMap_Info->mapHight);
       ROS_INFO("map W %f", this->p_mMap_Info->mapWidth);
       ROS_INFO("map R %f", this->p_mMap_Info->resolution);
 	  
-	  // EXPERIMENTAL occupancy grid for rviz
+	  // EXPERIMENTAL occupancy grid for rviz, only copied out of the segment when it is shown
+	  if (pubOccupancyGrid.getNumSubscribers() == 0)
+	  {
+	    return true;
+	  }
 	  nav_msgs::OccupancyGrid og;
 	  og.header.frame_id = "/map";
 	  og.header.stamp = ros::Time::now();
 	  
-	  og.data = p_mMap_Info->mOccupancydata;
+	  og.data.resize(srv.response.map.info.width * srv.response.map.info.height);
+	  p_mMap_Info->mOccupancydata.copyTo(&og.data[0]);
 	  
 	  og.info.resolution = p_mMap_Info->resolution / 100;	//TODO resolution fix
 	  og.info.width = p_mMap_Info->mapWidth;
@@ -283,17 +344,19 @@ bool Environment::respond_fixedWPs(skynav_msgs::edit_fixedWPs_srv::Request &req,
   {
     ROS_INFO("received new set of fixed waypoints, clear old one");
 
-    for (std::vector<Node*>::iterator it = v_pFixedWPs.begin(); it != v_pFixedWPs.end(); it++)
+    std::vector<StoredWaypoint> v_waypoints;
+    for (std::vector<geometry_msgs::Pose2D>::iterator it = req.waypoints.begin(); it != req.waypoints.end(); it++)
     {
-      delete (*it);
+      StoredWaypoint waypoint;
+      waypoint.x = (*it).x;
+      waypoint.y = (*it).y;
+      waypoint.theta = (*it).theta;
+      v_waypoints.push_back(waypoint);
     }
-    this->v_pFixedWPs.clear();
-
-    std::vector<geometry_msgs::Pose2D> tmp_data = req.waypoints;
-    for (std::vector<geometry_msgs::Pose2D>::iterator it = tmp_data.begin(); it != tmp_data.end(); it++)
+    setFixedWPs(v_waypoints);
+    if (!s_mMap_Filepath.empty())
     {
-      Node* pNode = new Node((*it).x, (*it).y, "FIXED");
-      this->v_pFixedWPs.push_back(pNode);
+      storeMap();
     }
     ROS_INFO("updated fixed waypoints in environment information");
     /*
@@ -318,6 +381,222 @@ bool Environment::respond_fixedWPs(skynav_msgs::edit_fixedWPs_srv::Request &req,
   }
 }
 
+/*
+ * edit cells of the map, for instance when the map is being built or an operator marks an area.
+ * the map in the shared memory segment is left as loaded: the edits are kept here, published as a patch on
+ * map_updates, and sent to nodes that missed patches by map_changes
+ */
+bool Environment::respond_mapEdit(skynav_msgs::map_edit_srv::Request &req, skynav_msgs::map_edit_srv::Response &res)
+{
+  if (!req.request || s_mMap_Filepath.empty())
+  {
+    ROS_ERROR("no map to edit");
+    return false;
+  }
+  unsigned int width = this->p_mMap_Info->mOccupancydata.getWidth();
+  unsigned int height = this->p_mMap_Info->mOccupancydata.getHeight();
+
+  skynav_msgs::MapPatch patch;
+  patch.header.stamp = ros::Time::now();
+  patch.header.frame_id = "/map";
+  patch.map_version = this->p_mMap_Info->mOccupancydata.getVersion();
+  patch.from_edit = map_edit_;
+  for (std::vector<skynav_msgs::CellRun>::iterator it = req.runs.begin(); it != req.runs.end(); it++)
+  {
+    if ((*it).x >= width || (*it).y >= height)
+    {
+      continue;
+    }
+    skynav_msgs::CellRun run = *it;
+    run.length = std::min(run.length, width - run.x); //runs do not wrap to the next row
+    for (unsigned int i = 0; i < run.length; i++)
+    {
+      m_mEditedCells[run.y * width + run.x + i] = run.value;
+    }
+    if (run.length > 0)
+    {
+      patch.runs.push_back(run);
+    }
+  }
+  res.response = !patch.runs.empty();
+  if (patch.runs.empty())
+  {
+    res.edit = map_edit_;
+    return true;
+  }
+  patch.to_edit = ++map_edit_;
+  d_mHistory.push_back(patch);
+  if (d_mHistory.size() > MAP_HISTORY)
+  {
+    d_mHistory.pop_front();
+  }
+  map_updates_pub_.publish(patch);
+  ROS_INFO("map edit %u, %lu runs", map_edit_, (unsigned long)patch.runs.size());
+  res.edit = map_edit_;
+  return true;
+}
+
+/*
+ * respond with the cells changed since an edit of the map, so a node that missed patches catches up without
+ * loading the map again. the patches since the edit when they are still kept, otherwise all edited cells.
+ * full is set when the map has been replaced since, the caller has to load the new one
+ */
+bool Environment::respond_mapChanges(skynav_msgs::map_changes_srv::Request &req,
+                                     skynav_msgs::map_changes_srv::Response &res)
+{
+  if (s_mMap_Filepath.empty())
+  {
+    ROS_ERROR("no map initialized yet");
+    return false;
+  }
+  res.map_version = this->p_mMap_Info->mOccupancydata.getVersion();
+  res.edit = map_edit_;
+  res.full = req.map_version != res.map_version;
+  if (res.full || req.since_edit >= map_edit_)
+  {
+    return true;
+  }
+  if (!d_mHistory.empty() && d_mHistory.front().from_edit <= req.since_edit)
+  {
+    for (std::deque<skynav_msgs::MapPatch>::iterator it = d_mHistory.begin(); it != d_mHistory.end(); it++)
+    {
+      if ((*it).from_edit >= req.since_edit)
+      {
+        res.runs.insert(res.runs.end(), (*it).runs.begin(), (*it).runs.end());
+      }
+    }
+  }
+  else
+  {
+    editedRuns(res.runs);
+  }
+  return true;
+}
+
+//replace the fixed waypoints
+void Environment::setFixedWPs(const std::vector<StoredWaypoint> &v_waypoints)
+{
+  for (std::vector<Node*>::iterator it = v_pFixedWPs.begin(); it != v_pFixedWPs.end(); it++)
+  {
+    delete (*it);
+  }
+  this->v_pFixedWPs.clear();
+  for (std::vector<StoredWaypoint>::const_iterator it = v_waypoints.begin(); it != v_waypoints.end(); it++)
+  {
+    Node* pNode = new Node((*it).x, (*it).y, "FIXED");
+    pNode->theta = (*it).theta;
+    this->v_pFixedWPs.push_back(pNode);
+  }
+}
+
+/*
+ * load the map that was loaded last, with its fixed waypoints, from the store. map_reader reads the map file,
+ * nobody has to give the map again after a restart
+ */
+bool Environment::loadStoredMap()
+{
+  StoredMap stored;
+  if (!store_.getCurrentMap(stored))
+  {
+    return false;
+  }
+  ROS_INFO("loading stored map %s", stored.name.c_str());
+  if (!getMapRead(stored.mapFile))
+  {
+    return false;
+  }
+  setMapFile(stored.mapFile);
+  clearEdits();
+  if (EnvironmentStore::isUnchanged(stored))
+  {
+    setFixedWPs(stored.v_waypoints);
+  }
+  else
+  {
+    //as a map given through the gui, the waypoints and roadmap of the old file are dropped
+    ROS_WARN("map file %s changed since it was stored, its fixed waypoints and roadmap are dropped",
+             stored.mapFile.c_str());
+    std::remove(stored.roadmapFile.c_str());
+    setFixedWPs(std::vector<StoredWaypoint>());
+    storeMap(); //the store keeps the file as it is now
+  }
+  return true;
+}
+
+//the map file is loaded, it is stored by its canonical path with the size and modification time it has now
+void Environment::setMapFile(const std::string &filePath)
+{
+  char canonical[PATH_MAX];
+  StoredMap file;
+  file.mapFile = realpath(filePath.c_str(), canonical) ? std::string(canonical) : filePath;
+  file.mapSize = 0;
+  file.mapTime = 0;
+  EnvironmentStore::statMapFile(file);
+  this->s_mMap_Filepath = file.mapFile;
+  this->s_mMap_Name = EnvironmentStore::mapName(file.mapFile);
+  this->map_size_ = file.mapSize;
+  this->map_time_ = file.mapTime;
+}
+
+//put the current map with its fixed waypoints in the store, as the map to load at startup
+void Environment::storeMap()
+{
+  StoredMap stored;
+  stored.name = s_mMap_Name;
+  stored.mapFile = s_mMap_Filepath;
+  stored.roadmapFile = roadmapFile(s_mMap_Name);
+  stored.mapSize = map_size_;
+  stored.mapTime = map_time_;
+  for (std::vector<Node*>::iterator it = v_pFixedWPs.begin(); it != v_pFixedWPs.end(); it++)
+  {
+    StoredWaypoint waypoint;
+    waypoint.x = (*it)->xPos;
+    waypoint.y = (*it)->yPos;
+    waypoint.theta = (*it)->theta;
+    stored.v_waypoints.push_back(waypoint);
+  }
+  store_.putMap(stored, true);
+}
+
+//the file global_planner keeps the roadmap of a map in, in the package directory
+std::string Environment::roadmapFile(const std::string &name)
+{
+  return ros::package::getPath("skynav_globalnav") + "/roadmap_" + name + ".txt";
+}
+
+//forget the edits, a new map is loaded
+void Environment::clearEdits()
+{
+  map_edit_ = 0;
+  m_mEditedCells.clear();
+  d_mHistory.clear();
+}
+
+//the edited cells as runs along the rows, cells next to each other with the same value form one run
+void Environment::editedRuns(std::vector<skynav_msgs::CellRun> &v_runs)
+{
+  unsigned int width = this->p_mMap_Info->mOccupancydata.getWidth();
+  for (std::map<unsigned int, int8_t>::iterator it = m_mEditedCells.begin(); it != m_mEditedCells.end(); it++)
+  {
+    if (!v_runs.empty())
+    {
+      skynav_msgs::CellRun &last = v_runs.back();
+      unsigned int end = last.y * width + last.x + last.length;
+      if (it->first == end && end % width != 0 && it->second == last.value)
+      {
+        last.length++;
+        continue;
+      }
+    }
+    skynav_msgs::CellRun run;
+    run.x = it->first % width;
+    run.y = it->first / width;
+    run.length = 1;
+    run.value = it->second;
+    v_runs.push_back(run);
+  }
+}
+
 void Environment::loop()
 {
   ROS_INFO("started environment");
@@ -0,0 +1,313 @@
+/*
+ * environment_store.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "environment_store.h"
+#include <ros/ros.h>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <cctype>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+//maps in the order of the index
+static bool nameLess(const StoredMap &a, const StoredMap &b)
+{
+  return a.name < b.name;
+}
+
+EnvironmentStore::EnvironmentStore()
+{
+  this->p_mData = NULL;
+  this->mSize = 0;
+}
+
+EnvironmentStore::~EnvironmentStore()
+{
+  close();
+}
+
+/*
+ * map the store file into memory. only the header is checked, the maps are read when they are asked for.
+ * a store that does not exist yet is empty and is created by the first putMap(); a damaged one is ignored
+ */
+bool EnvironmentStore::open(const std::string &filePath)
+{
+  close();
+  mFilePath = filePath;
+  int fd = ::open(filePath.c_str(), O_RDONLY);
+  if (fd < 0)
+  {
+    return true; //nothing stored yet
+  }
+  struct stat st;
+  void* p_map = MAP_FAILED;
+  if (fstat(fd, &st) == 0 && st.st_size >= (off_t)sizeof(Header))
+  {
+    p_map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  ::close(fd); //the mapping stays valid
+  if (p_map == MAP_FAILED)
+  {
+    ROS_ERROR("environment store %s can not be read", filePath.c_str());
+    return false;
+  }
+  p_mData = (const char*) p_map;
+  mSize = st.st_size;
+
+  if (memcmp(header()->magic, ENVIRONMENT_STORE_MAGIC, sizeof(ENVIRONMENT_STORE_MAGIC)) != 0
+      || header()->version != ENVIRONMENT_STORE_VERSION
+      || mSize < sizeof(Header) + size_t(header()->mapCount) * sizeof(Entry)
+          + size_t(header()->waypointCount) * sizeof(StoredWaypoint))
+  {
+    ROS_ERROR("environment store %s is damaged or of another version, it is ignored", filePath.c_str());
+    close();
+    return false;
+  }
+  return true;
+}
+
+void EnvironmentStore::close()
+{
+  if (p_mData)
+  {
+    munmap((void*) p_mData, mSize);
+  }
+  p_mData = NULL;
+  mSize = 0;
+}
+
+const EnvironmentStore::Header* EnvironmentStore::header() const
+{
+  return (const Header*) p_mData;
+}
+
+const EnvironmentStore::Entry* EnvironmentStore::entries() const
+{
+  return (const Entry*) (p_mData + sizeof(Header));
+}
+
+const StoredWaypoint* EnvironmentStore::waypoints() const
+{
+  return (const StoredWaypoint*) (p_mData + sizeof(Header) + header()->mapCount * sizeof(Entry));
+}
+
+unsigned int EnvironmentStore::getMapCount() const
+{
+  return p_mData ? header()->mapCount : 0;
+}
+
+//the index of a map in the store, by binary search. -1 if it is not stored
+int EnvironmentStore::find(const std::string &name) const
+{
+  int low = 0;
+  int high = int(getMapCount()) - 1;
+  while (low <= high)
+  {
+    int middle = (low + high) / 2;
+    int order = strncmp(entries()[middle].name, name.c_str(), STORE_NAME_SIZE);
+    if (order == 0)
+    {
+      return middle;
+    }
+    if (order < 0)
+    {
+      low = middle + 1;
+    }
+    else
+    {
+      high = middle - 1;
+    }
+  }
+  return -1;
+}
+
+//copy a map out of the store, its strings are cut off at their field size should the store be damaged
+void EnvironmentStore::read(unsigned int index, StoredMap &map) const
+{
+  const Entry &entry = entries()[index];
+  map.name.assign(entry.name, strnlen(entry.name, STORE_NAME_SIZE));
+  map.mapFile.assign(entry.mapFile, strnlen(entry.mapFile, STORE_PATH_SIZE));
+  map.roadmapFile.assign(entry.roadmapFile, strnlen(entry.roadmapFile, STORE_PATH_SIZE));
+  map.mapSize = entry.mapSize;
+  map.mapTime = entry.mapTime;
+  map.v_waypoints.clear();
+  if (entry.firstWaypoint <= header()->waypointCount
+      && entry.waypointCount <= header()->waypointCount - entry.firstWaypoint)
+  {
+    map.v_waypoints.assign(waypoints() + entry.firstWaypoint,
+                           waypoints() + entry.firstWaypoint + entry.waypointCount);
+  }
+}
+
+bool EnvironmentStore::findMap(const std::string &name, StoredMap &map) const
+{
+  int index = find(name);
+  if (index < 0)
+  {
+    return false;
+  }
+  read(index, map);
+  return true;
+}
+
+//the map that was loaded last, to load again at startup
+bool EnvironmentStore::getCurrentMap(StoredMap &map) const
+{
+  if (!p_mData || header()->current < 0 || header()->current >= int(header()->mapCount))
+  {
+    return false;
+  }
+  read(header()->current, map);
+  return true;
+}
+
+/*
+ * store a map, or replace the stored map of the same name. current makes it the map loaded at startup.
+ * the store is written and mapped again
+ */
+bool EnvironmentStore::putMap(const StoredMap &map, bool current)
+{
+  if (map.name.empty() || map.name.size() >= STORE_NAME_SIZE || map.mapFile.size() >= STORE_PATH_SIZE
+      || map.roadmapFile.size() >= STORE_PATH_SIZE)
+  {
+    ROS_ERROR("map %s can not be stored, its name or a path is too long", map.name.c_str());
+    return false;
+  }
+  std::string currentName;
+  StoredMap stored;
+  if (getCurrentMap(stored))
+  {
+    currentName = stored.name;
+  }
+  if (current)
+  {
+    currentName = map.name;
+  }
+
+  std::vector<StoredMap> v_maps(getMapCount());
+  for (unsigned int i = 0; i < v_maps.size(); i++)
+  {
+    read(i, v_maps[i]);
+  }
+  int index = find(map.name);
+  if (index >= 0)
+  {
+    v_maps[index] = map;
+  }
+  else
+  {
+    v_maps.push_back(map);
+    std::sort(v_maps.begin(), v_maps.end(), nameLess);
+  }
+  int currentIndex = -1;
+  for (unsigned int i = 0; i < v_maps.size(); i++)
+  {
+    if (v_maps[i].name == currentName)
+    {
+      currentIndex = i;
+    }
+  }
+  return write(v_maps, currentIndex) && open(mFilePath);
+}
+
+//write the maps, sorted by name, to the store file
+bool EnvironmentStore::write(const std::vector<StoredMap> &v_maps, int current)
+{
+  std::string tempPath = mFilePath + ".tmp";
+  FILE* p_file = fopen(tempPath.c_str(), "wb");
+  if (!p_file)
+  {
+    ROS_ERROR("can not write %s", tempPath.c_str());
+    return false;
+  }
+  Header newHeader;
+  memset(&newHeader, 0, sizeof(newHeader));
+  memcpy(newHeader.magic, ENVIRONMENT_STORE_MAGIC, sizeof(newHeader.magic));
+  newHeader.version = ENVIRONMENT_STORE_VERSION;
+  newHeader.mapCount = v_maps.size();
+  newHeader.current = current;
+
+  std::vector<Entry> v_entries(v_maps.size());
+  for (unsigned int i = 0; i < v_maps.size(); i++)
+  {
+    Entry &entry = v_entries[i];
+    memset(&entry, 0, sizeof(entry));
+    strncpy(entry.name, v_maps[i].name.c_str(), STORE_NAME_SIZE - 1);
+    strncpy(entry.mapFile, v_maps[i].mapFile.c_str(), STORE_PATH_SIZE - 1);
+    strncpy(entry.roadmapFile, v_maps[i].roadmapFile.c_str(), STORE_PATH_SIZE - 1);
+    entry.mapSize = v_maps[i].mapSize;
+    entry.mapTime = v_maps[i].mapTime;
+    entry.firstWaypoint = newHeader.waypointCount;
+    entry.waypointCount = v_maps[i].v_waypoints.size();
+    newHeader.waypointCount += entry.waypointCount;
+  }
+  bool ok = fwrite(&newHeader, sizeof(newHeader), 1, p_file) == 1;
+  ok = ok && (v_entries.empty() || fwrite(&v_entries[0], sizeof(Entry), v_entries.size(), p_file) == v_entries.size());
+  for (unsigned int i = 0; ok && i < v_maps.size(); i++)
+  {
+    const std::vector<StoredWaypoint> &v_waypoints = v_maps[i].v_waypoints;
+    ok = v_waypoints.empty()
+        || fwrite(&v_waypoints[0], sizeof(StoredWaypoint), v_waypoints.size(), p_file) == v_waypoints.size();
+  }
+  ok = (fclose(p_file) == 0) && ok;
+  if (!ok || std::rename(tempPath.c_str(), mFilePath.c_str()) != 0)
+  {
+    ROS_ERROR("writing %s failed", mFilePath.c_str());
+    std::remove(tempPath.c_str());
+    return false;
+  }
+  return true;
+}
+
+/*
+ * the name a map file is stored under: the file name without its extension, characters other than letters,
+ * digits, '-' and '_' replaced by '_', followed by a hash of the canonical path of the file.
+ * files with the same name in different directories are different maps
+ */
+std::string EnvironmentStore::mapName(const std::string &canonicalPath)
+{
+  uint32_t hash = 2166136261u; //FNV-1a
+  for (unsigned int i = 0; i < canonicalPath.size(); i++)
+  {
+    hash = (hash ^ (unsigned char) canonicalPath[i]) * 16777619u;
+  }
+  char suffix[10];
+  snprintf(suffix, sizeof(suffix), "_%08x", hash);
+
+  std::string name = canonicalPath.substr(canonicalPath.find_last_of('/') + 1);
+  name = name.substr(0, std::min(name.rfind('.'), size_t(STORE_NAME_SIZE - sizeof(suffix))));
+  for (unsigned int i = 0; i < name.size(); i++)
+  {
+    if (!isalnum(name[i]) && name[i] != '-' && name[i] != '_')
+    {
+      name[i] = '_';
+    }
+  }
+  return (name.empty() ? "map" : name) + suffix;
+}
+
+//take the size and modification time of the map file of map, false if the file can not be read
+bool EnvironmentStore::statMapFile(StoredMap &map)
+{
+  struct stat st;
+  if (stat(map.mapFile.c_str(), &st) != 0)
+  {
+    return false;
+  }
+  map.mapSize = st.st_size;
+  map.mapTime = int64_t(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+  return true;
+}
+
+//whether the map file of a stored map is still the file that was stored, its waypoints and roadmap belong to it
+bool EnvironmentStore::isUnchanged(const StoredMap &map)
+{
+  StoredMap current = map;
+  return statMapFile(current) && current.mapSize == map.mapSize && current.mapTime == map.mapTime;
+}
@@ -0,0 +1,97 @@
+/*
+ * environment_store.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef ENVIRONMENT_STORE_H_
+#define ENVIRONMENT_STORE_H_
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+/*
+ * the maps the environment has been given, by name, with their fixed waypoints and the file of their roadmap.
+ * the name of a map is made from the canonical path of its file, and the size and modification time of the file
+ * are kept with the map, a stored map is only used while its file is unchanged.
+ * kept in one binary file that is mapped into memory when the store is opened: a header, an index of the maps
+ * sorted by name, and the waypoints of all maps. a map is found in the index by binary search, and only its own
+ * waypoints are copied out, so nothing is parsed at startup.
+ *
+ * every change writes the store to a temporary file that then replaces it, a crash never leaves half a store.
+ * little endian, as the binary maps of map_reader.
+ */
+const char ENVIRONMENT_STORE_MAGIC[8] = {'S', 'K', 'Y', 'N', 'A', 'V', 'E', 'S'};
+const uint32_t ENVIRONMENT_STORE_VERSION = 2;
+
+#define STORE_NAME_SIZE 64
+#define STORE_PATH_SIZE 256
+
+struct StoredWaypoint
+{
+  float x;
+  float y;
+  float theta;
+};
+
+struct StoredMap
+{
+  std::string name;
+  std::string mapFile; //the map file, as read by map_reader
+  std::string roadmapFile; //the roadmap of the map with its learned edge costs, saved by global_planner
+  int64_t mapSize; //size of the map file when it was stored
+  int64_t mapTime; //modification time of the map file when it was stored, in nanoseconds
+  std::vector<StoredWaypoint> v_waypoints;
+};
+
+class EnvironmentStore
+{
+public:
+  EnvironmentStore();
+  virtual ~EnvironmentStore();
+
+  bool open(const std::string &filePath);
+  void close();
+
+  unsigned int getMapCount() const;
+  bool findMap(const std::string &name, StoredMap &map) const;
+  bool getCurrentMap(StoredMap &map) const;
+  bool putMap(const StoredMap &map, bool current);
+
+  static std::string mapName(const std::string &canonicalPath);
+  static bool statMapFile(StoredMap &map);
+  static bool isUnchanged(const StoredMap &map);
+
+private:
+  struct Header
+  {
+    char magic[8];
+    uint32_t version;
+    uint32_t mapCount;
+    int32_t current; //index of the map loaded last, -1 when none is
+    uint32_t waypointCount;
+  };
+  struct Entry
+  {
+    char name[STORE_NAME_SIZE];
+    char mapFile[STORE_PATH_SIZE];
+    char roadmapFile[STORE_PATH_SIZE];
+    int64_t mapSize;
+    int64_t mapTime;
+    uint32_t firstWaypoint;
+    uint32_t waypointCount;
+  };
+
+  const Header* header() const;
+  const Entry* entries() const;
+  const StoredWaypoint* waypoints() const;
+  int find(const std::string &name) const;
+  void read(unsigned int index, StoredMap &map) const;
+  bool write(const std::vector<StoredMap> &v_maps, int current);
+
+  std::string mFilePath;
+  const char* p_mData; //the mapped store, NULL when the store is empty
+  size_t mSize;
+};
+
+#endif /* ENVIRONMENT_STORE_H_ */
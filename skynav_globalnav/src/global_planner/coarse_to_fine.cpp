@@ -0,0 +1,192 @@
+/*
+ * coarse_to_fine.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "coarse_to_fine.h"
+
+PyramidLevelGraph::PyramidLevelGraph(const MapPyramid &pyramid) :
+    mPyramid(pyramid)
+{
+  this->mLevel = 0;
+  this->mWidth = 0;
+  this->mHeight = 0;
+  this->mSource = NO_VERTEX;
+  this->mTarget = NO_VERTEX;
+}
+
+//search on level, from the coarse cell source to target
+void PyramidLevelGraph::setLevel(unsigned int level, unsigned int source, unsigned int target)
+{
+  this->mLevel = level;
+  this->mWidth = mPyramid.getWidth(level);
+  this->mHeight = mPyramid.getHeight(level);
+  this->mSource = source;
+  this->mTarget = target;
+}
+
+CorridorGrid::CorridorGrid(const GridGraph &grid) :
+    mGrid(grid)
+{
+  this->p_mCorridor = NULL;
+  this->mLevel = 0;
+  this->mCorridorWidth = 0;
+}
+
+//the marked cells of a level of width cells, NULL to search the whole grid
+void CorridorGrid::setCorridor(const std::vector<unsigned char>* p_corridor, unsigned int level, unsigned int width)
+{
+  this->p_mCorridor = p_corridor;
+  this->mLevel = level;
+  this->mCorridorWidth = width;
+}
+
+CoarseToFineSearch::CoarseToFineSearch(const GridGraph &grid, const MapPyramid &pyramid) :
+    mGrid(grid), mPyramid(pyramid), mLevelGraph(pyramid), mCoarse(mLevelGraph), mCorridorGrid(grid),
+    mFine(mCorridorGrid), mSight(grid)
+{
+  this->mCost = 0;
+  this->mExpanded = 0;
+  this->mLevel = 0;
+}
+
+CoarseToFineSearch::~CoarseToFineSearch()
+{
+}
+
+const std::vector<Point>& CoarseToFineSearch::getPath() const
+{
+  return v_mPath;
+}
+
+//length of the last path
+float CoarseToFineSearch::getCost() const
+{
+  return mCost;
+}
+
+//vertices expanded by the last query, on the levels and on the grid
+unsigned int CoarseToFineSearch::getExpanded() const
+{
+  return mExpanded;
+}
+
+//the level whose corridor held the last path, 0 when the whole grid was searched
+unsigned int CoarseToFineSearch::getLevel() const
+{
+  return mLevel;
+}
+
+/*
+ * search a path between two cells, from the top level of the pyramid down.
+ * on success getPath() holds the waypoints from start to target
+ */
+bool CoarseToFineSearch::search(unsigned int xStart, unsigned int yStart, unsigned int xTarget,
+                                unsigned int yTarget)
+{
+  v_mPath.clear();
+  mCost = 0;
+  mExpanded = 0;
+  mLevel = 0;
+  if (xStart >= mGrid.getWidth() || yStart >= mGrid.getHeight() || xTarget >= mGrid.getWidth()
+      || yTarget >= mGrid.getHeight())
+  {
+    return false;
+  }
+  unsigned int start = mGrid.getVertex(xStart, yStart);
+  unsigned int target = mGrid.getVertex(xTarget, yTarget);
+  if (mGrid.isBlocked(start) || mGrid.isBlocked(target))
+  {
+    return false;
+  }
+
+  bool found = false;
+  for (unsigned int level = mPyramid.getLevels(); level > 1 && !found; level--)
+  {
+    mLevel = level - 1;
+    found = searchLevel(mLevel, start, target) && searchCorridor(start, target);
+  }
+  if (!found)
+  {
+    mLevel = 0;
+    mCorridorGrid.setCorridor(NULL, 0, 0);
+    found = searchCorridor(start, target);
+  }
+  if (found)
+  {
+    straighten();
+  }
+  return found;
+}
+
+//search the coarse path on a level and mark the corridor around it
+bool CoarseToFineSearch::searchLevel(unsigned int level, unsigned int start, unsigned int target)
+{
+  unsigned int width = mPyramid.getWidth(level);
+  unsigned int height = mPyramid.getHeight(level);
+  unsigned int source = (mGrid.getY(start) >> level) * width + (mGrid.getX(start) >> level);
+  unsigned int coarseTarget = (mGrid.getY(target) >> level) * width + (mGrid.getX(target) >> level);
+  mLevelGraph.setLevel(level, source, coarseTarget);
+  bool found = mCoarse.search(source, coarseTarget);
+  mExpanded += mCoarse.getExpanded();
+  if (!found)
+  {
+    return false;
+  }
+
+  mCoarse.getPath(coarseTarget, v_mVertices);
+  v_mCorridor.assign(width * height, 0);
+  int radius = CORRIDOR_RADIUS;
+  for (std::vector<unsigned int>::iterator it = v_mVertices.begin(); it != v_mVertices.end(); it++)
+  {
+    int x = mLevelGraph.getX(*it);
+    int y = mLevelGraph.getY(*it);
+    for (int dy = std::max(-radius, -y); dy <= radius && y + dy < int(height); dy++)
+    {
+      for (int dx = std::max(-radius, -x); dx <= radius && x + dx < int(width); dx++)
+      {
+        v_mCorridor[(y + dy) * width + x + dx] = 1;
+      }
+    }
+  }
+  mCorridorGrid.setCorridor(&v_mCorridor, level, width);
+  return true;
+}
+
+//A* on the grid within the corridor that is set, the path is left in v_mVertices
+bool CoarseToFineSearch::searchCorridor(unsigned int start, unsigned int target)
+{
+  bool found = mFine.search(start, target);
+  mExpanded += mFine.getExpanded();
+  if (found)
+  {
+    mFine.getPath(target, v_mVertices);
+  }
+  return found;
+}
+
+/*
+ * turn the grid path into straight segments: from every waypoint the path goes straight to the farthest cell of the
+ * grid path that is in sight, as in Theta*, but only along the cells of the path that was found
+ */
+void CoarseToFineSearch::straighten()
+{
+  std::reverse(v_mVertices.begin(), v_mVertices.end());
+  unsigned int anchor = 0;
+  v_mPath.push_back(Point(mGrid.getX(v_mVertices[0]), mGrid.getY(v_mVertices[0])));
+  for (unsigned int i = 2; i <= v_mVertices.size(); i++)
+  {
+    if (i < v_mVertices.size() && mSight.lineOfSight(v_mVertices[anchor], v_mVertices[i]))
+    {
+      continue;
+    }
+    //the cell before i is the farthest one in sight
+    const Point &from = v_mPath.back();
+    anchor = i - 1;
+    float dx = float(mGrid.getX(v_mVertices[anchor])) - float(from.mXpos);
+    float dy = float(mGrid.getY(v_mVertices[anchor])) - float(from.mYpos);
+    mCost += sqrtf(dx * dx + dy * dy);
+    v_mPath.push_back(Point(mGrid.getX(v_mVertices[anchor]), mGrid.getY(v_mVertices[anchor])));
+  }
+}
@@ -0,0 +1,198 @@
+/*
+ * coarse_to_fine.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef COARSE_TO_FINE_H_
+#define COARSE_TO_FINE_H_
+#include <vector>
+
+#include "graph.h"
+#include "search_graphs.h"
+#include "map_pyramid.h"
+#include "theta_star.h"
+
+#define CORRIDOR_RADIUS 1 //coarse cells around the coarse path that the fine search may use
+
+/*
+ * one level of a MapPyramid as an 8-connected graph, like GridGraph. the cells of the start and the target are
+ * passable even when they are occupied at this level: the start and target are free on the map, but the coarse
+ * cells around them can hold an object.
+ */
+class PyramidLevelGraph
+{
+public:
+  PyramidLevelGraph(const MapPyramid &pyramid);
+
+  void setLevel(unsigned int level, unsigned int source, unsigned int target);
+
+  unsigned int size() const
+  {
+    return mWidth * mHeight;
+  }
+  unsigned int getX(unsigned int v) const
+  {
+    return v % mWidth;
+  }
+  unsigned int getY(unsigned int v) const
+  {
+    return v / mWidth;
+  }
+  unsigned int getWidth() const
+  {
+    return mWidth;
+  }
+  unsigned int getVertex(unsigned int x, unsigned int y) const
+  {
+    return y * mWidth + x;
+  }
+  bool isBlocked(unsigned int v) const
+  {
+    return v != mSource && v != mTarget && mPyramid.isOccupied(mLevel, getX(v), getY(v));
+  }
+  template<class SearchT>
+  void expand(unsigned int v, SearchT &search) const
+  {
+    unsigned int x = getX(v);
+    unsigned int y = getY(v);
+    bool left = x > 0 && !isBlocked(v - 1);
+    bool right = x + 1 < mWidth && !isBlocked(v + 1);
+    bool up = y > 0 && !isBlocked(v - mWidth);
+    bool down = y + 1 < mHeight && !isBlocked(v + mWidth);
+
+    if (left)
+      search.relax(v, v - 1, 1);
+    if (right)
+      search.relax(v, v + 1, 1);
+    if (up)
+      search.relax(v, v - mWidth, 1);
+    if (down)
+      search.relax(v, v + mWidth, 1);
+    if (left && up && !isBlocked(v - mWidth - 1))
+      search.relax(v, v - mWidth - 1, SQRT2);
+    if (right && up && !isBlocked(v - mWidth + 1))
+      search.relax(v, v - mWidth + 1, SQRT2);
+    if (left && down && !isBlocked(v + mWidth - 1))
+      search.relax(v, v + mWidth - 1, SQRT2);
+    if (right && down && !isBlocked(v + mWidth + 1))
+      search.relax(v, v + mWidth + 1, SQRT2);
+  }
+
+private:
+  const MapPyramid &mPyramid;
+  unsigned int mLevel;
+  unsigned int mWidth;
+  unsigned int mHeight;
+  unsigned int mSource;
+  unsigned int mTarget;
+};
+
+/*
+ * a GridGraph restricted to a corridor: the cells of the grid below the marked cells of a pyramid level.
+ * without a corridor the whole grid is searched
+ */
+class CorridorGrid
+{
+public:
+  CorridorGrid(const GridGraph &grid);
+
+  void setCorridor(const std::vector<unsigned char>* p_corridor, unsigned int level, unsigned int width);
+
+  unsigned int size() const
+  {
+    return mGrid.size();
+  }
+  unsigned int getX(unsigned int v) const
+  {
+    return mGrid.getX(v);
+  }
+  unsigned int getY(unsigned int v) const
+  {
+    return mGrid.getY(v);
+  }
+  bool inCorridor(unsigned int v) const
+  {
+    return (*p_mCorridor)[(getY(v) >> mLevel) * mCorridorWidth + (getX(v) >> mLevel)] != 0;
+  }
+  template<class SearchT>
+  void expand(unsigned int v, SearchT &search) const
+  {
+    if (!p_mCorridor)
+    {
+      mGrid.expand(v, search);
+      return;
+    }
+    Filter<SearchT> filter(*this, search);
+    mGrid.expand(v, filter);
+  }
+
+private:
+  //passes on the neighbours that lie in the corridor
+  template<class SearchT>
+  struct Filter
+  {
+    const CorridorGrid &mCorridor;
+    SearchT &mSearch;
+    Filter(const CorridorGrid &corridor, SearchT &search) :
+        mCorridor(corridor), mSearch(search)
+    {
+    }
+    void relax(unsigned int from, unsigned int to, float length)
+    {
+      if (mCorridor.inCorridor(to))
+      {
+        mSearch.relax(from, to, length);
+      }
+    }
+  };
+
+  const GridGraph &mGrid;
+  const std::vector<unsigned char>* p_mCorridor; //1 for the cells of the corridor level, NULL for the whole grid
+  unsigned int mLevel;
+  unsigned int mCorridorWidth;
+};
+
+/*
+ * coarse-to-fine search on a grid. the path is first searched on the top level of the map pyramid, then A* on the
+ * grid only expands the cells in a corridor around the coarse path, and the grid path is straightened by line of
+ * sight. a level closes narrow passages, so when the coarse search or the search in its corridor fails the next
+ * finer level is tried, and the whole grid last. the path can be longer than the shortest one when the coarse path
+ * takes another way around an object than the shortest path.
+ *
+ * the pyramid is of the map without inflation, the grid may be inflated: a corridor that turns out to be blocked
+ * on the grid falls back as well. the search data is reused between queries, one search serves one query at a time.
+ */
+class CoarseToFineSearch
+{
+public:
+  CoarseToFineSearch(const GridGraph &grid, const MapPyramid &pyramid);
+  virtual ~CoarseToFineSearch();
+
+  bool search(unsigned int xStart, unsigned int yStart, unsigned int xTarget, unsigned int yTarget);
+  const std::vector<Point>& getPath() const;
+  float getCost() const;
+  unsigned int getExpanded() const;
+  unsigned int getLevel() const;
+
+private:
+  bool searchLevel(unsigned int level, unsigned int start, unsigned int target);
+  bool searchCorridor(unsigned int start, unsigned int target);
+  void straighten();
+
+  const GridGraph &mGrid;
+  const MapPyramid &mPyramid;
+  PyramidLevelGraph mLevelGraph;
+  AStarSearch<PyramidLevelGraph, OctileHeuristic, float> mCoarse;
+  CorridorGrid mCorridorGrid;
+  AStarSearch<CorridorGrid, OctileHeuristic, float> mFine;
+  ThetaStar mSight; //line of sight on the grid
+  std::vector<unsigned char> v_mCorridor;
+  std::vector<unsigned int> v_mVertices; //the last path on a level, from the target back to the start
+  std::vector<Point> v_mPath; //waypoints of the last path, from start to target
+  float mCost;
+  unsigned int mExpanded;
+  unsigned int mLevel;
+};
+
+#endif /* COARSE_TO_FINE_H_ */
@@ -0,0 +1,375 @@
+/*
+ * d_star_lite.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "d_star_lite.h"
+#include "search_core.h"
+#include <limits>
+
+//the 8 neighbours of a cell, clockwise from north. the odd directions are diagonal
+static const int DIRECTION_X[8] = {0, 1, 1, 1, 0, -1, -1, -1};
+static const int DIRECTION_Y[8] = {-1, -1, 0, 1, 1, 1, 0, -1};
+
+static const float INFINITE_COST = std::numeric_limits<float>::infinity();
+//vertices on a shortest path have the same key as the start, rounded either way. they are expanded up to this margin
+static const float KEY_TOLERANCE = 0.001f;
+
+DStarLite::DStarLite(const GridGraph &grid)
+{
+  this->mWidth = grid.getWidth();
+  this->mHeight = grid.getHeight();
+  v_mBlocked.resize(grid.size());
+  for (unsigned int v = 0; v < grid.size(); v++)
+  {
+    v_mBlocked[v] = grid.isBlocked(v);
+  }
+  this->mGoal = NO_VERTEX;
+  this->mStart = NO_VERTEX;
+  this->mKeyModifier = 0;
+  this->mFresh = true;
+  this->mExpanded = 0;
+  this->mCost = 0;
+}
+
+DStarLite::~DStarLite()
+{
+}
+
+bool DStarLite::hasGoal() const
+{
+  return mGoal != NO_VERTEX;
+}
+
+unsigned int DStarLite::getGoalX() const
+{
+  return mGoal % mWidth;
+}
+
+unsigned int DStarLite::getGoalY() const
+{
+  return mGoal / mWidth;
+}
+
+bool DStarLite::isBlocked(unsigned int x, unsigned int y) const
+{
+  return v_mBlocked[y * mWidth + x] != 0;
+}
+
+const std::vector<Point>& DStarLite::getPath() const
+{
+  return v_mPath;
+}
+
+float DStarLite::getCost() const
+{
+  return mCost;
+}
+
+//number of vertices expanded by the last replan
+unsigned int DStarLite::getExpanded() const
+{
+  return mExpanded;
+}
+
+//octile distance, the cost of the shortest 8-connected path without objects
+float DStarLite::heuristic(unsigned int a, unsigned int b) const
+{
+  float dx = fabsf(float(a % mWidth) - float(b % mWidth));
+  float dy = fabsf(float(a / mWidth) - float(b / mWidth));
+  return dx > dy ? dx + (SQRT2 - 1) * dy : dy + (SQRT2 - 1) * dx;
+}
+
+DStarLite::Key DStarLite::calculateKey(unsigned int v) const
+{
+  Key key;
+  key.mSecond = std::min(v_mG[v], v_mRhs[v]);
+  key.mFirst = key.mSecond + heuristic(mStart, v) + mKeyModifier;
+  return key;
+}
+
+bool DStarLite::hasNeighbour(unsigned int v, unsigned int direction) const
+{
+  int x = int(v % mWidth) + DIRECTION_X[direction];
+  int y = int(v / mWidth) + DIRECTION_Y[direction];
+  return x >= 0 && y >= 0 && x < int(mWidth) && y < int(mHeight);
+}
+
+unsigned int DStarLite::neighbour(unsigned int v, unsigned int direction) const
+{
+  return v + DIRECTION_Y[direction] * int(mWidth) + DIRECTION_X[direction];
+}
+
+//cost of the step from a cell to its neighbour, as GridGraph: no steps into objects or diagonally past their corners
+float DStarLite::edgeCost(unsigned int from, unsigned int direction) const
+{
+  if (!hasNeighbour(from, direction) || v_mBlocked[from] || v_mBlocked[neighbour(from, direction)])
+  {
+    return INFINITE_COST;
+  }
+  if (direction % 2 == 0)
+  {
+    return 1;
+  }
+  if (v_mBlocked[neighbour(from, direction - 1)] || v_mBlocked[neighbour(from, (direction + 1) % 8)])
+  {
+    return INFINITE_COST;
+  }
+  return SQRT2;
+}
+
+//start a new search to this goal at the next replan
+void DStarLite::setGoal(unsigned int x, unsigned int y)
+{
+  mGoal = y * mWidth + x;
+  mFresh = true;
+}
+
+/*
+ * move the start. the heap keys were computed with the distances to the old start, instead of updating them all
+ * the key modifier grows by the distance moved, so new keys stay comparable with the old ones
+ */
+void DStarLite::setStart(unsigned int x, unsigned int y)
+{
+  unsigned int start = y * mWidth + x;
+  if (!mFresh && mStart != NO_VERTEX)
+  {
+    mKeyModifier += heuristic(mStart, start);
+  }
+  mStart = start;
+}
+
+//block or free a cell. the costs of the cell and its neighbours are repaired at the next replan
+void DStarLite::setBlocked(unsigned int x, unsigned int y, bool blocked)
+{
+  unsigned int v = y * mWidth + x;
+  if ((v_mBlocked[v] != 0) == blocked)
+  {
+    return;
+  }
+  v_mBlocked[v] = blocked;
+  if (mFresh)
+  {
+    return;
+  }
+  //the diagonal steps between the neighbours that pass the corner of the cell change as well
+  updateVertex(v);
+  for (unsigned int d = 0; d < 8; d++)
+  {
+    if (hasNeighbour(v, d))
+    {
+      updateVertex(neighbour(v, d));
+    }
+  }
+}
+
+/*
+ * block the disc of radius inflation around an object cell until a time, as GridGraph inflates the objects of the
+ * map. an object seen again blocks its cells longer
+ */
+void DStarLite::addObstacle(unsigned int x, unsigned int y, unsigned int inflation, double until)
+{
+  int radius = inflation;
+  for (int dy = -radius; dy <= radius; dy++)
+  {
+    for (int dx = -radius; dx <= radius; dx++)
+    {
+      int cx = int(x) + dx;
+      int cy = int(y) + dy;
+      if (dx * dx + dy * dy > radius * radius || cx < 0 || cy < 0 || cx >= int(mWidth) || cy >= int(mHeight))
+      {
+        continue;
+      }
+      unsigned int v = cy * mWidth + cx;
+      std::map<unsigned int, double>::iterator it = mObstacles.find(v);
+      if (it != mObstacles.end())
+      {
+        it->second = std::max(it->second, until);
+      }
+      else if (!v_mBlocked[v])
+      {
+        mObstacles[v] = until;
+        setBlocked(cx, cy, true);
+      }
+    }
+  }
+}
+
+//free the cells of the objects that have expired at this time
+void DStarLite::removeExpiredObstacles(double now)
+{
+  std::map<unsigned int, double>::iterator it = mObstacles.begin();
+  while (it != mObstacles.end())
+  {
+    if (it->second > now)
+    {
+      it++;
+      continue;
+    }
+    setBlocked(it->first % mWidth, it->first / mWidth, false);
+    mObstacles.erase(it++);
+  }
+}
+
+void DStarLite::reset()
+{
+  v_mG.assign(mWidth * mHeight, INFINITE_COST);
+  v_mRhs.assign(mWidth * mHeight, INFINITE_COST);
+  v_mPushes.assign(mWidth * mHeight, 0);
+  v_mHeap.clear();
+  mKeyModifier = 0;
+  v_mRhs[mGoal] = 0;
+  push(mGoal);
+  mFresh = false;
+}
+
+void DStarLite::push(unsigned int v)
+{
+  HeapEntry entry;
+  entry.mKey = calculateKey(v);
+  entry.mVertex = v;
+  entry.mPush = ++v_mPushes[v];
+  v_mHeap.push_back(entry);
+  std::push_heap(v_mHeap.begin(), v_mHeap.end(), HeapCompare());
+}
+
+//recompute the cost through the best neighbour, an inconsistent vertex goes (back) on the open list
+void DStarLite::updateVertex(unsigned int v)
+{
+  if (v != mGoal)
+  {
+    float rhs = INFINITE_COST;
+    for (unsigned int d = 0; d < 8; d++)
+    {
+      float cost = edgeCost(v, d);
+      if (cost != INFINITE_COST)
+      {
+        rhs = std::min(rhs, cost + v_mG[neighbour(v, d)]);
+      }
+    }
+    v_mRhs[v] = rhs;
+  }
+  if (v_mG[v] != v_mRhs[v])
+  {
+    push(v);
+  }
+}
+
+/*
+ * expand the inconsistent vertices in key order until the start is consistent and no vertex with a lower key
+ * (within KEY_TOLERANCE) is left. entries of vertices that became consistent, or that were pushed again since, are skipped.
+ * outdated entries are recognised by their push count rather than by their key, keys computed after the start
+ * moved can differ in the last bit
+ */
+bool DStarLite::computeShortestPath()
+{
+  while (!v_mHeap.empty())
+  {
+    HeapEntry top = v_mHeap.front();
+    unsigned int v = top.mVertex;
+    if (v_mG[v] == v_mRhs[v] || top.mPush != v_mPushes[v])
+    {
+      std::pop_heap(v_mHeap.begin(), v_mHeap.end(), HeapCompare());
+      v_mHeap.pop_back();
+      continue;
+    }
+    if (top.mKey.mFirst > calculateKey(mStart).mFirst + KEY_TOLERANCE && v_mG[mStart] == v_mRhs[mStart])
+    {
+      break;
+    }
+    std::pop_heap(v_mHeap.begin(), v_mHeap.end(), HeapCompare());
+    v_mHeap.pop_back();
+    if (top.mKey < calculateKey(v))
+    {
+      push(v); //the key grew since the vertex was pushed, the start has moved
+      continue;
+    }
+
+    mExpanded++;
+    if (v_mG[v] > v_mRhs[v])
+    {
+      v_mG[v] = v_mRhs[v];
+    }
+    else
+    {
+      v_mG[v] = INFINITE_COST;
+      updateVertex(v);
+    }
+    for (unsigned int d = 0; d < 8; d++)
+    {
+      if (hasNeighbour(v, d))
+      {
+        updateVertex(neighbour(v, d));
+      }
+    }
+  }
+  return v_mRhs[mStart] != INFINITE_COST;
+}
+
+/*
+ * repair the search after the changes of the start and the cells since the last replan, and follow the costs
+ * from the start down to the goal. false when the goal can not be reached
+ */
+bool DStarLite::replan()
+{
+  mExpanded = 0;
+  v_mPath.clear();
+  if (mGoal == NO_VERTEX || mStart == NO_VERTEX)
+  {
+    return false;
+  }
+  if (mFresh)
+  {
+    reset();
+  }
+  if (!computeShortestPath())
+  {
+    return false;
+  }
+  mCost = v_mRhs[mStart];
+  return extractPath();
+}
+
+//walk from the start to the goal along the cheapest neighbours, keeping the cells where the direction changes
+bool DStarLite::extractPath()
+{
+  unsigned int v = mStart;
+  int direction = -1;
+  v_mPath.push_back(Point(v % mWidth, v / mWidth));
+  for (unsigned int steps = 0; v != mGoal; steps++)
+  {
+    if (steps == v_mG.size())
+    {
+      v_mPath.clear();
+      return false;
+    }
+    int best = -1;
+    float bestCost = INFINITE_COST;
+    for (unsigned int d = 0; d < 8; d++)
+    {
+      float cost = edgeCost(v, d);
+      if (cost != INFINITE_COST && cost + v_mG[neighbour(v, d)] < bestCost)
+      {
+        best = d;
+        bestCost = cost + v_mG[neighbour(v, d)];
+      }
+    }
+    if (best < 0)
+    {
+      v_mPath.clear();
+      return false;
+    }
+    if (direction >= 0 && best != direction)
+    {
+      v_mPath.push_back(Point(v % mWidth, v / mWidth));
+    }
+    direction = best;
+    v = neighbour(v, best);
+  }
+  if (mStart != mGoal)
+  {
+    v_mPath.push_back(Point(v % mWidth, v / mWidth));
+  }
+  return true;
+}
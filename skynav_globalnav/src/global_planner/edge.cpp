@@ -8,15 +8,20 @@
 #include "graph.h"
 
 Edge::Edge(Node* p_A, Node* p_B, float fLength) {
-	this->p_mA = p_A;
-	this->p_mB = p_B;
+	this->mA = p_A->getId();
+	this->mB = p_B->getId();
 	this->mLenght = fLength;
+	this->mCostFactor = 1;
+	this->mBlockedUntil = 0;
 }
 
 Edge::Edge(Node* p_A, Node* p_B) {
-	this->p_mA = p_A;
-	this->p_mB = p_B;
-	this->mLenght = -1; //edge length can never be negative, CHECK if lenght has not been assigned
+	this->mA = p_A->getId();
+	this->mB = p_B->getId();
+	// Euclidian Distance, computed once when the edge is created
+	this->mLenght = p_A->estimateDist(p_B->getXpos(), p_B->getYpos());
+	this->mCostFactor = 1;
+	this->mBlockedUntil = 0;
 }
 
 Edge::~Edge() {
@@ -24,35 +29,55 @@ Edge::~Edge() {
 }
 
 float Edge::getLength() {
-	if (!mLenght == -1) {
-		return mLenght;
-	} else {
-		return calcLenght();
-	}
+	return mLenght;
+}
+
+//the cost of the edge in a search, its length weighted with the experience of earlier traversals
+float Edge::getCost() {
+	return mLenght * mCostFactor;
+}
+
+float Edge::getCostFactor() {
+	return mCostFactor;
+}
+
+void Edge::setCostFactor(float factor) {
+	this->mCostFactor = std::min(std::max(factor, 1.0f), EDGE_COST_MAX);
 }
 
-float Edge::calcLenght() {
-	int xd, yd;
-	float d;
-	xd = p_mB->getXpos() - p_mA->getXpos();
-	yd = p_mB->getYpos() - p_mA->getYpos();
-	// Euclidian Distance
-	d = (sqrt((xd * xd) + (yd * yd))); // Manhattan distance: d=abs(xd)+abs(yd) // Chebyshev distance: d=max(abs(xd), abs(yd));
-	return d;
+/*
+ * move the cost factor towards the outcome of a traversal: slowdown is the time it took over the expected time,
+ * every avoided object adds a penalty, an edge that could not be traversed counts as EDGE_COST_MAX.
+ * the factor never drops below 1, so the euclidean heuristic of the search stays admissible
+ */
+void Edge::learnCost(float slowdown, unsigned int avoidances, bool reached) {
+	float observed = EDGE_COST_MAX;
+	if (reached) {
+		observed = std::max(slowdown, 1.0f) + EDGE_AVOIDANCE_PENALTY * avoidances;
+	}
+	setCostFactor(mCostFactor + EDGE_LEARNING_RATE * (observed - mCostFactor));
 }
+
 bool Edge::compare(Edge* p_edge) {
-	if (p_mA == p_edge->p_mA || p_mA == p_edge->p_mB) {
-		if (p_mB == p_edge->p_mA || p_mB == p_edge->p_mB) {
+	if (mA == p_edge->mA || mA == p_edge->mB) {
+		if (mB == p_edge->mA || mB == p_edge->mB) {
 			return true;
 		}
 	}
 	return false;
 }
 
-Node* Edge::getA() {
-	return p_mA;
+unsigned int Edge::getA() {
+	return mA;
 }
-Node* Edge::getB() {
-	return p_mB;
+unsigned int Edge::getB() {
+	return mB;
 }
 
+double Edge::getBlockedUntil() {
+	return mBlockedUntil;
+}
+
+void Edge::setBlockedUntil(double time) {
+	this->mBlockedUntil = time;
+}
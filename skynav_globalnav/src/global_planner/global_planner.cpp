@@ -14,10 +14,22 @@
 #include <vector>
 #include <string>
 
+#include <boost/thread/shared_mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/bind.hpp>
+
 #include <nav_msgs/Path.h>
+#include <nav_msgs/OccupancyGrid.h>
 #include <geometry_msgs/PoseStamped.h>
 
 #include "graph.h"
+#include "navigation_function.h"
+#include "route_table.h"
+#include "theta_star.h"
+#include "coarse_to_fine.h"
+#include "d_star_lite.h"
+#include "map_store.h"
+#include "reservation_table.h"
 
 //custom msgs
 #include <skynav_msgs/environment_info.h>
@@ -25,7 +37,19 @@
 #include <skynav_msgs/user_init.h>
 #include <skynav_msgs/path_query_srv.h>
 #include <skynav_msgs/edit_fixedWPs_srv.h>
+#include <skynav_msgs/route_order_srv.h>
+#include <skynav_msgs/replan_srv.h>
+#include <skynav_msgs/map_load_srv.h>
+#include <skynav_msgs/map_link_srv.h>
+#include <skynav_msgs/map_changes_srv.h>
+#include <skynav_msgs/map_level_srv.h>
+#include <skynav_msgs/MapPatch.h>
+#include <skynav_msgs/mapreader_srv.h>
+#include <skynav_msgs/PointCloudVector.h>
+#include <skynav_msgs/EdgeTraversal.h>
+#include <sensor_msgs/point_cloud_conversion.h>
 #include <std_msgs/UInt8.h>
+#include <skynav_slam/shared_map.h>
 
 namespace planner_state
 {
@@ -36,6 +60,21 @@ enum state_
 }
 
 const int NO_LOOP = 0;
+const int QUERY_THREADS = 0; //number of threads serving queries concurrently, 0 uses one thread per core
+const roadmapType ROADMAP_TYPE = roadmapTypes::Random_roadmap; //random samples, the Voronoi diagram or the visibility graph of the map
+const unsigned int GRID_INFLATION = 1; //cells around objects avoided by the grid planners (navigation functions, theta*)
+const unsigned int INIT_THREADS = 0; //threads parsing the map and building the map grid, 0 uses one thread per core
+const unsigned int PYRAMID_LEVELS = 5; //resolutions of the map pyramid, the coarsest has cells of 2^4 by 2^4 map cells
+const float MAP_SCALE = 100; //map cells per meter
+const float TEMPORARY_LIFETIME = 10; //seconds a detected object blocks roadmap edges, unless it is seen again
+const float ROUTE_REBUILD_INTERVAL = 30; //seconds between searches of the route table and saves of the roadmap
+                                         //for learned edge costs
+const std::string ROADMAP_FILE = "roadmap.txt"; //the roadmap with its learned edge costs when environment names no file for the map
+const std::string ENVIRONMENT_MAP = ""; //the name of the environment map in the map store
+const float ROBOT_SPEED = 0.2f; //meters per second the robots drive at, as motion_control
+const float RESERVATION_TICK = 0.5f; //seconds per tick of the multi-robot reservation table
+const float RESERVATION_HOLD = 30; //seconds a robot keeps its target reserved after reaching it
+typedef char shared_map_tiles_match_mapdata[SHARED_MAP_TILE_SIZE == TILE_SIZE ? 1 : -1];
 
 /*
  * Global planner main class
@@ -46,6 +85,8 @@ private:
   std::string node_name_;
   ros::NodeHandle* node_;
   ros::NodeHandle* node_control_;
+  ros::NodeHandle* node_localnav_;
+  ros::NodeHandle* node_slam_;
   int loop_rate_;
 
   //TODO navigation_state;
@@ -54,22 +95,60 @@ private:
   ros::Subscriber navigation_state_sub_;
   ros::Subscriber environment_sub_;
   ros::Subscriber user_init_sub_;
+  ros::Subscriber obstacles_sub_;
+  ros::Subscriber traversal_sub_;
+  ros::Subscriber map_updates_sub_;
 
   ros::Publisher waypoints_pub_;
+  ros::Timer routes_timer_;
 
   ros::ServiceClient getEnvironmentInfo_;
+  ros::ServiceClient getMapRead_;
+  ros::ServiceClient getMapChanges_;
   ros::ServiceServer pathQuery_srv_;
   ros::ServiceServer fixedWaypoints_srv_;
+  ros::ServiceServer routeOrder_srv_;
+  ros::ServiceServer replan_srv_;
+  ros::ServiceServer mapLoad_srv_;
+  ros::ServiceServer mapLink_srv_;
+  ros::ServiceServer mapLevel_srv_;
 
 //Graph* p_mGlobalGraph;
   Graph* p_mFullGraph;
   MapData* p_mMapData;
 
   bool initDone_;
+  boost::shared_mutex planner_mutex_; //queries share the graph and mapdata, (re)init replaces them exclusively
+  NavigationFunctionCache navigation_functions_; //cost-to-go grids of the fixed waypoints, built in the background
+  RouteTable route_table_; //routes between all fixed waypoints, changed only with planner_mutex_ held exclusively
+  bool routes_stale_; //edge costs were learned since the route table was searched, guarded as route_table_
+  bool roadmap_dirty_; //edge costs were learned since the roadmap was saved, guarded by planner_mutex_
+  boost::shared_ptr<const GridGraph> p_mGrid; //the map grid for the grid planners, shared with the navigation functions
+  std::vector<ThetaStar*> theta_star_pool_; //idle any-angle search workspaces on p_mGrid
+  std::vector<CoarseToFineSearch*> coarse_to_fine_pool_; //idle coarse-to-fine search workspaces on p_mGrid
+  boost::mutex theta_star_mutex_; //guards theta_star_pool_ and coarse_to_fine_pool_
+  DStarLite* p_mReplanner; //incremental search to the current goal, keeps its costs between replans
+  boost::mutex replanner_mutex_; //guards p_mReplanner
+  ReservationTable reservations_; //the timed paths of the robots on p_mFullGraph, for queries with a robot id
+  MapStore map_store_; //the maps of the other floors with their roadmaps, and the environment map with p_mFullGraph
+  unsigned int map_version_; //the environment map p_mMapData was parsed from
+  unsigned int map_edit_; //the last edit of the environment map applied to p_mMapData
+  std::string roadmap_file_; //the file the roadmap of the environment map is saved in
 
   void Init();
   bool Query(unsigned int xStart, unsigned int yStart, float thStart, unsigned int xTarget, unsigned int yTarget,
-             float thTarget);
+             float thTarget, unsigned char planner);
+  bool QueryGrid(unsigned int xStart, unsigned int yStart, float thStart, unsigned int xTarget, unsigned int yTarget,
+                 float thTarget, bool lazy);
+  bool QueryCoarseToFine(unsigned int xStart, unsigned int yStart, float thStart, unsigned int xTarget,
+                         unsigned int yTarget, float thTarget);
+  bool QueryRobot(unsigned int robot, unsigned int xStart, unsigned int yStart, float thStart, unsigned int xTarget,
+                  unsigned int yTarget, float thTarget);
+  bool QueryMaps(const std::string &startMap, unsigned int xStart, unsigned int yStart, float thStart,
+                 const std::string &targetMap, unsigned int xTarget, unsigned int yTarget, float thTarget);
+  void clearGrid();
+  void setCells(const std::vector<skynav_msgs::CellRun> &v_runs, std::vector<Point> &v_cells);
+  void applyMapChanges(const std::vector<skynav_msgs::CellRun> &v_runs);
   void Stop();
   void Error();
   void ReInit();
@@ -78,6 +157,12 @@ private:
                          skynav_msgs::path_query_srv::Response &res);
   bool respond_fixedWaypoints(skynav_msgs::edit_fixedWPs_srv::Request &req,
                               skynav_msgs::edit_fixedWPs_srv::Response &res);
+  bool respond_routeOrder(skynav_msgs::route_order_srv::Request &req,
+                          skynav_msgs::route_order_srv::Response &res);
+  bool respond_replan(skynav_msgs::replan_srv::Request &req, skynav_msgs::replan_srv::Response &res);
+  bool respond_mapLoad(skynav_msgs::map_load_srv::Request &req, skynav_msgs::map_load_srv::Response &res);
+  bool respond_mapLink(skynav_msgs::map_link_srv::Request &req, skynav_msgs::map_link_srv::Response &res);
+  bool respond_mapLevel(skynav_msgs::map_level_srv::Request &req, skynav_msgs::map_level_srv::Response &res);
 
 public:
   GlobalPlanner(std::string node_name, int loop_rate);
@@ -85,6 +170,10 @@ public:
   {
     delete node_;
     delete node_control_;
+    delete node_localnav_;
+    delete node_slam_;
+    saveRoadmap();
+    map_store_.removeMap(ENVIRONMENT_MAP);
    
 	if (p_mMapData)
     {
@@ -94,40 +183,72 @@ public:
     {
       delete p_mFullGraph;
     }
-
+    clearGrid();
   }
   ;
   void navigation_stateCallback(const std_msgs::UInt8& msg);
   void user_InitCallback(const skynav_msgs::user_init::ConstPtr& msg);
+  void obstaclesCallback(const skynav_msgs::PointCloudVector::ConstPtr& msg);
+  void traversalCallback(const skynav_msgs::EdgeTraversal::ConstPtr& msg);
+  void mapUpdatesCallback(const skynav_msgs::MapPatch::ConstPtr& msg);
+  void routesTimerCallback(const ros::TimerEvent& event);
+  void saveRoadmap();
 
   bool outputWaypoints(std::vector<Node*> &v_pPath);
+  bool outputWaypoints(const std::vector<Point> &v_path, float thStart, float thTarget);
+  bool outputWaypoints(const std::vector<MapWaypoint> &v_path, float thStart, float thTarget);
+  bool outputWaypoints(const std::vector<TimedWaypoint> &v_path, float thStart, float thTarget);
+  geometry_msgs::PoseStamped createPose(unsigned int x, unsigned int y, float theta);
+  MapData* readMap(const std::string &filePath);
+  static void parseMap(const Shared_Map &map, MapData* p_mapData);
+  static void parseTileRows(const Shared_Map* p_map, MapData* p_mapData, unsigned int first, unsigned int step);
   bool getEnvironmentData();
   void loop();
 };
 
 
 GlobalPlanner::GlobalPlanner(std::string node_name, int loop_rate) :
-    node_name_(node_name), loop_rate_(loop_rate)
+    node_name_(node_name), loop_rate_(loop_rate), navigation_functions_(GRID_INFLATION),
+    reservations_(RESERVATION_TICK, ROBOT_SPEED * MAP_SCALE, RESERVATION_HOLD)
 {
   node_ = new ros::NodeHandle("/globalnav");
   node_control_ = new ros::NodeHandle("/control");
+  node_localnav_ = new ros::NodeHandle("/localnav");
+  node_slam_ = new ros::NodeHandle("/SLAM");
 
 //service servers
   pathQuery_srv_ = node_->advertiseService("path_query", &GlobalPlanner::respond_pathQuery, this);
   fixedWaypoints_srv_ = node_->advertiseService("update_fixed_waypoints", &GlobalPlanner::respond_fixedWaypoints, this);
+  routeOrder_srv_ = node_->advertiseService("route_order", &GlobalPlanner::respond_routeOrder, this);
+  replan_srv_ = node_->advertiseService("replan", &GlobalPlanner::respond_replan, this);
+  mapLoad_srv_ = node_->advertiseService("map_load", &GlobalPlanner::respond_mapLoad, this);
+  mapLink_srv_ = node_->advertiseService("map_link", &GlobalPlanner::respond_mapLink, this);
+  mapLevel_srv_ = node_->advertiseService("map_level", &GlobalPlanner::respond_mapLevel, this);
 //service client
   getEnvironmentInfo_ = node_->serviceClient<skynav_msgs::environment_srv>("environment_req");
+  getMapRead_ = node_slam_->serviceClient<skynav_msgs::mapreader_srv>("map_read_req");
+  getMapChanges_ = node_->serviceClient<skynav_msgs::map_changes_srv>("map_changes");
 //publisher
   waypoints_pub_ = node_->advertise<nav_msgs::Path>("waypoints", 10);
 //subscriber  
   navigation_state_sub_ = node_control_->subscribe("navigation_state", 10, &GlobalPlanner::navigation_stateCallback, this);
   user_init_sub_ = node_->subscribe("user_init", 10, &GlobalPlanner::user_InitCallback, this);
+  obstacles_sub_ = node_localnav_->subscribe("pointcloudVector", 1, &GlobalPlanner::obstaclesCallback, this);
+  traversal_sub_ = node_control_->subscribe("edge_traversal", 10, &GlobalPlanner::traversalCallback, this);
+  map_updates_sub_ = node_->subscribe("map_updates", 10, &GlobalPlanner::mapUpdatesCallback, this);
+//timer
+  routes_timer_ = node_->createTimer(ros::Duration(ROUTE_REBUILD_INTERVAL), &GlobalPlanner::routesTimerCallback, this);
 
   planner_state_ = planner_state::Idle;
   //navigation_state_ = //TODO;
 
   p_mFullGraph = NULL;
   p_mMapData = NULL;
+  p_mReplanner = NULL;
+  map_version_ = 0;
+  map_edit_ = 0;
+  routes_stale_ = false;
+  roadmap_dirty_ = false;
 
   initDone_ = false;
 }
@@ -141,8 +262,26 @@ bool GlobalPlanner::respond_pathQuery(skynav_msgs::path_query_srv::Request &req,
   {
     ROS_INFO("query request");
 
-    if (Query(req.startPose.x, req.startPose.y, req.startPose.theta, req.targetPose.x, req.targetPose.y,
-              req.targetPose.theta))
+    if (!req.startMap.empty() || !req.targetMap.empty())
+    {
+      if (QueryMaps(req.startMap, req.startPose.x, req.startPose.y, req.startPose.theta, req.targetMap,
+                    req.targetPose.x, req.targetPose.y, req.targetPose.theta))
+      {
+        res.response = 1;
+        return true;
+      }
+    }
+    else if (req.robot != 0)
+    {
+      if (QueryRobot(req.robot, req.startPose.x, req.startPose.y, req.startPose.theta, req.targetPose.x,
+                     req.targetPose.y, req.targetPose.theta))
+      {
+        res.response = 1;
+        return true;
+      }
+    }
+    else if (Query(req.startPose.x, req.startPose.y, req.startPose.theta, req.targetPose.x, req.targetPose.y,
+              req.targetPose.theta, req.planner))
     {
       res.response = 1;
       return true;
@@ -161,6 +300,12 @@ bool GlobalPlanner::respond_fixedWaypoints(skynav_msgs::edit_fixedWPs_srv::Reque
   {
     if (req.waypoints.size() > 0)
     {
+      boost::unique_lock<boost::shared_mutex> lock(planner_mutex_);
+      if (!this->p_mMapData)
+      {
+        ROS_ERROR("no environment initialized yet, fixed waypoints ignored");
+        return false;
+      }
 
       std::vector<Node*> tmp_fxWps;
       for (int i = 0; i < req.waypoints.size(); i++)
@@ -175,6 +320,15 @@ bool GlobalPlanner::respond_fixedWaypoints(skynav_msgs::edit_fixedWPs_srv::Reque
       if (p_mFullGraph)
       {
         p_mFullGraph->updateFixedWaypoints();
+        route_table_.update(p_mFullGraph, p_mMapData->getFixedWPs());
+      }
+      if (p_mGrid)
+      {
+        navigation_functions_.rebuild(p_mMapData, p_mGrid);
+      }
+      else
+      {
+        navigation_functions_.rebuild(p_mMapData);
       }
     }
     return true;
@@ -186,6 +340,230 @@ bool GlobalPlanner::respond_fixedWaypoints(skynav_msgs::edit_fixedWPs_srv::Reque
   }
 }
 
+/*
+ * receive a start and a set of goals, respond with the order to visit the goals and the path along them
+ */
+bool GlobalPlanner::respond_routeOrder(skynav_msgs::route_order_srv::Request &req,
+                                       skynav_msgs::route_order_srv::Response &res)
+{
+  if (!req.request || req.goals.empty())
+  {
+    ROS_ERROR("Error with received route order request");
+    return false;
+  }
+  {
+    boost::unique_lock<boost::shared_mutex> lock(planner_mutex_);
+    if (!initDone_)
+    {
+      Init();
+    }
+  }
+  boost::shared_lock<boost::shared_mutex> lock(planner_mutex_);
+  if (!initDone_)
+  {
+    ROS_ERROR("Route order could not be commenced because environment has not been initialized. Are all nodes active?");
+    return false;
+  }
+
+  //stop 0 is the start, stop i the goal i - 1
+  std::vector<Point> stops;
+  stops.push_back(Point(req.startPose.x, req.startPose.y));
+  for (unsigned int i = 0; i < req.goals.size(); i++)
+  {
+    stops.push_back(Point(req.goals[i].x, req.goals[i].y));
+  }
+  std::vector<unsigned int> order;
+  std::vector<Node*> path;
+  float cost;
+  if (!p_mFullGraph->findTour(stops, order, path, cost))
+  {
+    ROS_ERROR("no route along all goals can be found");
+    return false;
+  }
+
+  for (unsigned int i = 1; i < order.size(); i++)
+  {
+    res.order.push_back(order[i] - 1);
+  }
+  res.cost = cost;
+  res.path.header.stamp = ros::Time::now();
+  res.path.header.frame_id = "/map";
+  for (std::vector<Node*>::iterator it = path.begin(); it != path.end(); it++)
+  {
+    float theta = 0;
+    if (it == path.begin())
+    {
+      theta = req.startPose.theta;
+    }
+    res.path.poses.push_back(createPose((*it)->getXpos(), (*it)->getYpos(), theta));
+  }
+  res.response = 1;
+  return true;
+}
+
+/*
+ * receive the objects the robot ran into on its way to the goal, respond with the path around them.
+ * the search to the goal is kept between calls, only the part the objects and the moved robot change is repaired.
+ * poses and objects are in meters
+ */
+bool GlobalPlanner::respond_replan(skynav_msgs::replan_srv::Request &req, skynav_msgs::replan_srv::Response &res)
+{
+  if (!req.request)
+  {
+    ROS_ERROR("Error with received replan request");
+    return false;
+  }
+  {
+    boost::unique_lock<boost::shared_mutex> lock(planner_mutex_);
+    if (!initDone_)
+    {
+      Init();
+    }
+  }
+  boost::shared_lock<boost::shared_mutex> lock(planner_mutex_);
+  if (!initDone_)
+  {
+    ROS_ERROR("Replan could not be commenced because environment has not been initialized. Are all nodes active?");
+    return false;
+  }
+
+  unsigned int xStart = req.currentPose.x * MAP_SCALE + 0.5f;
+  unsigned int yStart = req.currentPose.y * MAP_SCALE + 0.5f;
+  unsigned int xGoal = req.goalPose.x * MAP_SCALE + 0.5f;
+  unsigned int yGoal = req.goalPose.y * MAP_SCALE + 0.5f;
+  if (xStart >= p_mGrid->getWidth() || yStart >= p_mGrid->getHeight() || xGoal >= p_mGrid->getWidth()
+      || yGoal >= p_mGrid->getHeight())
+  {
+    ROS_ERROR("replan start or goal outside the map");
+    return false;
+  }
+
+  boost::mutex::scoped_lock replannerLock(replanner_mutex_);
+  if (!p_mReplanner)
+  {
+    p_mReplanner = new DStarLite(*p_mGrid);
+  }
+  if (!p_mReplanner->hasGoal() || p_mReplanner->getGoalX() != xGoal || p_mReplanner->getGoalY() != yGoal)
+  {
+    p_mReplanner->setGoal(xGoal, yGoal);
+  }
+  //objects block the grid as long as temporary objects block the roadmap, unless they are reported again
+  double now = MapData::getTime();
+  p_mReplanner->removeExpiredObstacles(now);
+  for (unsigned int i = 0; i < req.obstacles.size(); i++)
+  {
+    int x = req.obstacles[i].x * MAP_SCALE + 0.5f;
+    int y = req.obstacles[i].y * MAP_SCALE + 0.5f;
+    if (x >= 0 && y >= 0 && x < int(p_mGrid->getWidth()) && y < int(p_mGrid->getHeight()))
+    {
+      p_mReplanner->addObstacle(x, y, GRID_INFLATION, now + TEMPORARY_LIFETIME);
+    }
+  }
+  p_mReplanner->setStart(xStart, yStart);
+  if (!p_mReplanner->replan())
+  {
+    ROS_ERROR("no path around the objects can be found");
+    return false;
+  }
+  ROS_INFO("replanned, %u cells expanded", p_mReplanner->getExpanded());
+
+  const std::vector<Point> &v_path = p_mReplanner->getPath();
+  res.path.header.stamp = ros::Time::now();
+  res.path.header.frame_id = "/map";
+  for (std::vector<Point>::const_iterator it = v_path.begin(); it != v_path.end(); it++)
+  {
+    float theta = 0;
+    if (it + 1 == v_path.end())
+    {
+      theta = req.goalPose.theta;
+    }
+    res.path.poses.push_back(createPose((*it).mXpos, (*it).mYpos, theta));
+  }
+  res.response = 1;
+  return true;
+}
+
+/*
+ * load another map (another floor) next to the environment map and build its roadmap. once loaded, a query selects
+ * the map by its name without any rebuild
+ */
+bool GlobalPlanner::respond_mapLoad(skynav_msgs::map_load_srv::Request &req, skynav_msgs::map_load_srv::Response &res)
+{
+  if (!req.request || req.name == ENVIRONMENT_MAP)
+  {
+    ROS_ERROR("Error with received map load request");
+    return false;
+  }
+  MapData* p_mapData = readMap(req.file_path);
+  if (!p_mapData)
+  {
+    return false;
+  }
+  //the roadmap is built without planner_mutex_, queries on the other maps go on meanwhile
+  map_store_.addMap(req.name, p_mapData, ROADMAP_TYPE);
+  ROS_INFO("loaded map %s", req.name.c_str());
+  res.response = 1;
+  return true;
+}
+
+/*
+ * join a point on one map to a point on another map, the elevator or the stairs between two floors
+ */
+bool GlobalPlanner::respond_mapLink(skynav_msgs::map_link_srv::Request &req, skynav_msgs::map_link_srv::Response &res)
+{
+  if (!req.request)
+  {
+    ROS_ERROR("Error with received map link request");
+    return false;
+  }
+  if (!map_store_.addLink(req.mapA, req.poseA.x, req.poseA.y, req.mapB, req.poseB.x, req.poseB.y, req.cost))
+  {
+    return false;
+  }
+  res.response = 1;
+  return true;
+}
+
+/*
+ * a level of the map pyramid as an occupancy grid, for a quick overview of the map in the gui or rviz.
+ * level 0 is the map itself
+ */
+bool GlobalPlanner::respond_mapLevel(skynav_msgs::map_level_srv::Request &req,
+                                     skynav_msgs::map_level_srv::Response &res)
+{
+  boost::shared_lock<boost::shared_mutex> lock(planner_mutex_);
+  if (!initDone_ || req.level >= p_mMapData->getPyramid().getLevels())
+  {
+    res.response = 0;
+    return true;
+  }
+  const MapPyramid &pyramid = p_mMapData->getPyramid();
+  res.map.header.stamp = ros::Time::now();
+  res.map.header.frame_id = "/map";
+  res.map.info.resolution = float(1u << req.level) / MAP_SCALE;
+  if (req.level == 0)
+  {
+    res.map.info.width = p_mMapData->getXdimension();
+    res.map.info.height = p_mMapData->getYdimension();
+    res.map.data.resize(res.map.info.width * res.map.info.height);
+    for (unsigned int y = 0; y < res.map.info.height; y++)
+    {
+      for (unsigned int x = 0; x < res.map.info.width; x++)
+      {
+        res.map.data[y * res.map.info.width + x] = p_mMapData->getCell(x, y) == spaceType::Object ? 100 : 0;
+      }
+    }
+  }
+  else
+  {
+    res.map.info.width = pyramid.getWidth(req.level);
+    res.map.info.height = pyramid.getHeight(req.level);
+    pyramid.getLevel(req.level, res.map.data);
+  }
+  res.response = 1;
+  return true;
+}
+
 /*
  * change the navigation_state
  */
@@ -207,18 +585,194 @@ void GlobalPlanner::user_InitCallback(const skynav_msgs::user_init::ConstPtr& ms
   }
 }
 /*
- * output the waypoints that make up the path on the roadmap
+ * mark the object clusters found by obstacle_detector on the map as temporary objects.
+ * the roadmap edges through them are left out of the queries until they expire
  */
-bool GlobalPlanner::outputWaypoints(std::vector<Node*> &v_pPath)
+void GlobalPlanner::obstaclesCallback(const skynav_msgs::PointCloudVector::ConstPtr& msg)
+{
+  boost::shared_lock<boost::shared_mutex> lock(planner_mutex_);
+  if (!initDone_)
+  {
+    return;
+  }
+  std::vector<Point> cells;
+  for (unsigned int i = 0; i < msg->clouds.size(); i++)
+  {
+    sensor_msgs::PointCloud cloud;
+    sensor_msgs::convertPointCloud2ToPointCloud(msg->clouds[i], cloud);
+    for (unsigned int j = 0; j < cloud.points.size(); j++)
+    {
+      int x = cloud.points[j].x * MAP_SCALE + 0.5f;
+      int y = cloud.points[j].y * MAP_SCALE + 0.5f;
+      if (x >= 0 && y >= 0 && p_mMapData->checkCoordinates(x, y))
+      {
+        cells.push_back(Point(x, y));
+      }
+    }
+  }
+  if (!cells.empty())
+  {
+    p_mMapData->addTemporaryObstacles(cells, GRID_INFLATION, TEMPORARY_LIFETIME);
+  }
+}
+
+/*
+ * learn the cost of the roadmap edge the robot has driven along (or failed to).
+ * edges that are slow or often blocked become more expensive, so later queries prefer other routes
+ */
+void GlobalPlanner::traversalCallback(const skynav_msgs::EdgeTraversal::ConstPtr& msg)
+{
+  {
+    boost::shared_lock<boost::shared_mutex> lock(planner_mutex_);
+    if (!initDone_ || msg->expectedSeconds <= 0)
+    {
+      return;
+    }
+    float slowdown = msg->actualSeconds / msg->expectedSeconds;
+    if (!p_mFullGraph->reportTraversal(msg->from.x * MAP_SCALE + 0.5f, msg->from.y * MAP_SCALE + 0.5f,
+                                       msg->to.x * MAP_SCALE + 0.5f, msg->to.y * MAP_SCALE + 0.5f, slowdown,
+                                       msg->avoidances, msg->reached))
+    {
+      return;
+    }
+  }
+  //the routes between the fixed waypoints take the learned cost at the next search of the route table,
+  //the roadmap file at the next save
+  boost::unique_lock<boost::shared_mutex> lock(planner_mutex_);
+  routes_stale_ = true;
+  roadmap_dirty_ = true;
+}
+
+/*
+ * search the route table again and save the roadmap when edge costs have been learned since.
+ * at most every ROUTE_REBUILD_INTERVAL, as every traversal changes a cost.
+ * the roadmap is written with the planner shared, queries go on meanwhile
+ */
+void GlobalPlanner::routesTimerCallback(const ros::TimerEvent& /*event*/)
+{
+  {
+    boost::unique_lock<boost::shared_mutex> lock(planner_mutex_);
+    if (!initDone_ || (!routes_stale_ && !roadmap_dirty_))
+    {
+      return;
+    }
+    if (routes_stale_)
+    {
+      route_table_.rebuild(p_mFullGraph, p_mMapData->getFixedWPs());
+      routes_stale_ = false;
+    }
+  }
+  boost::shared_lock<boost::shared_mutex> lock(planner_mutex_);
+  saveRoadmap();
+}
+
+/*
+ * save the roadmap with its learned edge costs when they changed since it was saved.
+ * the caller holds planner_mutex_
+ */
+void GlobalPlanner::saveRoadmap()
+{
+  if (p_mFullGraph && roadmap_dirty_ && p_mFullGraph->exportGraph(roadmap_file_))
+  {
+    roadmap_dirty_ = false;
+  }
+}
+
+/*
+ * apply an edit of the environment map, and repair the roadmap and the grids on it instead of building them again.
+ * a patch that does not follow the last edit applied means patches were missed, the changes since are fetched
+ */
+void GlobalPlanner::mapUpdatesCallback(const skynav_msgs::MapPatch::ConstPtr& msg)
+{
+  boost::unique_lock<boost::shared_mutex> lock(planner_mutex_);
+  if (!initDone_ || msg->map_version != map_version_ || msg->to_edit <= map_edit_)
+  {
+    return; //another map, its re-init follows, or applied already
+  }
+  if (msg->from_edit == map_edit_)
+  {
+    applyMapChanges(msg->runs);
+    map_edit_ = msg->to_edit;
+    return;
+  }
+  skynav_msgs::map_changes_srv srv;
+  srv.request.map_version = map_version_;
+  srv.request.since_edit = map_edit_;
+  if (!getMapChanges_.call(srv) || srv.response.full)
+  {
+    ROS_ERROR("changes since map edit %u not available", map_edit_);
+    return;
+  }
+  applyMapChanges(srv.response.runs);
+  map_edit_ = srv.response.edit;
+}
+
+/*
+ * set the cells of runs on the map, v_cells receives the cells that became an object or stopped being one
+ */
+void GlobalPlanner::setCells(const std::vector<skynav_msgs::CellRun> &v_runs, std::vector<Point> &v_cells)
+{
+  for (std::vector<skynav_msgs::CellRun>::const_iterator it = v_runs.begin(); it != v_runs.end(); it++)
+  {
+    for (unsigned int x = (*it).x; x < (*it).x + (*it).length; x++)
+    {
+      if (p_mMapData->setCell(x, (*it).y, (*it).value))
+      {
+        v_cells.push_back(Point(x, (*it).y));
+      }
+    }
+  }
+}
+
+/*
+ * change cells of the environment map after init: the roadmap edges through the changed cells are checked again,
+ * the routes, the map grid and the navigation functions are rebuilt on the changed map.
+ * the caller holds planner_mutex_ exclusively
+ */
+void GlobalPlanner::applyMapChanges(const std::vector<skynav_msgs::CellRun> &v_runs)
+{
+  std::vector<Point> v_cells;
+  setCells(v_runs, v_cells);
+  if (v_cells.empty())
+  {
+    return;
+  }
+  unsigned int repaired = p_mFullGraph->applyMapChanges(v_cells);
+  route_table_.rebuild(p_mFullGraph, p_mMapData->getFixedWPs()); //routes can run through the changed cells
+  routes_stale_ = false;
+  clearGrid();
+  p_mGrid.reset(new GridGraph(p_mMapData, GRID_INFLATION, INIT_THREADS));
+  navigation_functions_.rebuild(p_mMapData, p_mGrid);
+  ROS_INFO("map changed in %lu cells, %u roadmap edges repaired", (unsigned long)v_cells.size(), repaired);
+}
+
+/*
+ * create the pose of a waypoint on the map
+ */
+geometry_msgs::PoseStamped GlobalPlanner::createPose(unsigned int x, unsigned int y, float theta)
 {
   /*
    * todo conversion function from units to real world coordinates based on scale.
-   * '/scale' in functions need to be replaced with actual scaling factor
+   * MAP_SCALE needs to be replaced with the actual scaling factor of the map
    * output is in meters.
    */
 
-  float scale = 100;
+  geometry_msgs::PoseStamped ps;
+
+  ps.pose.position.x = (float(x) / MAP_SCALE);
+  ps.pose.position.y = (float(y) / MAP_SCALE);
+  ps.pose.orientation.z = theta; //orientation of the robot
 
+  ps.header.stamp = ros::Time::now();
+  ps.header.frame_id = "/map";
+  return ps;
+}
+
+/*
+ * output the waypoints that make up the path on the roadmap
+ */
+bool GlobalPlanner::outputWaypoints(std::vector<Node*> &v_pPath)
+{
   nav_msgs::Path msg;
   msg.header.stamp = ros::Time::now();
   msg.header.frame_id = "/map";
@@ -229,22 +783,131 @@ bool GlobalPlanner::outputWaypoints(std::vector<Node*> &v_pPath)
    */
   for (std::vector<Node*>::reverse_iterator rit = v_pPath.rbegin(); rit != v_pPath.rend(); ++rit)
   {
-    geometry_msgs::PoseStamped ps;
+    msg.poses.push_back(createPose((*rit)->getXpos(), (*rit)->getYpos(), (*rit)->getTheta()));
+  }
+  waypoints_pub_.publish(msg);
+  return true;
+}
 
-    ps.pose.position.x = (float((*rit)->getXpos()) / scale);
-    ps.pose.position.y = (float((*rit)->getYpos()) / scale);
-    ps.pose.orientation.z = float((*rit)->getTheta()); //orientation of the robot
+/*
+ * output the waypoints of a path from a navigation function, the path runs from start to target.
+ * only start and target have an orientation
+ */
+bool GlobalPlanner::outputWaypoints(const std::vector<Point> &v_path, float thStart, float thTarget)
+{
+  nav_msgs::Path msg;
+  msg.header.stamp = ros::Time::now();
+  msg.header.frame_id = "/map";
+
+  for (std::vector<Point>::const_iterator it = v_path.begin(); it != v_path.end(); it++)
+  {
+    float theta = 0;
+    if (it == v_path.begin())
+    {
+      theta = thStart;
+    }
+    else if (it + 1 == v_path.end())
+    {
+      theta = thTarget;
+    }
+    msg.poses.push_back(createPose((*it).mXpos, (*it).mYpos, theta));
+  }
+  waypoints_pub_.publish(msg);
+  return true;
+}
 
-    ps.header.stamp = ros::Time::now();
-    ps.header.frame_id = "/map";
+/*
+ * output the waypoints of a path over several maps, each pose in the frame of its map.
+ * only start and target have an orientation
+ */
+bool GlobalPlanner::outputWaypoints(const std::vector<MapWaypoint> &v_path, float thStart, float thTarget)
+{
+  nav_msgs::Path msg;
+  msg.header.stamp = ros::Time::now();
+  msg.header.frame_id = "/map";
 
+  for (std::vector<MapWaypoint>::const_iterator it = v_path.begin(); it != v_path.end(); it++)
+  {
+    float theta = 0;
+    if (it == v_path.begin())
+    {
+      theta = thStart;
+    }
+    else if (it + 1 == v_path.end())
+    {
+      theta = thTarget;
+    }
+    geometry_msgs::PoseStamped ps = createPose((*it).mXpos, (*it).mYpos, theta);
+    if ((*it).mMap != ENVIRONMENT_MAP)
+    {
+      ps.header.frame_id = "/" + (*it).mMap + "/map";
+    }
     msg.poses.push_back(ps);
+  }
+  waypoints_pub_.publish(msg);
+  return true;
+}
 
+/*
+ * output the waypoints of a timed path, each pose stamped with the time the robot is planned to be there.
+ * a waypoint repeated with a later stamp is a wait, motion_control holds the robot there until the stamp
+ */
+bool GlobalPlanner::outputWaypoints(const std::vector<TimedWaypoint> &v_path, float thStart, float thTarget)
+{
+  nav_msgs::Path msg;
+  msg.header.stamp = ros::Time::now();
+  msg.header.frame_id = "/map";
+
+  for (std::vector<TimedWaypoint>::const_iterator it = v_path.begin(); it != v_path.end(); it++)
+  {
+    float theta = 0;
+    if (it == v_path.begin())
+    {
+      theta = thStart;
+    }
+    else if (it + 1 == v_path.end())
+    {
+      theta = thTarget;
+    }
+    geometry_msgs::PoseStamped ps = createPose((*it).p_mNode->getXpos(), (*it).p_mNode->getYpos(), theta);
+    ps.header.stamp = ros::Time((*it).mTime);
+    msg.poses.push_back(ps);
   }
   waypoints_pub_.publish(msg);
   return true;
 }
 
+//parse the tile rows first, first + step, ... of a shared map
+void GlobalPlanner::parseTileRows(const Shared_Map* p_map, MapData* p_mapData, unsigned int first, unsigned int step)
+{
+  for (unsigned int ty = first; ty < p_map->getTilesY(); ty += step)
+  {
+    for (unsigned int tx = 0; tx < p_map->getTilesX(); tx++)
+    {
+      p_mapData->parseOccupancyTile(tx, ty, p_map->getTile(tx, ty), p_map->getUniform(tx, ty));
+    }
+  }
+}
+
+/*
+ * parse the cells of a shared map tile by tile, the tiles of the shared map and of mapdata are the same size.
+ * the rows of tiles are spread over INIT_THREADS threads, every tile is parsed by one thread
+ */
+void GlobalPlanner::parseMap(const Shared_Map &map, MapData* p_mapData)
+{
+  unsigned int threads = INIT_THREADS ? INIT_THREADS : std::max(1u, boost::thread::hardware_concurrency());
+  threads = std::min(threads, map.getTilesY());
+  boost::thread_group parsers;
+  for (unsigned int i = 1; i < threads; i++)
+  {
+    parsers.create_thread(boost::bind(&GlobalPlanner::parseTileRows, &map, p_mapData, i, threads));
+  }
+  parseTileRows(&map, p_mapData, 0, std::max(threads, 1u));
+  parsers.join_all();
+  ROS_INFO("map parsed, %u of %u tiles hold cells", p_mapData->getMapData().getAllocatedTiles(),
+           p_mapData->getMapData().getTilesX() * p_mapData->getMapData().getTilesY());
+}
+
 //service call to get environment info from environment ROSnode
 bool GlobalPlanner::getEnvironmentData()
 {
@@ -260,17 +923,38 @@ bool GlobalPlanner::getEnvironmentData()
       delete p_mMapData;
       //if mapdata already exists, remove old one, create new
     }
-    p_mMapData = new MapData(srv.response.environment.map.info.width, srv.response.environment.map.info.height,
-                             srv.response.environment.map.info.resolution);
+    //the cells are parsed straight from the shared memory segment of map_reader
+    Shared_Map map;
+    if (!map.open(srv.response.environment.map_segment, srv.response.environment.map_version))
+    {
+      ROS_ERROR("map segment %s can not be opened", srv.response.environment.map_segment.c_str());
+      p_mMapData = NULL;
+      return false;
+    }
+    p_mMapData = new MapData(map.getWidth(), map.getHeight(), map.getResolution());
+    parseMap(map, p_mMapData);
+    map_version_ = srv.response.environment.map_version;
+    map_edit_ = 0;
+    roadmap_file_ = srv.response.environment.roadmap_file;
+    if (roadmap_file_.empty())
+    {
+      roadmap_file_ = ros::package::getPath("skynav_globalnav") + "/" + ROADMAP_FILE;
+    }
 
-    std::vector<int> tmp_data;
-    tmp_data.resize(srv.response.environment.map.info.width * srv.response.environment.map.info.height);
-    for (int i = 0; i < srv.response.environment.map.data.size(); i++)
+    //the map has been edited since it was loaded, the edits are applied before the roadmap is built on it
+    if (srv.response.environment.map_edits > 0)
     {
-      tmp_data[i] = srv.response.environment.map.data[i];
+      skynav_msgs::map_changes_srv changes;
+      changes.request.map_version = map_version_;
+      changes.request.since_edit = map_edit_;
+      if (getMapChanges_.call(changes) && !changes.response.full)
+      {
+        std::vector<Point> v_cells;
+        setCells(changes.response.runs, v_cells);
+        map_edit_ = changes.response.edit;
+      }
     }
-    p_mMapData->parseOccupancyList(tmp_data);
-    tmp_data.clear();
+    p_mMapData->buildPyramid(PYRAMID_LEVELS);
 
     /*
      * add fixed waypoints to mapdata
@@ -289,15 +973,51 @@ bool GlobalPlanner::getEnvironmentData()
   return false;
 }
 
+//parse a map file with the mapreader into new mapdata, without fixed waypoints. NULL if the map can not be read
+MapData* GlobalPlanner::readMap(const std::string &filePath)
+{
+  skynav_msgs::mapreader_srv srv;
+  srv.request.request = 1;
+  srv.request.file_path = filePath;
+  if (filePath.empty() || !getMapRead_.call(srv))
+  {
+    ROS_ERROR("no viable response from SLAM/mapreader for %s", filePath.c_str());
+    return NULL;
+  }
+  Shared_Map map;
+  if (!map.open(srv.response.segment, srv.response.version))
+  {
+    ROS_ERROR("map segment %s can not be opened", srv.response.segment.c_str());
+    return NULL;
+  }
+  MapData* p_mapData = new MapData(map.getWidth(), map.getHeight(), map.getResolution());
+  parseMap(map, p_mapData);
+  return p_mapData;
+}
+
 //re-init the map and graph
 void GlobalPlanner::ReInit()
 {
+  boost::unique_lock<boost::shared_mutex> lock(planner_mutex_);
   this->initDone_ = false;
+  navigation_functions_.invalidate();
+  route_table_.clear();
+  reservations_.clear();
+  clearGrid();
+  saveRoadmap(); //the costs learned on the old map
+  roadmap_dirty_ = false;
+  map_store_.removeMap(ENVIRONMENT_MAP);
+  if (p_mFullGraph)
+  {
+    delete p_mFullGraph; //the graph refers to the mapdata, which is replaced by Init()
+    p_mFullGraph = NULL;
+  }
   Init();
 }
 
 /*
  * retrieve map-data from environment and create a graph based on this data.
+ * the caller holds planner_mutex_ exclusively
  */
 void GlobalPlanner::Init()
 {
@@ -312,8 +1032,15 @@ void GlobalPlanner::Init()
        * p_mGlobalGraph = new Graph
        */
 
-      //create local level graph, based on the known mapdata and a randomized graph generator
-      p_mFullGraph = new Graph(p_mMapData);
+      //create local level graph, based on the known mapdata and a randomized graph generator.
+      //continue with the roadmap and the edge costs learned in earlier runs on this map, when there is one
+      p_mFullGraph = new Graph(p_mMapData, ROADMAP_TYPE, roadmap_file_);
+      p_mFullGraph->updateFixedWaypoints();
+      map_store_.addMap(ENVIRONMENT_MAP, p_mMapData, p_mFullGraph);
+      route_table_.update(p_mFullGraph, p_mMapData->getFixedWPs());
+      p_mGrid.reset(new GridGraph(p_mMapData, GRID_INFLATION, INIT_THREADS));
+      //precompute the navigation functions of the fixed waypoints in the background, on the same grid
+      navigation_functions_.rebuild(p_mMapData, p_mGrid);
       ROS_INFO("init done");
       this->initDone_ = true;
     }
@@ -332,33 +1059,170 @@ void GlobalPlanner::Init()
 
 }
 /*
- * query a graph based on start and target coordinates in carthesian space
+ * release the map grid and the any-angle, coarse-to-fine and incremental searches on it. the caller holds planner_mutex_ exclusively
+ */
+void GlobalPlanner::clearGrid()
+{
+  if (p_mReplanner)
+  {
+    delete p_mReplanner;
+    p_mReplanner = NULL;
+  }
+  for (std::vector<ThetaStar*>::iterator it = theta_star_pool_.begin(); it != theta_star_pool_.end(); it++)
+  {
+    delete (*it);
+  }
+  theta_star_pool_.clear();
+  for (std::vector<CoarseToFineSearch*>::iterator it = coarse_to_fine_pool_.begin(); it != coarse_to_fine_pool_.end();
+      it++)
+  {
+    delete (*it);
+  }
+  coarse_to_fine_pool_.clear();
+  p_mGrid.reset();
+}
+
+/*
+ * query the map grid with Theta* or Lazy Theta*, the path has waypoints only where it bends around objects.
+ * the caller holds planner_mutex_ shared
+ */
+bool GlobalPlanner::QueryGrid(unsigned int xStart, unsigned int yStart, float thStart, unsigned int xTarget,
+                              unsigned int yTarget, float thTarget, bool lazy)
+{
+  ThetaStar* p_search;
+  {
+    boost::mutex::scoped_lock lock(theta_star_mutex_);
+    if (theta_star_pool_.empty())
+    {
+      p_search = new ThetaStar(*p_mGrid);
+    }
+    else
+    {
+      p_search = theta_star_pool_.back();
+      theta_star_pool_.pop_back();
+    }
+  }
+  bool found = p_search->search(xStart, yStart, xTarget, yTarget, lazy);
+  if (found)
+  {
+    outputWaypoints(p_search->getPath(), thStart, thTarget);
+  }
+  else
+  {
+    ROS_ERROR("no any-angle path can be found");
+  }
+  boost::mutex::scoped_lock lock(theta_star_mutex_);
+  theta_star_pool_.push_back(p_search);
+  return found;
+}
+
+/*
+ * query the map grid coarse-to-fine: the coarse levels of the map pyramid first, then the grid in a corridor around
+ * the coarse path. the caller holds planner_mutex_ shared
+ */
+bool GlobalPlanner::QueryCoarseToFine(unsigned int xStart, unsigned int yStart, float thStart, unsigned int xTarget,
+                                      unsigned int yTarget, float thTarget)
+{
+  CoarseToFineSearch* p_search;
+  {
+    boost::mutex::scoped_lock lock(theta_star_mutex_);
+    if (coarse_to_fine_pool_.empty())
+    {
+      p_search = new CoarseToFineSearch(*p_mGrid, p_mMapData->getPyramid());
+    }
+    else
+    {
+      p_search = coarse_to_fine_pool_.back();
+      coarse_to_fine_pool_.pop_back();
+    }
+  }
+  bool found = p_search->search(xStart, yStart, xTarget, yTarget);
+  if (found)
+  {
+    ROS_INFO("coarse-to-fine path on level %u, %u vertices expanded", p_search->getLevel(), p_search->getExpanded());
+    outputWaypoints(p_search->getPath(), thStart, thTarget);
+  }
+  else
+  {
+    ROS_ERROR("no coarse-to-fine path can be found");
+  }
+  boost::mutex::scoped_lock lock(theta_star_mutex_);
+  coarse_to_fine_pool_.push_back(p_search);
+  return found;
+}
+
+/*
+ * query a graph based on start and target coordinates in carthesian space.
+ * planner selects the roadmap or one of the searches on the map grid (skynav_msgs::path_query_srv)
  */
 bool GlobalPlanner::Query(unsigned int xStart, unsigned int yStart, float thStart, unsigned int xTarget,
-                          unsigned int yTarget, float thTarget)
+                          unsigned int yTarget, float thTarget, unsigned char planner)
 {
   if (xStart == xTarget && yStart == yTarget)
   {
     ROS_ERROR("start is target location, nothing to be done");
     return false;
   }
-  if (!initDone_)
   {
-    Init();
+    boost::unique_lock<boost::shared_mutex> lock(planner_mutex_);
+    if (!initDone_)
+    {
+      Init();
+    }
   }
+  boost::shared_lock<boost::shared_mutex> lock(planner_mutex_);
   if (initDone_)
   {
     ROS_INFO("query");
     this->planner_state_ = planner_state::Query;
+    if (planner == skynav_msgs::path_query_srv::Request::THETA_STAR
+        || planner == skynav_msgs::path_query_srv::Request::LAZY_THETA_STAR)
+    {
+      return QueryGrid(xStart, yStart, thStart, xTarget, yTarget, thTarget,
+                       planner == skynav_msgs::path_query_srv::Request::LAZY_THETA_STAR);
+    }
+    if (planner == skynav_msgs::path_query_srv::Request::COARSE_TO_FINE)
+    {
+      return QueryCoarseToFine(xStart, yStart, thStart, xTarget, yTarget, thTarget);
+    }
     /*
      *TODO query global graph
      *TODO determine local graph based on global graph
      */
+    /*
+     * a query between two fixed waypoints is looked up in the route table, a query to a fixed waypoint follows its
+     * navigation function and other queries near fixed waypoints are stitched to the routes between them.
+     * none of them know the temporary objects: a route that runs into one is left for the roadmap, which goes around
+     */
+    double now = MapData::getTime();
+    std::vector<Point> route;
+    if (route_table_.findRoute(xStart, yStart, xTarget, yTarget, route)
+        && !p_mMapData->checkTemporaryPathCollision(route, now))
+    {
+      outputWaypoints(route, thStart, thTarget);
+      return true;
+    }
+
+    boost::shared_ptr<const NavigationFunction> p_navigationFunction = navigation_functions_.find(xTarget, yTarget);
+    if (p_navigationFunction && p_navigationFunction->descend(xStart, yStart, route)
+        && !p_mMapData->checkTemporaryPathCollision(route, now))
+    {
+      outputWaypoints(route, thStart, thTarget);
+      return true;
+    }
+
+    if (route_table_.findStitchedRoute(p_mMapData, xStart, yStart, xTarget, yTarget, route)
+        && !p_mMapData->checkTemporaryPathCollision(route, now))
+    {
+      outputWaypoints(route, thStart, thTarget);
+      return true;
+    }
+
     //query the local level roadmap
-    if (p_mFullGraph->findPath(xStart, yStart, thStart, xTarget, yTarget, thTarget))
+    std::vector<Node*> path;
+    if (p_mFullGraph->findPath(xStart, yStart, thStart, xTarget, yTarget, thTarget, path))
     {
-      std::vector<Node*> path = p_mFullGraph->getPath();
-      //p_mFullGraph->print(true); //print a .dotfile with the grap and highlights the waypoint nodes
+      //p_mFullGraph->print(path); //print a .dotfile with the grap and highlights the waypoint nodes
       outputWaypoints(path);
       return true;
     }
@@ -374,6 +1238,70 @@ bool GlobalPlanner::Query(unsigned int xStart, unsigned int yStart, float thStar
   }
   return false;
 }
+
+/*
+ * query a path for one robot of several on the roadmap. the path keeps clear of the paths planned for the other
+ * robots before, it goes around them or waits for them to pass, and is reserved for this robot in turn.
+ * a new query of a robot replaces its earlier path
+ */
+bool GlobalPlanner::QueryRobot(unsigned int robot, unsigned int xStart, unsigned int yStart, float thStart,
+                               unsigned int xTarget, unsigned int yTarget, float thTarget)
+{
+  {
+    boost::unique_lock<boost::shared_mutex> lock(planner_mutex_);
+    if (!initDone_)
+    {
+      Init();
+    }
+  }
+  boost::shared_lock<boost::shared_mutex> lock(planner_mutex_);
+  if (!initDone_)
+  {
+    ROS_ERROR("Query could not be commenced because environment has not been initialized. Are all nodes active?");
+    return false;
+  }
+  this->planner_state_ = planner_state::Query;
+  double now = MapData::getTime();
+  reservations_.prune(now);
+  std::vector<TimedWaypoint> path;
+  if (!p_mFullGraph->findTimedPath(xStart, yStart, xTarget, yTarget, reservations_, robot, now, path))
+  {
+    return false;
+  }
+  ROS_INFO("robot %u arrives in %.1f s, %u states expanded", robot, path.back().mTime - now,
+           reservations_.getExpanded());
+  outputWaypoints(path, thStart, thTarget);
+  return true;
+}
+
+/*
+ * query a path on one of the maps in the map store, or from one map to another over the links between them.
+ * only the roadmaps are searched, the grid planners and the route table cover the environment map alone
+ */
+bool GlobalPlanner::QueryMaps(const std::string &startMap, unsigned int xStart, unsigned int yStart, float thStart,
+                              const std::string &targetMap, unsigned int xTarget, unsigned int yTarget,
+                              float thTarget)
+{
+  {
+    boost::unique_lock<boost::shared_mutex> lock(planner_mutex_);
+    if (!initDone_)
+    {
+      Init();
+    }
+  }
+  //the environment map in the store is p_mFullGraph, it is not replaced during the query
+  boost::shared_lock<boost::shared_mutex> lock(planner_mutex_);
+  this->planner_state_ = planner_state::Query;
+  std::vector<MapWaypoint> path;
+  float cost;
+  if (!map_store_.findPath(startMap, xStart, yStart, targetMap, xTarget, yTarget, path, cost))
+  {
+    ROS_ERROR("no path can be found");
+    return false;
+  }
+  outputWaypoints(path, thStart, thTarget);
+  return true;
+}
 //TODO function to shut down the program clean
 void GlobalPlanner::Stop()
 {
@@ -390,11 +1318,12 @@ void GlobalPlanner::Error()
 
 /*
  * main function
- * waiting for msg and srv callbacks
+ * waiting for msg and srv callbacks, path queries are served by several threads at once
  */
 void GlobalPlanner::loop(void)
 {
-  ros::spin();
+  ros::MultiThreadedSpinner spinner(QUERY_THREADS);
+  spinner.spin();
   return;
 }
 
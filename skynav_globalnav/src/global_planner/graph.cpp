@@ -7,62 +7,90 @@
 
 #include "graph.h"
 #include "path_finder.h"
-
-Graph::Graph(MapData* p_mapData)
+#include "tour.h"
+#include "reservation_table.h"
+#include "voronoi_roadmap.h"
+#include "visibility_roadmap.h"
+#include <limits>
+#include <cstdio>
+
+Graph::Graph(MapData* p_mapData, roadmapType type)
 {
-  p_mAlgorithm = new PathFinder(this);
   this->p_mMapData = p_mapData;
+  this->mRoadmapType = type;
+  createRoadmap();
+}
 
-  //create a randomized roadmap based on the map and variables given in p_mapdata.
-  createRandomRoadmap(); 
+/*
+ * continue with the roadmap saved in roadmapFile by exportGraph, the roadmap is only built
+ * when there is none saved for this map
+ */
+Graph::Graph(MapData* p_mapData, roadmapType type, const std::string &roadmapFile)
+{
+  this->p_mMapData = p_mapData;
+  this->mRoadmapType = type;
+  if (!importGraph(roadmapFile))
+  {
+    createRoadmap();
+  }
 }
 
 Graph::~Graph()
 {
-  for (std::vector<Edge*>::iterator it = v_mEdges.begin(); it != v_mEdges.end(); it++)
+  //nodes and edges are released block by block by their arenas
+  for (std::vector<PathFinder*>::iterator it = v_mIdleFinders.begin(); it != v_mIdleFinders.end(); it++)
   {
     delete (*it);
   }
-  for (std::vector<Node*>::iterator it = v_mNodes.begin(); it != v_mNodes.end(); it++)
+  mEdges.clear();
+  mNodes.clear();
+  v_mIdleFinders.clear();
+}
+
+//build the roadmap of the type of the graph on the map
+void Graph::createRoadmap()
+{
+  if (mRoadmapType == roadmapTypes::Voronoi_roadmap)
   {
-    delete (*it);
+    //a sparse roadmap through the middle of the free space
+    createVoronoiRoadmap();
+  }
+  else if (mRoadmapType == roadmapTypes::Visibility_roadmap)
+  {
+    //a small roadmap around the corners of the objects
+    createVisibilityRoadmap();
+  }
+  else
+  {
+    //create a randomized roadmap based on the map and variables given in p_mapdata.
+    createRandomRoadmap();
   }
-  v_mEdges.clear();
-  v_mNodes.clear();
-  delete this->p_mAlgorithm;
 }
 /*
- * add a node to the list of nodes
+ * create a new node in the graph and return it. the id of the node is its index in the graph
  */
-bool Graph::addNode(Node* p_node)
+Node* Graph::addNode(unsigned int xPos, unsigned int yPos, nodeType type)
 {
-  v_mNodes.push_back(p_node);
-  return true;
+  unsigned int id = mNodes.add(Node(this, xPos, yPos, mNodes.size(), type));
+  return &mNodes[id];
 }
 /*
  * check if a node exist in the list with nodes
  */
-bool Graph::nodeExist(Node* p_node)
+bool Graph::nodeExist(unsigned int xPos, unsigned int yPos)
 {
-  for (std::vector<Node*>::iterator it = v_mNodes.begin(); it != v_mNodes.end(); it++)
-  {
-    if (p_node->compare(*it))
-    {
-      return true;
-    }
-  }
-  return false;
+  return returnNodeExist(xPos, yPos) != NULL;
 }
 /*
- * return the existing node if the node given as argument already exist
+ * return the existing node on the given coordinates, or NULL if there is none
  */
-Node* Graph::returnNodeExist(Node* p_node)
+Node* Graph::returnNodeExist(unsigned int xPos, unsigned int yPos)
 {
-  for (std::vector<Node*>::iterator it = v_mNodes.begin(); it != v_mNodes.end(); it++)
+  for (unsigned int i = 0; i < mNodes.size(); i++)
   {
-    if (p_node->compare(*it))
+    if (mNodes[i].getXpos() == xPos && mNodes[i].getYpos() == yPos)
     {
-      return (*it);
+      return &mNodes[i];
     }
   }
   return NULL;
@@ -74,58 +102,69 @@ bool Graph::addEdge(Node* p_A, Node* p_B)
 {
   if (!(p_A->compare(p_B))) //check if the nodes are the same. if same, return false
   {
-    Edge* p_Temp = new Edge(p_A, p_B); //create new edge, and check for existence in the graph. if exists, delete, otherwise add.
-    if (!edgeExist(p_Temp))
+    if (!edgeExist(p_A, p_B))
     {
-      v_mEdges.push_back(p_Temp);
-      p_A->addConnection(p_B);
-      p_B->addConnection(p_A);
+      unsigned int edgeId = mEdges.add(Edge(p_A, p_B));
+      p_A->addConnection(p_B->getId(), edgeId);
+      p_B->addConnection(p_A->getId(), edgeId);
       return true;
     }
-    delete p_Temp;
   }
   return false;
 }
 /*
- * check if an edge exist
+ * check if an edge exist between node a and b
  */
-bool Graph::edgeExist(Edge* p_edge)
+bool Graph::edgeExist(Node* p_A, Node* p_B)
 {
-  for (std::vector<Edge*>::iterator it = v_mEdges.begin(); it != v_mEdges.end(); it++)
-  {
-    if (p_edge->compare(*it))
-    {
-      return true;
-    }
-  }
-  return false;
+  return getEdgeBetween(p_A, p_B) != NULL;
 }
 /*
- * return the edge between two nodes
+ * return the edge between two nodes, or NULL if they are not connected
  */
 Edge* Graph::getEdgeBetween(Node* p_A, Node* p_B)
 {
-  Edge* p_Temp = new Edge(p_A, p_B);
-  for (std::vector<Edge*>::iterator it = v_mEdges.begin(); it != v_mEdges.end(); it++)
+  const std::vector<Adjacent> &v_adjacencyList = p_A->getAdjacencyList();
+  for (std::vector<Adjacent>::const_iterator it = v_adjacencyList.begin(); it != v_adjacencyList.end(); it++)
   {
-    if (p_Temp->compare(*it))
+    if ((*it).node == p_B->getId())
     {
-      delete p_Temp;
-      return (*it);
+      return &mEdges[(*it).edge];
     }
   }
-  delete p_Temp;
   return NULL;
 }
 
-std::vector<Node*> Graph::getAllNodes()
+Node* Graph::getNode(unsigned int id)
+{
+  return &mNodes[id];
+}
+
+Edge* Graph::getEdge(unsigned int id)
+{
+  return &mEdges[id];
+}
+
+unsigned int Graph::getNodeCount() const
+{
+  return mNodes.size();
+}
+
+unsigned int Graph::getEdgeCount() const
 {
-  return v_mNodes;
+  return mEdges.size();
 }
 
-std::vector<Edge*> Graph::getAllEdges()
+//the nodes of the graph, indexed by node id
+const Arena<Node>& Graph::getAllNodes() const
 {
-  return v_mEdges;
+  return mNodes;
+}
+
+//the edges of the graph, indexed by edge id
+const Arena<Edge>& Graph::getAllEdges() const
+{
+  return mEdges;
 }
 
 /*
@@ -134,33 +173,68 @@ std::vector<Edge*> Graph::getAllEdges()
  */
 bool Graph::tryCreateEdge(Node* p_A, Node* p_B)
 {
-  Point* pTemp_A = new Point(p_A->getXpos(), p_A->getYpos());
-  Point* pTemp_B = new Point(p_B->getXpos(), p_B->getYpos());
-  Line* p_edgeLine = p_mMapData->Bresenham(pTemp_A, pTemp_B);
-  if (!p_mMapData->checkLineCollission(p_edgeLine))
+  p_mMapData->Bresenham(Point(p_A->getXpos(), p_A->getYpos()), Point(p_B->getXpos(), p_B->getYpos()), &mEdgeLine);
+  if (!p_mMapData->checkLineCollission(&mEdgeLine))
   {
     addEdge(p_A, p_B);
-
-    delete pTemp_A;
-    delete pTemp_B;
-    delete p_edgeLine;
     return true;
   }
-  delete pTemp_A;
-  delete pTemp_B;
-  delete p_edgeLine;
   return false;
 }
+/*
+ * connect a newly placed node to its nearest neighbours, until the max number of connections is reached.
+ * on a visibility roadmap a node is connected to every node it sees, otherwise the paths are not the shortest.
+ * the candidate list is a scratch buffer of the graph, its memory is reused for every new node
+ */
+void Graph::connectNeighbours(Node* p_node)
+{
+  unsigned int ui_maxConnect = this->p_mMapData->getMaxNConnect();
+  float f_maxDist = this->p_mMapData->getMaxNDist();
+  if (mRoadmapType == roadmapTypes::Visibility_roadmap)
+  {
+    ui_maxConnect = mNodes.size();
+    f_maxDist = std::numeric_limits<float>::max();
+  }
+
+  //create list of candidate neighbours
+  v_mCandidates.clear();
+  for (unsigned int i = 0; i < mNodes.size(); i++)
+  {
+    Node* p_other = &mNodes[i];
+    if (!p_node->compare(p_other))
+    {
+      float f_tempDist = p_other->estimateDist(p_node->getXpos(), p_node->getYpos());
+      if (f_tempDist <= f_maxDist)
+      {
+        v_mCandidates.push_back(NeighbourDist(p_other, f_tempDist));
+      }
+    }
+  }
+  //sort neighbour nodes based on distance from current
+  std::sort(v_mCandidates.begin(), v_mCandidates.end(), distSort);
+
+  //connect neighbour nodes untill max_connections
+  unsigned int count = 0;
+  for (std::vector<NeighbourDist>::iterator it = v_mCandidates.begin(); it != v_mCandidates.end(); it++)
+  {
+    if (count < ui_maxConnect)
+    {
+      if (tryCreateEdge(p_node, (*it).node))
+      {
+        count += 1;
+      }
+    }
+    else
+      break;
+  }
+}
 /*
  * create the roadmap, based on random sampling the environment
  */
 void Graph::createRandomRoadmap()
 {
-  unsigned int ui_nodeID = v_mNodes.size() + 1; //TODO node id determination based on something
   unsigned int ui_nodesPlaced = 0; //start number of nodes created
   unsigned int ui_maxNodes = this->p_mMapData->getMaxRandNodes();
-  unsigned int ui_maxConnect = this->p_mMapData->getMaxNConnect();
-  float f_maxDist = this->p_mMapData->getMaxNDist();
   srand(time(NULL));
 
   while (ui_nodesPlaced <= ui_maxNodes)
@@ -172,221 +246,553 @@ void Graph::createRandomRoadmap()
     //check collision of potential new point
     if (!p_mMapData->checkCCollision(tempX,tempY))
     {
-      Node* p_node = new Node(this, tempX, tempY, ui_nodeID, nodeTypes::Random_node);
-      addNode(p_node); //put it in the graph::nodelist
+      Node* p_node = addNode(tempX, tempY, nodeTypes::Random_node); //put it in the graph::nodelist
 
       //p_mMapData->markNode(p_tempPoint, spaceType::Node);
 
-      //create list of candidate neighbours
-      std::vector<NeighbourDist*> candidateNodes;
-      for (std::vector<Node*>::iterator it = v_mNodes.begin(); it != v_mNodes.end(); it++)
-      {
-        if (!p_node->compare(*it))
-        {
-          float f_tempDist = (*it)->estimateDist(tempX, tempY);
-          if (f_tempDist <= f_maxDist)
-          {
-            NeighbourDist* p_neighbour = new NeighbourDist((*it), f_tempDist);
-            candidateNodes.push_back(p_neighbour);
-          }
-        }
-      }
-      //sort neighbour nodes based on distance from current
-      std::sort(candidateNodes.begin(), candidateNodes.end(), distSort);
-
-      //connect neighbour nodes untill max_connections
-      unsigned int count = 0;
-      for (std::vector<NeighbourDist*>::iterator it = candidateNodes.begin(); it != candidateNodes.end(); it++)
-      {
-        if (count < ui_maxConnect)
-        {
-          if (tryCreateEdge(p_node, (*it)->node))
-          {
-            count += 1;
-          }
-        }
-        else
-          break;
-      }
-
-      ui_nodeID++;
+      connectNeighbours(p_node);
       ui_nodesPlaced++;
-      //delete the neighbour nodes list from memory after it is not needed anymore
-      for (std::vector<NeighbourDist*>::iterator it = candidateNodes.begin(); it != candidateNodes.end(); it++)
-      {
-        delete (*it);
-      }
     }
   }
 }
 
+/*
+ * create the roadmap from the generalised Voronoi diagram of the map. the edges are already free of collisions,
+ * nodes on the same cell (where two branches bend at the same place) are merged
+ */
+void Graph::createVoronoiRoadmap()
+{
+  VoronoiRoadmap voronoi;
+  voronoi.build(p_mMapData);
+
+  const std::vector<Point> &v_points = voronoi.getNodes();
+  std::vector<Node*> v_pNodes;
+  v_pNodes.reserve(v_points.size());
+  for (std::vector<Point>::const_iterator it = v_points.begin(); it != v_points.end(); it++)
+  {
+    Node* p_node = returnNodeExist((*it).mXpos, (*it).mYpos);
+    v_pNodes.push_back(p_node != NULL ? p_node : addNode((*it).mXpos, (*it).mYpos, nodeTypes::Voronoi_node));
+  }
+  const std::vector<std::pair<unsigned int, unsigned int> > &v_edges = voronoi.getEdges();
+  for (std::vector<std::pair<unsigned int, unsigned int> >::const_iterator it = v_edges.begin(); it != v_edges.end();
+      it++)
+  {
+    addEdge(v_pNodes[(*it).first], v_pNodes[(*it).second]);
+  }
+}
+
+/*
+ * create the roadmap from the visibility graph of the corners of the objects, the edges are already free of collisions
+ */
+void Graph::createVisibilityRoadmap()
+{
+  VisibilityRoadmap visibility;
+  visibility.build(p_mMapData);
+
+  const std::vector<Point> &v_points = visibility.getNodes();
+  std::vector<Node*> v_pNodes;
+  v_pNodes.reserve(v_points.size());
+  for (std::vector<Point>::const_iterator it = v_points.begin(); it != v_points.end(); it++)
+  {
+    v_pNodes.push_back(addNode((*it).mXpos, (*it).mYpos, nodeTypes::Visibility_node));
+  }
+  const std::vector<std::pair<unsigned int, unsigned int> > &v_edges = visibility.getEdges();
+  for (std::vector<std::pair<unsigned int, unsigned int> >::const_iterator it = v_edges.begin(); it != v_edges.end();
+      it++)
+  {
+    addEdge(v_pNodes[(*it).first], v_pNodes[(*it).second]);
+  }
+}
+
 /*
  * creates a new node on the roadmap and returns it, if it does not already exists.
  * if it already exists, it returns the original node
  */
 Node* Graph::tryAddToRoadmap(unsigned int xPos, unsigned int yPos, float theta, nodeType type)
 {
-  unsigned int ui_nodeID = v_mNodes.size() + 1; //TODO node id determination
-  unsigned int ui_maxConnect = this->p_mMapData->getMaxNConnect();
-  float f_maxDist = this->p_mMapData->getMaxNDist();
-
-  Node* p_tempNode = new Node(this, xPos, yPos, ui_nodeID, type);
-  p_tempNode->setTheta(theta);
-  Node* p_existingNode = returnNodeExist(p_tempNode);
+  Node* p_existingNode = returnNodeExist(xPos, yPos);
   if (p_existingNode != NULL)
   {
-    delete p_tempNode;
     p_existingNode->setTheta(theta);
     return p_existingNode;
   }
-  else if (!p_mMapData->checkPCollision(p_tempNode)){
-    addNode(p_tempNode);
-    p_mMapData->markNode(p_tempNode, spaceType::Node);
-    //create list of candidate neighbours
-    std::vector<NeighbourDist*> candidateNodes;
-    for (std::vector<Node*>::iterator it = v_mNodes.begin(); it != v_mNodes.end(); it++)
+  else if (!p_mMapData->checkCCollision(xPos, yPos)){
+    Node* p_newNode = addNode(xPos, yPos, type);
+    p_newNode->setTheta(theta);
+    //the node is not marked on the map: queries running at the same time read the map grid
+    connectNeighbours(p_newNode);
+    return p_newNode;
+  }else{
+	//node collides with environment
+    return NULL;
+  }
+}
+
+/*
+ * Query the graph for a path with start and target coordinates, the found path is stored in v_pPath.
+ * can be called from several threads at once, every query gets its own PathFinder.
+ * adding the start and target to the roadmap is done exclusively, the search itself only reads the roadmap.
+ * edges of the found path that cross temporary objects of the map are left out until the objects expire,
+ * and the search is repeated. only the edges of found paths are checked, not the whole roadmap
+ */
+bool Graph::findPath(unsigned int xStart, unsigned int yStart, float thStart, unsigned int xTarget,
+                     unsigned int yTarget, float thTarget, std::vector<Node*> &v_pPath)
+{
+  //check if coordinates lie within map region
+  if (p_mMapData->checkCoordinates(xStart, yStart) && p_mMapData->checkCoordinates(xTarget, yTarget))
+  {
+    Node* p_start;
+    Node* p_target;
     {
-      if (!p_tempNode->compare(*it))
-      {
-        float f_tempDist = (*it)->estimateDist(xPos, yPos);
-        if (f_tempDist <= f_maxDist)
-        {
-          NeighbourDist* p_neighbour = new NeighbourDist((*it), f_tempDist);
-          candidateNodes.push_back(p_neighbour);
-        }
-      }
+      boost::unique_lock<boost::shared_mutex> lock(mRoadmapMutex);
+      p_start = tryAddToRoadmap(xStart, yStart, thStart, nodeTypes::Fixed_General); //try to generate new Node(x,y) on graph, or get already existing node
+      p_target = tryAddToRoadmap(xTarget, yTarget, thTarget, nodeTypes::Fixed_General); // ""
     }
-    //sort neighbour nodes based on distance from current
-    std::sort(candidateNodes.begin(), candidateNodes.end(), distSort);
 
-    //connect neighbour nodes untill max_connections
-    unsigned int count = 0;
-    for (std::vector<NeighbourDist*>::iterator it = candidateNodes.begin(); it != candidateNodes.end(); it++)
-    {
-      if (count < ui_maxConnect)
+    if (p_start && p_target)
+    { //check if p_start and p_target != NULL, which means they collide with the environment
+      double now = MapData::getTime();
+      bool found;
+      do
       {
-        if (tryCreateEdge(p_tempNode, (*it)->node))
-        {
-          count += 1;
-        }
+        boost::shared_lock<boost::shared_mutex> lock(mRoadmapMutex);
+        PathFinder* p_finder = acquireFinder();
+        found = p_finder->findPath(p_start, p_target, now); //query the graph to find path from start to target
+        v_pPath = p_finder->getPath();
+        releaseFinder(p_finder);
+      } while (found && invalidateBlockedEdges(v_pPath, now));
+
+      if (found)
+      {
+        ROS_INFO("found Path");
+        return true;
       }
       else
-        break;
+      {
+        ROS_ERROR("no path found");
+        return false;
+      }
     }
-    //delete the neighbour nodes list from memory after it is not needed anymore
-    for (std::vector<NeighbourDist*>::iterator it = candidateNodes.begin(); it != candidateNodes.end(); it++)
+    else
     {
-      delete (*it);
+      ROS_ERROR("start or target collide with environment");
+      return false;
     }
-    return p_tempNode;
-  }else{
-	//node collides with environment
-    delete p_tempNode;
-    return NULL;
   }
+  ROS_ERROR("start or target dont lie on the map");
+  return false;
 }
 
-//--Query the graph for a path with start and target coordinates
-bool Graph::findPath(unsigned int xStart, unsigned int yStart,float thStart, unsigned int xTarget, unsigned int yTarget,float thTarget)
+/*
+ * check the edges of a path against the temporary objects of the map. edges that cross one are left out of the
+ * queries until it expires. true if an edge of the path was left out, the path has to be searched again
+ */
+bool Graph::invalidateBlockedEdges(const std::vector<Node*> &v_pPath, double now)
 {
-  //check if coordinates lie within map region
-  if (p_mMapData->checkCoordinates(xStart, yStart) && p_mMapData->checkCoordinates(xTarget, yTarget))
+  if (!p_mMapData->hasTemporaryObstacles(now))
   {
-    Node* p_start = tryAddToRoadmap(xStart, yStart, thStart, nodeTypes::Fixed_General); //try to generate new Node(x,y) on graph, or get already existing node
-    Node* p_target = tryAddToRoadmap(xTarget, yTarget,thTarget, nodeTypes::Fixed_General);// ""
+    return false;
+  }
+  boost::unique_lock<boost::shared_mutex> lock(mRoadmapMutex);
+  bool invalidated = false;
+  for (unsigned int i = 1; i < v_pPath.size(); i++)
+  {
+    Edge* p_edge = getEdgeBetween(v_pPath[i - 1], v_pPath[i]);
+    p_mMapData->Bresenham(Point(v_pPath[i - 1]->getXpos(), v_pPath[i - 1]->getYpos()),
+                          Point(v_pPath[i]->getXpos(), v_pPath[i]->getYpos()), &mEdgeLine);
+    double blockedUntil = p_mMapData->checkTemporaryLineCollision(&mEdgeLine, now);
+    if (blockedUntil > now)
+    {
+      p_edge->setBlockedUntil(blockedUntil);
+      invalidated = true;
+    }
+  }
+  return invalidated;
+}
+
+/*
+ * find a path for one robot of several on the roadmap, leaving the start at startTime, that keeps clear of the
+ * trajectories reserved in the table for the other robots, and reserve it for this robot.
+ * v_path receives the nodes from the start to the target with the time the robot is planned to be there
+ */
+bool Graph::findTimedPath(unsigned int xStart, unsigned int yStart, unsigned int xTarget, unsigned int yTarget,
+                          ReservationTable &table, unsigned int robot, double startTime,
+                          std::vector<TimedWaypoint> &v_path)
+{
+  if (!p_mMapData->checkCoordinates(xStart, yStart) || !p_mMapData->checkCoordinates(xTarget, yTarget))
+  {
+    ROS_ERROR("start or target dont lie on the map");
+    return false;
+  }
+  Node* p_start;
+  Node* p_target;
+  {
+    boost::unique_lock<boost::shared_mutex> lock(mRoadmapMutex);
+    p_start = tryAddToRoadmap(xStart, yStart, 0, nodeTypes::Fixed_General);
+    p_target = tryAddToRoadmap(xTarget, yTarget, 0, nodeTypes::Fixed_General);
+  }
+  if (!p_start || !p_target)
+  {
+    ROS_ERROR("start or target collide with environment");
+    return false;
+  }
 
-    if(p_start && p_target){ //check if p_start and p_target != NULL, which means they collide with the environment
+  boost::shared_lock<boost::shared_mutex> lock(mRoadmapMutex);
+  if (!table.reservePath(this, p_start, p_target, robot, startTime, v_path))
+  {
+    ROS_ERROR("no path found");
+    return false;
+  }
+  return true;
+}
 
-    if (p_mAlgorithm->findPath(p_start, p_target))//query the graph to find path from start to target
+/*
+ * find a short order to visit all stops, starting at v_stops[0], and the path along them.
+ * the stops are added to the roadmap like the start and target of a query. the cost between every pair of stops
+ * comes from one Dijkstra sweep over the roadmap per stop, the order from Tour. the legs of the path are taken from
+ * the same sweeps, no leg is searched again.
+ * v_order receives the indices in v_stops in visiting order, starting with 0,
+ * v_pPath the nodes of the path from the start to the last stop (the reverse of the order of findPath)
+ */
+bool Graph::findTour(const std::vector<Point> &v_stops, std::vector<unsigned int> &v_order,
+                     std::vector<Node*> &v_pPath, float &cost)
+{
+  unsigned int n = v_stops.size();
+  std::vector<Node*> v_stopNodes;
+  {
+    boost::unique_lock<boost::shared_mutex> lock(mRoadmapMutex);
+    for (std::vector<Point>::const_iterator it = v_stops.begin(); it != v_stops.end(); it++)
     {
-      v_mPath = p_mAlgorithm->getPath();
-      ROS_INFO("found Path");
-      return true;
+      Node* p_node = NULL;
+      if (p_mMapData->checkCoordinates((*it).mXpos, (*it).mYpos))
+      {
+        p_node = tryAddToRoadmap((*it).mXpos, (*it).mYpos, 0, nodeTypes::Fixed_General);
+      }
+      if (!p_node)
+      {
+        ROS_ERROR("stop (%u, %u) collides with the environment or does not lie on the map", (*it).mXpos, (*it).mYpos);
+        return false;
+      }
+      v_stopNodes.push_back(p_node);
     }
-    else
+  }
+
+  boost::shared_lock<boost::shared_mutex> lock(mRoadmapMutex);
+  //cost from every stop to every other stop, and the path of every leg the tour may take,
+  //from the end of the leg back to its start
+  std::vector<float> v_costs(n * n);
+  std::vector<std::vector<unsigned int> > v_legs(n * n);
+  RoadmapGraph roadmap(this);
+  AStarSearch<RoadmapGraph, ZeroHeuristic, float> dijkstra(roadmap);
+  for (unsigned int a = 0; a < n; a++)
+  {
+    dijkstra.search(v_stopNodes[a]->getId(), NO_VERTEX);
+    for (unsigned int b = 0; b < n; b++)
     {
-      ROS_ERROR("no path found");
-      return false;
+      if (!dijkstra.isReached(v_stopNodes[b]->getId()))
+      {
+        ROS_ERROR("stop (%u, %u) can not be reached", v_stops[b].mXpos, v_stops[b].mYpos);
+        return false;
+      }
+      v_costs[a * n + b] = dijkstra.getCost(v_stopNodes[b]->getId());
+      dijkstra.getPath(v_stopNodes[b]->getId(), v_legs[a * n + b]);
     }
-  }else{
-    ROS_ERROR("start or target collide with environment");
-    return false;
   }
+
+  Tour tour(v_costs, n);
+  tour.nearestNeighbour();
+  tour.improve();
+  v_order = tour.getOrder();
+  cost = tour.getCost();
+
+  //the legs of the tour one after the other, the start of every leg is the end of the one before
+  v_pPath.clear();
+  v_pPath.push_back(v_stopNodes[v_order[0]]);
+  for (unsigned int i = 1; i < n; i++)
+  {
+    const std::vector<unsigned int> &v_leg = v_legs[v_order[i - 1] * n + v_order[i]];
+    for (std::vector<unsigned int>::const_reverse_iterator rit = v_leg.rbegin() + 1; rit != v_leg.rend(); rit++)
+    {
+      v_pPath.push_back(&mNodes[*rit]);
+    }
   }
-  ROS_ERROR("start or target dont lie on the map");
-  return false;
+  return true;
 }
 
+/*
+ * take an idle PathFinder from the pool, or create a new one if all are in use by other queries
+ */
+PathFinder* Graph::acquireFinder()
+{
+  boost::mutex::scoped_lock lock(mFinderMutex);
+  if (v_mIdleFinders.empty())
+  {
+    return new PathFinder(this);
+  }
+  PathFinder* p_finder = v_mIdleFinders.back();
+  v_mIdleFinders.pop_back();
+  return p_finder;
+}
 
+//return a PathFinder to the pool, so its search data can be reused by the next query
+void Graph::releaseFinder(PathFinder* p_finder)
+{
+  boost::mutex::scoped_lock lock(mFinderMutex);
+  v_mIdleFinders.push_back(p_finder);
+}
 
 bool Graph::updateFixedWaypoints(){
   /*
    *todo method to delete old fixed waypoints
    *todo memleak here!?
    */
-  std::vector<Node*> p_list = p_mMapData->getFixedWPs();
-for(std::vector<Node*>::iterator it = p_list.begin(); it!=p_list.end();it++){
+  boost::unique_lock<boost::shared_mutex> lock(mRoadmapMutex);
+  const std::vector<Node*> &p_list = p_mMapData->getFixedWPs();
+for(std::vector<Node*>::const_iterator it = p_list.begin(); it!=p_list.end();it++){
   tryAddToRoadmap((*it)->getXpos(),(*it)->getYpos(),(*it)->getTheta(),nodeTypes::Fixed_General);
 }
 ROS_INFO("added new waypoints to graph");
 return true;
 }
 
-//return the found path
-std::vector<Node*> Graph::getPath() const
+/*
+ * learn from a traversal of the edge between two nodes, as reported by the robot. false if there is no such edge,
+ * for instance when the robot followed a path that is not on the roadmap
+ */
+bool Graph::reportTraversal(unsigned int xA, unsigned int yA, unsigned int xB, unsigned int yB, float slowdown,
+                            unsigned int avoidances, bool reached)
 {
-  if(v_mPath.empty()){
-    ROS_ERROR("path is empty");
-    //return NULL
+  boost::unique_lock<boost::shared_mutex> lock(mRoadmapMutex);
+  Node* p_A = returnNodeExist(xA, yA);
+  Node* p_B = returnNodeExist(xB, yB);
+  Edge* p_edge = (p_A && p_B) ? getEdgeBetween(p_A, p_B) : NULL;
+  if (!p_edge)
+  {
+    return false;
   }
-  return v_mPath;
+  p_edge->learnCost(slowdown, avoidances, reached);
+  return true;
 }
 
-//TODO export the current graph to a file
+/*
+ * repair the roadmap after cells of the map have changed (MapData::setCell). only the edges whose line passes a
+ * changed cell are checked against the map again: an edge that now crosses an object is left out of all queries,
+ * an edge that was left out and is clear again is put back. returns the number of edges put out or back
+ */
+unsigned int Graph::applyMapChanges(const std::vector<Point> &v_cells)
+{
+  if (v_cells.empty())
+  {
+    return 0;
+  }
+  unsigned int width = p_mMapData->getXdimension() + 1;
+  unsigned int xMin = v_cells[0].mXpos, xMax = xMin, yMin = v_cells[0].mYpos, yMax = yMin;
+  std::vector<unsigned int> v_changed;
+  v_changed.reserve(v_cells.size());
+  for (std::vector<Point>::const_iterator it = v_cells.begin(); it != v_cells.end(); it++)
+  {
+    xMin = std::min(xMin, (*it).mXpos);
+    xMax = std::max(xMax, (*it).mXpos);
+    yMin = std::min(yMin, (*it).mYpos);
+    yMax = std::max(yMax, (*it).mYpos);
+    v_changed.push_back((*it).mYpos * width + (*it).mXpos);
+  }
+  std::sort(v_changed.begin(), v_changed.end());
+
+  boost::unique_lock<boost::shared_mutex> lock(mRoadmapMutex);
+  unsigned int repaired = 0;
+  for (unsigned int i = 0; i < mEdges.size(); i++)
+  {
+    Node* p_A = &mNodes[mEdges[i].getA()];
+    Node* p_B = &mNodes[mEdges[i].getB()];
+    if (std::max(p_A->getXpos(), p_B->getXpos()) < xMin || std::min(p_A->getXpos(), p_B->getXpos()) > xMax
+        || std::max(p_A->getYpos(), p_B->getYpos()) < yMin || std::min(p_A->getYpos(), p_B->getYpos()) > yMax)
+    {
+      continue;
+    }
+    p_mMapData->Bresenham(Point(p_A->getXpos(), p_A->getYpos()), Point(p_B->getXpos(), p_B->getYpos()), &mEdgeLine);
+    bool passes = false;
+    for (std::vector<Point>::iterator it = mEdgeLine.mCoordinates.begin();
+        !passes && it != mEdgeLine.mCoordinates.end(); it++)
+    {
+      passes = std::binary_search(v_changed.begin(), v_changed.end(), (*it).mYpos * width + (*it).mXpos);
+    }
+    if (!passes)
+    {
+      continue;
+    }
+    bool blocked = mEdges[i].getBlockedUntil() == std::numeric_limits<double>::infinity();
+    if (p_mMapData->checkLineCollission(&mEdgeLine) != blocked)
+    {
+      mEdges[i].setBlockedUntil(blocked ? 0 : std::numeric_limits<double>::infinity());
+      repaired++;
+    }
+  }
+  return repaired;
+}
+
+/*
+ * save the roadmap with the learned edge costs, so they are kept when the planner restarts.
+ * a header line with the roadmap type and the map size, then a line per node (x y type) and per edge (a b factor).
+ * the file is written next to the old one and then replaces it, a crash never leaves half a roadmap.
+ * the start and target nodes of queries are left out with their edges, only the fixed waypoints are kept of them
+ */
 bool Graph::exportGraph(std::string filePath)
 {
-  ROS_INFO("EXPORT GRAPH");
+  boost::shared_lock<boost::shared_mutex> lock(mRoadmapMutex);
+  const std::vector<Node*> &v_fixedWPs = p_mMapData->getFixedWPs();
+  std::vector<int> v_index(mNodes.size(), -1); //index of a node in the file, -1 when it is left out
+  unsigned int nodeCount = 0;
+  for (unsigned int i = 0; i < mNodes.size(); i++)
+  {
+    bool keep = mNodes[i].getType() != nodeTypes::Fixed_General;
+    for (std::vector<Node*>::const_iterator it = v_fixedWPs.begin(); !keep && it != v_fixedWPs.end(); it++)
+    {
+      keep = (*it)->getXpos() == mNodes[i].getXpos() && (*it)->getYpos() == mNodes[i].getYpos();
+    }
+    if (keep)
+    {
+      v_index[i] = nodeCount++;
+    }
+  }
+  unsigned int edgeCount = 0;
+  for (unsigned int i = 0; i < mEdges.size(); i++)
+  {
+    if (v_index[mEdges[i].getA()] >= 0 && v_index[mEdges[i].getB()] >= 0)
+    {
+      edgeCount++;
+    }
+  }
+
+  std::string tempPath = filePath + ".tmp";
+  std::ofstream file(tempPath.c_str());
+  file << "roadmap " << mRoadmapType << " " << p_mMapData->getXdimension() << " " << p_mMapData->getYdimension() << " "
+      << nodeCount << " " << edgeCount << "\n";
+  for (unsigned int i = 0; i < mNodes.size(); i++)
+  {
+    if (v_index[i] >= 0)
+    {
+      file << mNodes[i].getXpos() << " " << mNodes[i].getYpos() << " " << mNodes[i].getType() << "\n";
+    }
+  }
+  for (unsigned int i = 0; i < mEdges.size(); i++)
+  {
+    if (v_index[mEdges[i].getA()] >= 0 && v_index[mEdges[i].getB()] >= 0)
+    {
+      file << v_index[mEdges[i].getA()] << " " << v_index[mEdges[i].getB()] << " " << mEdges[i].getCostFactor() << "\n";
+    }
+  }
+  file.close();
+  if (!file || std::rename(tempPath.c_str(), filePath.c_str()) != 0)
+  {
+    ROS_ERROR("roadmap could not be saved to %s", filePath.c_str());
+    return false;
+  }
   return true;
 }
 
-//TODO import a previously saved graph
+/*
+ * replace the roadmap with one saved by exportGraph, with its learned edge costs.
+ * a roadmap of another type or another map size, or with nodes in objects, is not imported.
+ * edges that cross objects of the map, for instance objects added since the roadmap was saved, are left out
+ */
 bool Graph::importGraph(std::string filePath)
 {
-  ROS_INFO("IMPORT GRAPH");
+  std::ifstream file(filePath.c_str());
+  if (!file)
+  {
+    return false; //nothing saved yet
+  }
+  std::string tag;
+  int type;
+  unsigned int xDim, yDim, nodeCount, edgeCount;
+  file >> tag >> type >> xDim >> yDim >> nodeCount >> edgeCount;
+  if (!file || tag != "roadmap" || type != mRoadmapType || xDim != p_mMapData->getXdimension()
+      || yDim != p_mMapData->getYdimension())
+  {
+    ROS_WARN("saved roadmap %s does not belong to this map, not imported", filePath.c_str());
+    return false;
+  }
 
+  std::vector<Point> v_points;
+  std::vector<int> v_types(nodeCount);
+  for (unsigned int i = 0; i < nodeCount; i++)
+  {
+    unsigned int x, y;
+    file >> x >> y >> v_types[i];
+    if (!file || x >= xDim || y >= yDim || p_mMapData->getCell(x, y) == spaceType::Object)
+    {
+      ROS_WARN("saved roadmap %s has an invalid node, not imported", filePath.c_str());
+      return false;
+    }
+    v_points.push_back(Point(x, y));
+  }
+  std::vector<unsigned int> v_a(edgeCount), v_b(edgeCount);
+  std::vector<float> v_factors(edgeCount);
+  for (unsigned int i = 0; i < edgeCount; i++)
+  {
+    file >> v_a[i] >> v_b[i] >> v_factors[i];
+    if (!file || v_a[i] >= nodeCount || v_b[i] >= nodeCount)
+    {
+      ROS_WARN("saved roadmap %s has an invalid edge, not imported", filePath.c_str());
+      return false;
+    }
+  }
+
+  boost::unique_lock<boost::shared_mutex> lock(mRoadmapMutex);
+  mEdges.clear();
+  mNodes.clear();
+  for (unsigned int i = 0; i < nodeCount; i++)
+  {
+    addNode(v_points[i].mXpos, v_points[i].mYpos, nodeType(v_types[i]));
+  }
+  unsigned int dropped = 0;
+  for (unsigned int i = 0; i < edgeCount; i++)
+  {
+    p_mMapData->Bresenham(v_points[v_a[i]], v_points[v_b[i]], &mEdgeLine);
+    if (p_mMapData->checkLineCollission(&mEdgeLine))
+    {
+      dropped++;
+    }
+    else if (addEdge(&mNodes[v_a[i]], &mNodes[v_b[i]]))
+    {
+      getEdgeBetween(&mNodes[v_a[i]], &mNodes[v_b[i]])->setCostFactor(v_factors[i]);
+    }
+  }
+  ROS_INFO("imported roadmap with %u nodes and %u edges, %u edges crossing objects left out", mNodes.size(),
+           mEdges.size(), dropped);
   return true;
 }
 
 /*
  * print function to print the graph to a .dot file that can be processed by graphviz neato to produce a png image of t the graph
+ * the nodes in v_pPath are highlighted, pass an empty list to print only the graph
  * $ neato -Tpng -s4 graph.dot -O
  */
-void Graph::print(bool path)
+void Graph::print(const std::vector<Node*> &v_pPath)
 {
   std::ofstream dotfile;
   if (dotfile)
   {
     dotfile.open("/bin/graph.dot", std::ofstream::out);
     dotfile << "graph G { \n";
-    for (std::vector<Node*>::iterator it = v_mNodes.begin(); it != v_mNodes.end(); it++)
+    for (unsigned int i = 0; i < mNodes.size(); i++)
     {
-      dotfile << (*it)->getId() << "[";
-      if (path)
+      Node* p_node = &mNodes[i];
+      dotfile << p_node->getId() << "[";
+      for (std::vector<Node*>::const_iterator a = v_pPath.begin(); a != v_pPath.end(); a++)
       {
-        for (std::vector<Node*>::iterator a = v_mPath.begin(); a != v_mPath.end(); a++)
+        if (p_node->compare(*a))
         {
-          if ((*it)->compare(*a))
-          {
-            dotfile << "color=\"red\",style=\"filled\",";
-          }
+          dotfile << "color=\"red\",style=\"filled\",";
         }
       }
-      dotfile << "pos=\"" << (*it)->getXpos() << "," << (*it)->getYpos() << "!\"]\n";
+      dotfile << "pos=\"" << p_node->getXpos() << "," << p_node->getYpos() << "!\"]\n";
     }
 
-    for (std::vector<Edge*>::iterator it = v_mEdges.begin(); it != v_mEdges.end(); it++)
+    for (unsigned int i = 0; i < mEdges.size(); i++)
     {
-      dotfile << (*it)->getA()->getId() << "--" << (*it)->getB()->getId();
+      dotfile << mEdges[i].getA() << "--" << mEdges[i].getB();
       dotfile << ";\n";
     }
 
@@ -413,8 +819,8 @@ void Graph::print(bool path)
 /*-------------------------------------------------------------------
  * sorting function for sorting the neighbour nodes based on distance
  */
-bool distSort(NeighbourDist* p_A, NeighbourDist* p_B)
+bool distSort(const NeighbourDist &A, const NeighbourDist &B)
 {
-  return (p_A->dist < p_B->dist);
+  return (A.dist < B.dist);
 }
 
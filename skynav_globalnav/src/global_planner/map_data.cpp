@@ -6,6 +6,7 @@
  */
 #include <ros/ros.h>
 #include "graph.h"
+#include <boost/date_time/posix_time/posix_time.hpp>
 #define std_maxconnect 10	//
 #define std_maxdist 100
 #define std_maxnodes 400
@@ -40,7 +41,6 @@ MapData::MapData(unsigned int xDimension, unsigned int yDimension, float resolut
 
 MapData::~MapData()
 {
-  v2dMap.clear();
   for (std::vector<Node*>::iterator it = v_mFixedWPs.begin(); it != v_mFixedWPs.end(); it++)
   {
     delete (*it);
@@ -65,21 +65,14 @@ void MapData::setMaxNConnect(unsigned int maxNconn)
 }
 
 /*
- * create the occupance grid of the map and fill with Cfree
+ * create the occupance grid of the map and fill with Cfree. the tiles of the grid only take memory once
+ * something else than free space is put in them
  */
 void MapData::init()
 {
-//resize the 2d vector to match the size of the map
-  v2dMap.resize(mYdim + 1, std::vector<cSpace>(mXdim + 1));
-
-  for (unsigned int y = 0; y < mYdim + 1; y++)
-  {
-    for (unsigned int x = 0; x < mXdim + 1; x++)
-    {
-      v2dMap[y][x] = spaceType::Cfree;
-    }
-  }
+  this->mTemporaryUntil = 0;
 
+  mGrid.resize(mXdim + 1, mYdim + 1, spaceType::Cfree);
 }
 //return distance between coordinates in map.
 float MapData::getPDistance(Point* p_A, Point* p_B)
@@ -97,7 +90,8 @@ float MapData::getPDistance(Point* p_A, Point* p_B)
 //Check if node coordinates collide with environment or already existing node
 bool MapData::checkCCollision(unsigned int x, unsigned int y)
 {
-  if ((v2dMap[y][x]) == spaceType::Object || (v2dMap[y][x]) == spaceType::Node)
+  cSpace cell = getCell(x, y);
+  if (cell == spaceType::Object || cell == spaceType::Node)
   {
     //collision detected
     return true;
@@ -112,7 +106,8 @@ bool MapData::checkPCollision(Node* p_node)
 {
   unsigned int p_x = p_node->getXpos();
   unsigned int p_y = p_node->getYpos();
-  if ((v2dMap[p_y][p_x]) == spaceType::Object || (v2dMap[p_y][p_x]) == spaceType::Node)
+  cSpace cell = getCell(p_x, p_y);
+  if (cell == spaceType::Object || cell == spaceType::Node)
   {
     //collision detected
     return true;
@@ -121,12 +116,12 @@ bool MapData::checkPCollision(Node* p_node)
 
 }
 
-//check for all the points in the vector<point*> in line if there is collision with the known map.
+//check for all the points in the vector<point> in line if there is collision with the known map.
 bool MapData::checkLineCollission(Line* p_line)
 {
-  for (std::vector<Point*>::iterator it = p_line->mCoordinates.begin(); it != p_line->mCoordinates.end(); it++)
+  for (std::vector<Point>::iterator it = p_line->mCoordinates.begin(); it != p_line->mCoordinates.end(); it++)
   {
-    if ((v2dMap[(*it)->mYpos][(*it)->mXpos]) == spaceType::Object)
+    if (mGrid.get((*it).mXpos, (*it).mYpos) == spaceType::Object)
     {
       // line collides with known object on the map
       return true;
@@ -135,15 +130,17 @@ bool MapData::checkLineCollission(Line* p_line)
   return false;
 }
 
-//create a line (vector<Point*>) for the edge between coordinate a and coordinate b
-Line* MapData::Bresenham(Point* A, Point* B)
+//fill p_line with the cells of the line between coordinate a and coordinate b
+//the previous content of p_line is replaced, its memory is reused
+void MapData::Bresenham(const Point &A, const Point &B, Line* p_line)
 {
-  int x1 = A->mXpos;
-  int y1 = A->mYpos;
+  int x1 = A.mXpos;
+  int y1 = A.mYpos;
 
-  int const x2 = B->mXpos;
-  int const y2 = B->mYpos;
-  std::vector<Point*> points;
+  int const x2 = B.mXpos;
+  int const y2 = B.mYpos;
+  std::vector<Point> &points = p_line->mCoordinates;
+  points.clear();
   int delta_x(x2 - x1);
   // if x1 == x2, then it does not matter what we set here
   signed char const ix((delta_x > 0) - (delta_x < 0));
@@ -155,8 +152,7 @@ Line* MapData::Bresenham(Point* A, Point* B)
   delta_y = std::abs(delta_y) << 1;
 
   //push first point into list
-  Point* p_point = new Point(x1, y1);
-  points.push_back(p_point);
+  points.push_back(Point(x1, y1));
 
   if (delta_x >= delta_y)
   {
@@ -174,8 +170,7 @@ Line* MapData::Bresenham(Point* A, Point* B)
 
       error += delta_y;
       x1 += ix;
-      Point* p_point = new Point(x1, y1);
-      points.push_back(p_point);
+      points.push_back(Point(x1, y1));
     }
   }
   else
@@ -194,12 +189,9 @@ Line* MapData::Bresenham(Point* A, Point* B)
 
       error += delta_x;
       y1 += iy;
-      Point* p_point = new Point(x1, y1);
-      points.push_back(p_point);
+      points.push_back(Point(x1, y1));
     }
   }
-  Line* p_line = new Line(points);
-  return p_line;
 }
 
 unsigned int MapData::getMaxRandNodes() const
@@ -226,7 +218,7 @@ unsigned int MapData::getYdimension() const
 //mark a cell on the map as free or occupied
 bool MapData::markNode(Node* p_point, cSpace e_cSpace)
 {
-  v2dMap[p_point->getYpos()][p_point->getXpos()] = e_cSpace;
+  mGrid.set(p_point->getXpos(), p_point->getYpos(), e_cSpace);
   return true;
 }
 
@@ -241,11 +233,11 @@ void MapData::parseOccupancyList(std::vector<int> &occupancyList)
     {
       if (occupancyList[count] == 100)
       {
-        this->v2dMap[y][x] = spaceType::Object;
+        mGrid.set(x, y, spaceType::Object);
       }
       else if (occupancyList[count] == 1)
       {
-        this->v2dMap[y][x] = spaceType::Cfree;
+        mGrid.set(x, y, spaceType::Cfree);
       }
       if (count != occupancyList.size())
       {
@@ -259,6 +251,77 @@ void MapData::parseOccupancyList(std::vector<int> &occupancyList)
   }
 
 }
+
+/*
+ * parse a tile of TILE_SIZE by TILE_SIZE cells of an occupancy grid, row by row, to the 2d grid. p_cells is NULL
+ * when all cells of the tile have the value uniform, a tile of free space inside the map is then set at once.
+ * cells of the tile beyond the map are left out. different tiles can be parsed by different threads at once
+ */
+void MapData::parseOccupancyTile(unsigned int tx, unsigned int ty, const int8_t* p_cells, int8_t uniform)
+{
+  unsigned int x0 = tx << TILE_SHIFT;
+  unsigned int y0 = ty << TILE_SHIFT;
+  bool inside = x0 + TILE_SIZE <= this->mXdim && y0 + TILE_SIZE <= this->mYdim;
+  if (!p_cells && inside && !mGrid.getTile(tx, ty) && (uniform == 100 || uniform == 1))
+  {
+    mGrid.setUniform(tx, ty, uniform == 100 ? spaceType::Object : spaceType::Cfree);
+    return;
+  }
+  unsigned char cells[TILE_CELLS];
+  for (unsigned int y = 0; y < TILE_SIZE; y++)
+  {
+    for (unsigned int x = 0; x < TILE_SIZE; x++)
+    {
+      unsigned char &cell = cells[(y << TILE_SHIFT) | x];
+      cell = (x0 + x <= this->mXdim && y0 + y <= this->mYdim) ? mGrid.get(x0 + x, y0 + y) : (unsigned char) spaceType::Cfree;
+      if (x0 + x < this->mXdim && y0 + y < this->mYdim)
+      {
+        int8_t value = p_cells ? p_cells[(y << TILE_SHIFT) | x] : uniform;
+        if (value == 100)
+        {
+          cell = spaceType::Object;
+        }
+        else if (value == 1)
+        {
+          cell = spaceType::Cfree;
+        }
+      }
+    }
+  }
+  mGrid.setTile(tx, ty, cells);
+}
+
+/*
+ * change a cell of the map after it was parsed, with an occupancy value as in the occupancy grid.
+ * a cleared cell that holds a node stays a node. returns true if the cell became an object or stopped being one,
+ * the roadmap is repaired with Graph::applyMapChanges, the pyramid is updated here. the caller holds the map exclusively
+ */
+bool MapData::setCell(unsigned int x, unsigned int y, int8_t value)
+{
+  if (x >= this->mXdim || y >= this->mYdim)
+  {
+    return false;
+  }
+  cSpace cell = getCell(x, y);
+  if (value == 100)
+  {
+    if (cell == spaceType::Object)
+    {
+      return false;
+    }
+    mGrid.set(x, y, spaceType::Object);
+  }
+  else if (cell == spaceType::Object)
+  {
+    mGrid.set(x, y, spaceType::Cfree);
+  }
+  else
+  {
+    return false;
+  }
+  mPyramid.update(mGrid, x, y);
+  return true;
+}
 //check if coordinates are within the bounds of the stated environment
 bool MapData::checkCoordinates(unsigned int xPos, unsigned int yPos)
 {
@@ -268,12 +331,32 @@ bool MapData::checkCoordinates(unsigned int xPos, unsigned int yPos)
   }
   return true;
 }
-std::vector<std::vector<cSpace> > MapData::getMapData() const
+cSpace MapData::getCell(unsigned int x, unsigned int y) const
+{
+  return cSpace(mGrid.get(x, y));
+}
+
+//the cells of the map, as cSpace
+const TiledGrid<unsigned char>& MapData::getMapData() const
+{
+  return mGrid;
+}
+
+/*
+ * build the resolution pyramid of the map with levels levels, level 0 being the map itself. build it once the map
+ * is parsed, setCell() keeps it up to date
+ */
+void MapData::buildPyramid(unsigned int levels)
+{
+  mPyramid.build(mGrid, levels);
+}
+
+const MapPyramid& MapData::getPyramid() const
 {
-  return v2dMap;
+  return mPyramid;
 }
 
-std::vector<Node*> MapData::getFixedWPs() const
+const std::vector<Node*>& MapData::getFixedWPs() const
 {
   return v_mFixedWPs;
 }
@@ -283,7 +366,7 @@ bool MapData::addFixedWPs(std::vector<Node*> p_list)
   ROS_INFO("add new fixed waypoints");
   for (std::vector<Node*>::iterator it = p_list.begin(); it != p_list.end(); it++)
   {
-    std::cout << (*it)->getId() << std::endl;
+    v_mFixedWPs.push_back((*it));
   }
   return true;
 }
@@ -307,6 +390,101 @@ bool MapData::updateFixedWPs(std::vector<Node*> p_list)
   return true;
 }
 
+//wall clock time in seconds, the clock of the temporary objects
+double MapData::getTime()
+{
+  static const boost::posix_time::ptime epoch(boost::gregorian::date(1970, 1, 1));
+  return (boost::posix_time::microsec_clock::universal_time() - epoch).total_microseconds() / 1e6;
+}
+
+/*
+ * mark objects the robot has seen but that are not on the map, the disc of radius cells around every cell.
+ * they are forgotten after lifetime seconds, unless they are seen again before. the occupancy grid is not changed:
+ * the graph checks the edges of a found path against these objects, and leaves out the edges that cross them
+ */
+void MapData::addTemporaryObstacles(const std::vector<Point> &v_cells, unsigned int radius, float lifetime)
+{
+  boost::unique_lock<boost::shared_mutex> lock(mTemporaryMutex);
+  double now = getTime();
+  double until = now + lifetime;
+  if (mTemporary.getWidth() == 0)
+  {
+    mTemporary.resize(mXdim + 1, mYdim + 1, 0);
+  }
+  int r = radius;
+  for (std::vector<Point>::const_iterator it = v_cells.begin(); it != v_cells.end(); it++)
+  {
+    for (int dy = -r; dy <= r; dy++)
+    {
+      for (int dx = -r; dx <= r; dx++)
+      {
+        int x = int((*it).mXpos) + dx;
+        int y = int((*it).mYpos) + dy;
+        if (dx * dx + dy * dy <= r * r && x >= 0 && y >= 0 && x <= int(mXdim) && y <= int(mYdim))
+        {
+          if (mTemporary.get(x, y) < until)
+          {
+            mTemporary.set(x, y, until);
+          }
+        }
+      }
+    }
+  }
+  mTemporaryUntil = std::max(mTemporaryUntil, until);
+}
+
+//check if any temporary object is still there
+bool MapData::hasTemporaryObstacles(double now)
+{
+  boost::shared_lock<boost::shared_mutex> lock(mTemporaryMutex);
+  return now < mTemporaryUntil;
+}
+
+bool MapData::checkTemporaryObstacle(unsigned int x, unsigned int y, double now)
+{
+  boost::shared_lock<boost::shared_mutex> lock(mTemporaryMutex);
+  return now < mTemporaryUntil && now < mTemporary.get(x, y);
+}
+
+//check a line against the temporary objects. returns the time until which it is blocked, or 0 when it is free
+double MapData::checkTemporaryLineCollision(Line* p_line, double now)
+{
+  boost::shared_lock<boost::shared_mutex> lock(mTemporaryMutex);
+  double blockedUntil = 0;
+  if (now >= mTemporaryUntil)
+  {
+    return blockedUntil;
+  }
+  for (std::vector<Point>::iterator it = p_line->mCoordinates.begin(); it != p_line->mCoordinates.end(); it++)
+  {
+    double until = mTemporary.get((*it).mXpos, (*it).mYpos);
+    if (until > now)
+    {
+      blockedUntil = std::max(blockedUntil, until);
+    }
+  }
+  return blockedUntil;
+}
+
+//check the straight legs of a path against the temporary objects, true when one of them is blocked
+bool MapData::checkTemporaryPathCollision(const std::vector<Point> &v_path, double now)
+{
+  if (!hasTemporaryObstacles(now))
+  {
+    return false;
+  }
+  Line line;
+  for (unsigned int i = 1; i < v_path.size(); i++)
+  {
+    Bresenham(v_path[i - 1], v_path[i], &line);
+    if (checkTemporaryLineCollision(&line, now) > 0)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
 //TODO update the map with new information
 void MapData::update()
 {
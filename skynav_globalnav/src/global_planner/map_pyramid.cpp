@@ -0,0 +1,144 @@
+/*
+ * map_pyramid.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "map_pyramid.h"
+#include "graph.h"
+
+MapPyramid::MapPyramid()
+{
+  mWidth = mHeight = 0;
+}
+
+MapPyramid::~MapPyramid()
+{
+}
+
+void MapPyramid::clear()
+{
+  mWidth = mHeight = 0;
+  v_mLevels.clear();
+}
+
+/*
+ * build levels 1 to levels - 1 of the grid. level 1 is pooled from the tiles of the grid, a tile of one value fills
+ * its cells of level 1 at once. every next level is pooled from the one below it
+ */
+void MapPyramid::build(const TiledGrid<unsigned char> &grid, unsigned int levels)
+{
+  clear();
+  mWidth = grid.getWidth();
+  mHeight = grid.getHeight();
+  for (unsigned int level = 1; level < levels; level++)
+  {
+    v_mLevels.push_back(std::vector<unsigned char>(getWidth(level) * getHeight(level), 0));
+  }
+  if (v_mLevels.empty())
+  {
+    return;
+  }
+
+  for (unsigned int ty = 0; ty < grid.getTilesY(); ty++)
+  {
+    for (unsigned int tx = 0; tx < grid.getTilesX(); tx++)
+    {
+      unsigned int x0 = (tx << TILE_SHIFT) >> 1;
+      unsigned int y0 = (ty << TILE_SHIFT) >> 1;
+      unsigned int x1 = std::min(getWidth(1), x0 + (TILE_SIZE >> 1));
+      unsigned int y1 = std::min(getHeight(1), y0 + (TILE_SIZE >> 1));
+      bool uniform = grid.getTile(tx, ty) == NULL;
+      unsigned char occupied = grid.getUniform(tx, ty) == spaceType::Object;
+      for (unsigned int y = y0; y < y1; y++)
+      {
+        for (unsigned int x = x0; x < x1; x++)
+        {
+          cell(1, x, y) = uniform ? occupied : pool(grid, 1, x, y);
+        }
+      }
+    }
+  }
+  for (unsigned int level = 2; level < levels; level++)
+  {
+    for (unsigned int y = 0; y < getHeight(level); y++)
+    {
+      for (unsigned int x = 0; x < getWidth(level); x++)
+      {
+        cell(level, x, y) = pool(grid, level, x, y);
+      }
+    }
+  }
+}
+
+//the cell x, y of the map changed, pool the cells above it again. stops at the first level that did not change
+void MapPyramid::update(const TiledGrid<unsigned char> &grid, unsigned int x, unsigned int y)
+{
+  for (unsigned int level = 1; level < getLevels(); level++)
+  {
+    x >>= 1;
+    y >>= 1;
+    unsigned char occupied = pool(grid, level, x, y);
+    if (cell(level, x, y) == occupied)
+    {
+      return;
+    }
+    cell(level, x, y) = occupied;
+  }
+}
+
+//whether one of the 2 by 2 cells of the level below the cell x, y of level is occupied
+bool MapPyramid::pool(const TiledGrid<unsigned char> &grid, unsigned int level, unsigned int x, unsigned int y) const
+{
+  unsigned int x1 = std::min(getWidth(level - 1), 2 * x + 2);
+  unsigned int y1 = std::min(getHeight(level - 1), 2 * y + 2);
+  for (unsigned int ly = 2 * y; ly < y1; ly++)
+  {
+    for (unsigned int lx = 2 * x; lx < x1; lx++)
+    {
+      if (level == 1 ? grid.get(lx, ly) == spaceType::Object : isOccupied(level - 1, lx, ly))
+      {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+unsigned char& MapPyramid::cell(unsigned int level, unsigned int x, unsigned int y)
+{
+  return v_mLevels[level - 1][y * getWidth(level) + x];
+}
+
+//the levels including the map itself, 0 before the pyramid is built
+unsigned int MapPyramid::getLevels() const
+{
+  return mWidth ? v_mLevels.size() + 1 : 0;
+}
+
+unsigned int MapPyramid::getWidth(unsigned int level) const
+{
+  return (mWidth + (1u << level) - 1) >> level;
+}
+
+unsigned int MapPyramid::getHeight(unsigned int level) const
+{
+  return (mHeight + (1u << level) - 1) >> level;
+}
+
+//level 0 is not stored, ask the map for its cells
+bool MapPyramid::isOccupied(unsigned int level, unsigned int x, unsigned int y) const
+{
+  return v_mLevels[level - 1][y * getWidth(level) + x] != 0;
+}
+
+//the cells of a level row by row, as in nav_msgs/OccupancyGrid: 100 for occupied and 0 for free
+void MapPyramid::getLevel(unsigned int level, std::vector<signed char> &v_cells) const
+{
+  const std::vector<unsigned char> &v_level = v_mLevels[level - 1];
+  v_cells.resize(v_level.size());
+  for (unsigned int i = 0; i < v_level.size(); i++)
+  {
+    v_cells[i] = v_level[i] ? 100 : 0;
+  }
+}
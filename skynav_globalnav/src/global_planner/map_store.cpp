@@ -0,0 +1,303 @@
+/*
+ * map_store.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "map_store.h"
+#include <limits>
+#include <algorithm>
+
+MapStore::MapStore()
+{
+}
+
+MapStore::~MapStore()
+{
+  for (std::map<std::string, MapEntry>::iterator it = mMaps.begin(); it != mMaps.end(); it++)
+  {
+    releaseEntry(it->second);
+  }
+  mMaps.clear();
+}
+
+void MapStore::releaseEntry(MapEntry &entry)
+{
+  if (entry.mOwned)
+  {
+    delete entry.p_mGraph; //the graph refers to the mapdata
+    delete entry.p_mMapData;
+  }
+}
+
+/*
+ * add a map and build its roadmap, the store owns both from now on. a map with the same name is replaced.
+ * the roadmap is built before the store is locked, queries on the other maps go on meanwhile
+ */
+bool MapStore::addMap(const std::string &name, MapData* p_mapData, roadmapType type)
+{
+  Graph* p_graph = new Graph(p_mapData, type);
+  p_graph->updateFixedWaypoints();
+  boost::unique_lock<boost::shared_mutex> lock(mStoreMutex);
+  std::map<std::string, MapEntry>::iterator it = mMaps.find(name);
+  if (it != mMaps.end())
+  {
+    releaseEntry(it->second);
+  }
+  MapEntry &entry = mMaps[name];
+  entry.p_mMapData = p_mapData;
+  entry.p_mGraph = p_graph;
+  entry.mOwned = true;
+  return true;
+}
+
+/*
+ * add a map with a roadmap that is owned elsewhere, it has to be removed from the store before it is released
+ */
+bool MapStore::addMap(const std::string &name, MapData* p_mapData, Graph* p_graph)
+{
+  boost::unique_lock<boost::shared_mutex> lock(mStoreMutex);
+  std::map<std::string, MapEntry>::iterator it = mMaps.find(name);
+  if (it != mMaps.end())
+  {
+    releaseEntry(it->second);
+  }
+  MapEntry &entry = mMaps[name];
+  entry.p_mMapData = p_mapData;
+  entry.p_mGraph = p_graph;
+  entry.mOwned = false;
+  return true;
+}
+
+//remove a map and the links to it. waits for the queries that are running on the store
+bool MapStore::removeMap(const std::string &name)
+{
+  boost::unique_lock<boost::shared_mutex> lock(mStoreMutex);
+  std::map<std::string, MapEntry>::iterator it = mMaps.find(name);
+  if (it == mMaps.end())
+  {
+    return false;
+  }
+  releaseEntry(it->second);
+  mMaps.erase(it);
+
+  std::vector<Stop> v_linkEnds;
+  for (unsigned int i = 0; i + 1 < v_mLinkEnds.size(); i += 2)
+  {
+    if (v_mLinkEnds[i].mMap != name && v_mLinkEnds[i + 1].mMap != name)
+    {
+      v_linkEnds.push_back(v_mLinkEnds[i]);
+      v_linkEnds.push_back(v_mLinkEnds[i + 1]);
+      v_linkEnds[v_linkEnds.size() - 2].mLink = v_linkEnds.size() - 1;
+      v_linkEnds[v_linkEnds.size() - 1].mLink = v_linkEnds.size() - 2;
+    }
+  }
+  v_mLinkEnds.swap(v_linkEnds);
+  return true;
+}
+
+bool MapStore::hasMap(const std::string &name)
+{
+  boost::shared_lock<boost::shared_mutex> lock(mStoreMutex);
+  return mMaps.find(name) != mMaps.end();
+}
+
+//the roadmap of a map, or NULL if there is no map with this name
+Graph* MapStore::getGraph(const std::string &name)
+{
+  boost::shared_lock<boost::shared_mutex> lock(mStoreMutex);
+  std::map<std::string, MapEntry>::iterator it = mMaps.find(name);
+  return it != mMaps.end() ? it->second.p_mGraph : NULL;
+}
+
+MapData* MapStore::getMapData(const std::string &name)
+{
+  boost::shared_lock<boost::shared_mutex> lock(mStoreMutex);
+  std::map<std::string, MapEntry>::iterator it = mMaps.find(name);
+  return it != mMaps.end() ? it->second.p_mMapData : NULL;
+}
+
+std::vector<std::string> MapStore::getMapNames()
+{
+  boost::shared_lock<boost::shared_mutex> lock(mStoreMutex);
+  std::vector<std::string> names;
+  for (std::map<std::string, MapEntry>::iterator it = mMaps.begin(); it != mMaps.end(); it++)
+  {
+    names.push_back(it->first);
+  }
+  return names;
+}
+
+/*
+ * join a point on one map to a point on another map, for instance the doors of an elevator on two floors.
+ * cost is the cost of going from one to the other, in the same unit as the roadmap (cells), in both directions
+ */
+bool MapStore::addLink(const std::string &mapA, unsigned int xA, unsigned int yA, const std::string &mapB,
+                       unsigned int xB, unsigned int yB, float cost)
+{
+  boost::unique_lock<boost::shared_mutex> lock(mStoreMutex);
+  std::map<std::string, MapEntry>::iterator a = mMaps.find(mapA);
+  std::map<std::string, MapEntry>::iterator b = mMaps.find(mapB);
+  if (a == mMaps.end() || b == mMaps.end())
+  {
+    ROS_ERROR("link between unknown maps %s and %s", mapA.c_str(), mapB.c_str());
+    return false;
+  }
+  if (!a->second.p_mMapData->checkCoordinates(xA, yA) || !b->second.p_mMapData->checkCoordinates(xB, yB)
+      || a->second.p_mMapData->getCell(xA, yA) == spaceType::Object
+      || b->second.p_mMapData->getCell(xB, yB) == spaceType::Object)
+  {
+    ROS_ERROR("link ends do not lie on the free space of their maps");
+    return false;
+  }
+  Stop end;
+  end.mLinkCost = cost;
+  end.mMap = mapA;
+  end.mXpos = xA;
+  end.mYpos = yA;
+  end.mLink = v_mLinkEnds.size() + 1;
+  v_mLinkEnds.push_back(end);
+  end.mMap = mapB;
+  end.mXpos = xB;
+  end.mYpos = yB;
+  end.mLink = v_mLinkEnds.size() - 1;
+  v_mLinkEnds.push_back(end);
+  return true;
+}
+
+unsigned int MapStore::getLinkCount()
+{
+  boost::shared_lock<boost::shared_mutex> lock(mStoreMutex);
+  return v_mLinkEnds.size() / 2;
+}
+
+//the path between two points on the same roadmap, from the target back to the start, and its cost
+bool MapStore::findLeg(Graph* p_graph, const Stop &from, const Stop &to, std::vector<Node*> &v_leg, float &cost)
+{
+  v_leg.clear();
+  cost = 0;
+  if (from.mXpos == to.mXpos && from.mYpos == to.mYpos)
+  {
+    return true;
+  }
+  if (!p_graph->findPath(from.mXpos, from.mYpos, 0, to.mXpos, to.mYpos, 0, v_leg))
+  {
+    return false;
+  }
+  for (unsigned int i = 1; i < v_leg.size(); i++)
+  {
+    cost += p_graph->getEdgeBetween(v_leg[i - 1], v_leg[i])->getCost();
+  }
+  return true;
+}
+
+/*
+ * query a path from a point on one map to a point on the same or another map.
+ * a Dijkstra search over the start, the target and the link ends: a settled point is connected to the other ends of
+ * its links and, by a search on its roadmap, to the points on the same map. the path holds the waypoints of every
+ * leg, from the start to the target, with the map each one lies on
+ */
+bool MapStore::findPath(const std::string &startMap, unsigned int xStart, unsigned int yStart,
+                        const std::string &targetMap, unsigned int xTarget, unsigned int yTarget,
+                        std::vector<MapWaypoint> &v_path, float &cost)
+{
+  boost::shared_lock<boost::shared_mutex> lock(mStoreMutex);
+  v_path.clear();
+  if (mMaps.find(startMap) == mMaps.end() || mMaps.find(targetMap) == mMaps.end())
+  {
+    ROS_ERROR("query on unknown maps %s and %s", startMap.c_str(), targetMap.c_str());
+    return false;
+  }
+
+  //stop 0 is the start, stop 1 the target, the ends of the links follow
+  std::vector<Stop> v_stops(2);
+  v_stops[0].mMap = startMap;
+  v_stops[0].mXpos = xStart;
+  v_stops[0].mYpos = yStart;
+  v_stops[0].mLink = -1;
+  v_stops[1].mMap = targetMap;
+  v_stops[1].mXpos = xTarget;
+  v_stops[1].mYpos = yTarget;
+  v_stops[1].mLink = -1;
+  for (std::vector<Stop>::const_iterator it = v_mLinkEnds.begin(); it != v_mLinkEnds.end(); it++)
+  {
+    v_stops.push_back(*it);
+    v_stops.back().mLink += 2;
+  }
+
+  unsigned int n = v_stops.size();
+  std::vector<float> v_dist(n, std::numeric_limits<float>::infinity());
+  std::vector<int> v_parent(n, -1);
+  std::vector<bool> v_done(n, false);
+  std::vector<bool> v_viaLink(n, false);
+  std::vector<std::vector<Node*> > v_legs(n); //the roadmap path from the parent of a stop to the stop
+  std::vector<Node*> v_leg;
+  v_dist[0] = 0;
+  while (true)
+  {
+    int u = -1;
+    for (unsigned int i = 0; i < n; i++)
+    {
+      if (!v_done[i] && v_dist[i] != std::numeric_limits<float>::infinity() && (u < 0 || v_dist[i] < v_dist[u]))
+      {
+        u = i;
+      }
+    }
+    if (u < 0 || u == 1)
+    {
+      break;
+    }
+    v_done[u] = true;
+
+    int link = v_stops[u].mLink;
+    if (link >= 0 && !v_done[link] && v_dist[u] + v_stops[u].mLinkCost < v_dist[link])
+    {
+      v_dist[link] = v_dist[u] + v_stops[u].mLinkCost;
+      v_parent[link] = u;
+      v_viaLink[link] = true;
+    }
+    Graph* p_graph = mMaps[v_stops[u].mMap].p_mGraph;
+    for (unsigned int v = 0; v < n; v++)
+    {
+      float legCost;
+      if (!v_done[v] && v_stops[v].mMap == v_stops[u].mMap && findLeg(p_graph, v_stops[u], v_stops[v], v_leg, legCost)
+          && v_dist[u] + legCost < v_dist[v])
+      {
+        v_dist[v] = v_dist[u] + legCost;
+        v_parent[v] = u;
+        v_viaLink[v] = false;
+        v_legs[v] = v_leg;
+      }
+    }
+  }
+  if (v_parent[1] < 0 && !(startMap == targetMap && xStart == xTarget && yStart == yTarget))
+  {
+    ROS_ERROR("no path from map %s to map %s can be found", startMap.c_str(), targetMap.c_str());
+    return false;
+  }
+
+  std::vector<unsigned int> v_order;
+  for (int s = 1; s >= 0; s = v_parent[s])
+  {
+    v_order.push_back(s);
+  }
+  std::reverse(v_order.begin(), v_order.end());
+  v_path.push_back(MapWaypoint(startMap, xStart, yStart));
+  for (unsigned int i = 1; i < v_order.size(); i++)
+  {
+    const Stop &stop = v_stops[v_order[i]];
+    if (v_viaLink[v_order[i]])
+    {
+      v_path.push_back(MapWaypoint(stop.mMap, stop.mXpos, stop.mYpos));
+      continue;
+    }
+    //the leg runs from the stop back to its parent, which is on the path already
+    const std::vector<Node*> &v_stopLeg = v_legs[v_order[i]];
+    for (int j = int(v_stopLeg.size()) - 2; j >= 0; j--)
+    {
+      v_path.push_back(MapWaypoint(stop.mMap, v_stopLeg[j]->getXpos(), v_stopLeg[j]->getYpos()));
+    }
+  }
+  cost = v_dist[1];
+  return true;
+}
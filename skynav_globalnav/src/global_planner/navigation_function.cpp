@@ -0,0 +1,286 @@
+/*
+ * navigation_function.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "navigation_function.h"
+#include <boost/bind.hpp>
+
+/*
+ * one step of gradient descent: the grid offers the neighbours of a cell through relax(), like to a search.
+ * the next cell is the neighbour with the lowest step length plus cost-to-go, among the neighbours closer to the goal
+ */
+struct DescentStep
+{
+  const std::vector<float> &v_mCost;
+  float mCurrent;
+  unsigned int mNext;
+  float mBest;
+
+  DescentStep(const std::vector<float> &v_cost, unsigned int current) :
+      v_mCost(v_cost)
+  {
+    this->mCurrent = v_cost[current];
+    this->mNext = NO_VERTEX;
+    this->mBest = CostTraits<float>::infinity();
+  }
+  void relax(unsigned int /*from*/, unsigned int to, float length)
+  {
+    if (v_mCost[to] < mCurrent && v_mCost[to] + length < mBest)
+    {
+      mBest = v_mCost[to] + length;
+      mNext = to;
+    }
+  }
+};
+
+NavigationFunction::NavigationFunction(boost::shared_ptr<const GridGraph> p_grid, unsigned int xGoal,
+                                       unsigned int yGoal) :
+    p_mGrid(p_grid)
+{
+  mGoal = p_grid->getVertex(xGoal, yGoal);
+
+  //the grid is undirected, so the cost from the goal to a cell is the cost-to-go of the cell
+  AStarSearch<GridGraph, ZeroHeuristic, float> wavefront(*p_grid);
+  wavefront.search(mGoal, NO_VERTEX);
+  v_mCost.resize(p_grid->size());
+  for (unsigned int v = 0; v < v_mCost.size(); v++)
+  {
+    v_mCost[v] = wavefront.getCost(v);
+  }
+}
+
+NavigationFunction::~NavigationFunction()
+{
+}
+
+bool NavigationFunction::isReachable(unsigned int x, unsigned int y) const
+{
+  if (x >= p_mGrid->getWidth() || y >= p_mGrid->getHeight())
+  {
+    return false;
+  }
+  return v_mCost[p_mGrid->getVertex(x, y)] != CostTraits<float>::infinity();
+}
+
+float NavigationFunction::getCost(unsigned int x, unsigned int y) const
+{
+  return v_mCost[p_mGrid->getVertex(x, y)];
+}
+
+/*
+ * follow the steepest descent of the cost-to-go from the start cell to the goal.
+ * v_path receives the cells where the direction changes, from start to goal
+ */
+bool NavigationFunction::descend(unsigned int xStart, unsigned int yStart, std::vector<Point> &v_path) const
+{
+  v_path.clear();
+  if (!isReachable(xStart, yStart))
+  {
+    return false;
+  }
+  unsigned int start = p_mGrid->getVertex(xStart, yStart);
+  unsigned int current = start;
+  int dxLast = 0;
+  int dyLast = 0;
+  v_path.push_back(Point(xStart, yStart));
+  while (current != mGoal)
+  {
+    DescentStep step(v_mCost, current);
+    p_mGrid->expand(current, step);
+    if (step.mNext == NO_VERTEX)
+    {
+      return false; //a local minimum, can not happen on a cost-to-go computed on the same grid
+    }
+    int dx = int(p_mGrid->getX(step.mNext)) - int(p_mGrid->getX(current));
+    int dy = int(p_mGrid->getY(step.mNext)) - int(p_mGrid->getY(current));
+    if ((dx != dxLast || dy != dyLast) && current != start)
+    {
+      v_path.push_back(Point(p_mGrid->getX(current), p_mGrid->getY(current))); //the direction changes here
+    }
+    dxLast = dx;
+    dyLast = dy;
+    current = step.mNext;
+  }
+  if (current != start)
+  {
+    v_path.push_back(Point(getGoalX(), getGoalY()));
+  }
+  return true;
+}
+
+unsigned int NavigationFunction::getGoalX() const
+{
+  return p_mGrid->getX(mGoal);
+}
+
+unsigned int NavigationFunction::getGoalY() const
+{
+  return p_mGrid->getY(mGoal);
+}
+
+NavigationFunctionCache::NavigationFunctionCache(unsigned int inflation, unsigned int threads)
+{
+  this->mInflation = inflation;
+  this->mThreads = threads;
+  this->mGeneration = 0;
+  this->mNextGoal = 0;
+  this->p_mBuilders = new boost::thread_group();
+  this->mBuildersGeneration = 0;
+}
+
+NavigationFunctionCache::~NavigationFunctionCache()
+{
+  invalidate();
+  wait();
+  delete p_mBuilders;
+}
+
+/*
+ * drop the functions of the previous map and start building the functions of the fixed waypoints of p_mapData.
+ * the map is copied, it is not used after rebuild() returns
+ */
+void NavigationFunctionCache::rebuild(MapData* p_mapData)
+{
+  rebuild(p_mapData, boost::shared_ptr<const GridGraph>(new GridGraph(p_mapData, mInflation)));
+}
+
+//as rebuild(p_mapData), on a grid of the map that the caller built already with the inflation of the cache
+void NavigationFunctionCache::rebuild(MapData* p_mapData, boost::shared_ptr<const GridGraph> p_grid)
+{
+  std::vector<Point> v_goals;
+  const std::vector<Node*> &v_fixedWPs = p_mapData->getFixedWPs();
+  for (std::vector<Node*>::const_iterator it = v_fixedWPs.begin(); it != v_fixedWPs.end(); it++)
+  {
+    if ((*it)->getXpos() < p_grid->getWidth() && (*it)->getYpos() < p_grid->getHeight())
+    {
+      v_goals.push_back(Point((*it)->getXpos(), (*it)->getYpos()));
+    }
+  }
+
+  invalidate();
+  //builders of the previous generation stop after the function they are working on, without being waited for
+  retireBuilders();
+
+  unsigned int threads = mThreads ? mThreads : std::max(1u, boost::thread::hardware_concurrency());
+  threads = std::min(threads, (unsigned int) v_goals.size());
+  unsigned int generation;
+  {
+    boost::mutex::scoped_lock lock(mMutex);
+    generation = mGeneration;
+    p_mGrid = p_grid;
+    v_mGoals = v_goals;
+    mNextGoal = 0;
+    if (threads > 0)
+    {
+      mRunning[generation] = threads;
+    }
+  }
+  mBuildersGeneration = generation;
+  for (unsigned int i = 0; i < threads; i++)
+  {
+    p_mBuilders->create_thread(boost::bind(&NavigationFunctionCache::buildWorker, this, generation));
+  }
+}
+
+//put the builders aside for an older generation, and release the retired builders that have stopped
+void NavigationFunctionCache::retireBuilders()
+{
+  v_mRetired.push_back(std::make_pair(mBuildersGeneration, p_mBuilders));
+  p_mBuilders = new boost::thread_group();
+  std::vector<std::pair<unsigned int, boost::thread_group*> > v_running;
+  for (unsigned int i = 0; i < v_mRetired.size(); i++)
+  {
+    bool stopped;
+    {
+      boost::mutex::scoped_lock lock(mMutex);
+      stopped = mRunning.find(v_mRetired[i].first) == mRunning.end();
+    }
+    if (stopped)
+    {
+      v_mRetired[i].second->join_all(); //the threads are returning already
+      delete v_mRetired[i].second;
+    }
+    else
+    {
+      v_running.push_back(v_mRetired[i]);
+    }
+  }
+  v_mRetired.swap(v_running);
+}
+
+//drop all functions, for instance when the map or the fixed waypoints change
+void NavigationFunctionCache::invalidate()
+{
+  boost::mutex::scoped_lock lock(mMutex);
+  mGeneration++;
+  mFunctions.clear();
+  v_mGoals.clear();
+  p_mGrid.reset();
+}
+
+//wait until all functions of the current map are built and the builders of older maps have stopped,
+//the finished threads are released
+void NavigationFunctionCache::wait()
+{
+  p_mBuilders->join_all();
+  delete p_mBuilders;
+  p_mBuilders = new boost::thread_group();
+  for (unsigned int i = 0; i < v_mRetired.size(); i++)
+  {
+    v_mRetired[i].second->join_all();
+    delete v_mRetired[i].second;
+  }
+  v_mRetired.clear();
+}
+
+//the function of a goal cell, empty when it is not a fixed waypoint or not built yet
+boost::shared_ptr<const NavigationFunction> NavigationFunctionCache::find(unsigned int xGoal, unsigned int yGoal) const
+{
+  boost::mutex::scoped_lock lock(mMutex);
+  std::map<std::pair<unsigned int, unsigned int>, boost::shared_ptr<const NavigationFunction> >::const_iterator it =
+      mFunctions.find(std::make_pair(xGoal, yGoal));
+  if (it == mFunctions.end())
+  {
+    return boost::shared_ptr<const NavigationFunction>();
+  }
+  return it->second;
+}
+
+unsigned int NavigationFunctionCache::getReadyCount() const
+{
+  boost::mutex::scoped_lock lock(mMutex);
+  return mFunctions.size();
+}
+
+//build functions of generation until all waypoints are taken or the generation is invalidated
+void NavigationFunctionCache::buildWorker(unsigned int generation)
+{
+  while (true)
+  {
+    boost::shared_ptr<const GridGraph> p_grid;
+    Point goal(0, 0);
+    {
+      boost::mutex::scoped_lock lock(mMutex);
+      if (generation != mGeneration || mNextGoal >= v_mGoals.size())
+      {
+        if (--mRunning[generation] == 0)
+        {
+          mRunning.erase(generation);
+        }
+        return;
+      }
+      p_grid = p_mGrid;
+      goal = v_mGoals[mNextGoal++];
+    }
+
+    boost::shared_ptr<const NavigationFunction> p_function(new NavigationFunction(p_grid, goal.mXpos, goal.mYpos));
+
+    boost::mutex::scoped_lock lock(mMutex);
+    if (generation == mGeneration)
+    {
+      mFunctions[std::make_pair(goal.mXpos, goal.mYpos)] = p_function;
+    }
+  }
+}
@@ -11,11 +11,7 @@ Node::Node(unsigned int x, unsigned int y, unsigned int id)
   this->mXpos = x;
   this->mYpos = y;
   this->mID = id;
-  this->p_mParent = NULL;
   this->p_mGraph = NULL;
-  this->mF = 0;
-  this->mG = 0;
-  this->mH = 0;
   this->mType = nodeTypes::Not_Defined;
   this->mTheta = 0;
 
@@ -27,10 +23,6 @@ Node::Node(Graph* graph, unsigned int x, unsigned int y, unsigned int id, nodeTy
   this->mXpos = x;
   this->mYpos = y;
   this->mID = id;
-  this->p_mParent = NULL;
-  this->mF = 0;
-  this->mG = 0;
-  this->mH = 0;
   this->mType = type;
   this->mTheta = 0;
 }
@@ -60,50 +52,23 @@ bool Node::compare(Node* p_node)
   return false;
 }
 
-void Node::addConnection(Node* p_adjacent)
+void Node::addConnection(unsigned int adjacentId, unsigned int edgeId)
 {
-  this->mAdjacencyList.push_back(p_adjacent);
+  this->mAdjacencyList.push_back(Adjacent(adjacentId, edgeId));
 }
 
 //--getters & setters--//
 
-std::vector<Node*> Node::getAdjacencyList()
+const std::vector<Adjacent>& Node::getAdjacencyList() const
 {
   return mAdjacencyList;
 }
 
-void Node::setAdjacencyList(std::vector<Node*> adjacencyList)
+void Node::setAdjacencyList(std::vector<Adjacent> adjacencyList)
 {
   mAdjacencyList = adjacencyList;
 }
 
-float Node::getF()
-{
-  mF = mH + mG;
-  return mF;
-}
-
-void Node::setF(float f)
-{
-  mF = f;
-}
-
-float Node::getG()
-{
-  return mG;
-}
-
-void Node::setG(float g)
-{
-  mG = g;
-}
-
-float Node::getH(Node* p_target)
-{
-  mH = estimateDist(p_target->getXpos(), p_target->getYpos());
-  return mH;
-}
-
 unsigned int Node::getId()
 {
   return mID;
@@ -149,16 +114,6 @@ void Node::setMGraph(Graph* p_graph)
   p_mGraph = p_graph;
 }
 
-Node* Node::getMParent()
-{
-  return p_mParent;
-}
-
-void Node::setMParent(Node* p_parent)
-{
-  p_mParent = p_parent;
-}
-
 void Node::setTheta(float theta)
 {
   this->mTheta = theta;
@@ -0,0 +1,71 @@
+/*
+ * polyline.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "polyline.h"
+
+//squared distance from point p to the line segment a-b
+static float segmentDistance2(const Point &p, const Point &a, const Point &b)
+{
+  float dx = float(b.mXpos) - float(a.mXpos);
+  float dy = float(b.mYpos) - float(a.mYpos);
+  float px = float(p.mXpos) - float(a.mXpos);
+  float py = float(p.mYpos) - float(a.mYpos);
+  float length2 = dx * dx + dy * dy;
+  float t = length2 > 0 ? (px * dx + py * dy) / length2 : 0;
+  t = t < 0 ? 0 : (t > 1 ? 1 : t);
+  float ex = px - t * dx;
+  float ey = py - t * dy;
+  return ex * ex + ey * ey;
+}
+
+void simplifyPolyline(const std::vector<Point> &v_points, float tolerance, std::vector<Point> &v_result)
+{
+  v_result.clear();
+  if (v_points.size() < 3)
+  {
+    v_result = v_points;
+    return;
+  }
+
+  //an explicit stack of ranges instead of recursion, long chains would otherwise recurse deeply
+  std::vector<bool> v_keep(v_points.size(), false);
+  v_keep.front() = true;
+  v_keep.back() = true;
+  std::vector<std::pair<unsigned int, unsigned int> > v_ranges;
+  v_ranges.push_back(std::make_pair(0u, (unsigned int)v_points.size() - 1));
+  while (!v_ranges.empty())
+  {
+    unsigned int first = v_ranges.back().first;
+    unsigned int last = v_ranges.back().second;
+    v_ranges.pop_back();
+
+    float farthest = tolerance * tolerance;
+    unsigned int split = first;
+    for (unsigned int i = first + 1; i < last; i++)
+    {
+      float d = segmentDistance2(v_points[i], v_points[first], v_points[last]);
+      if (d > farthest)
+      {
+        farthest = d;
+        split = i;
+      }
+    }
+    if (split != first)
+    {
+      v_keep[split] = true;
+      v_ranges.push_back(std::make_pair(first, split));
+      v_ranges.push_back(std::make_pair(split, last));
+    }
+  }
+
+  for (unsigned int i = 0; i < v_points.size(); i++)
+  {
+    if (v_keep[i])
+    {
+      v_result.push_back(v_points[i]);
+    }
+  }
+}
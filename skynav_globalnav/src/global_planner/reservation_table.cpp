@@ -0,0 +1,320 @@
+/*
+ * reservation_table.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "reservation_table.h"
+#include <queue>
+#include <set>
+#include <algorithm>
+#include <math.h>
+
+//a state on the open list of the time-expanded search
+struct SpaceTimeOpen
+{
+  float mF;
+  unsigned int mG; //ticks since the start
+  unsigned int mState;
+  SpaceTimeOpen(float f, unsigned int g, unsigned int state)
+  {
+    this->mF = f;
+    this->mG = g;
+    this->mState = state;
+  }
+  //lowest f first, the latest state among equal f
+  bool operator<(const SpaceTimeOpen &other) const
+  {
+    return mF > other.mF || (mF == other.mF && mG < other.mG);
+  }
+};
+
+ReservationTable::ReservationTable(float tick, float speed, float hold)
+{
+  this->mTick = tick;
+  this->mSpeed = speed;
+  this->mHoldTicks = ceilf(hold / tick);
+  this->mEpoch = MapData::getTime();
+  this->mExpanded = 0;
+}
+
+ReservationTable::~ReservationTable()
+{
+}
+
+ReservationTable::Key ReservationTable::key(unsigned int tick, unsigned int id)
+{
+  return (Key(tick) << 32) | id;
+}
+
+unsigned int ReservationTable::toTick(double time) const
+{
+  return time > mEpoch ? (unsigned int)((time - mEpoch) / mTick) : 0;
+}
+
+double ReservationTable::toTime(unsigned int tick) const
+{
+  return mEpoch + double(tick) * mTick;
+}
+
+//ticks to drive along an edge, at least one
+unsigned int ReservationTable::travelTicks(Edge* p_edge) const
+{
+  return std::max(1.0f, ceilf(p_edge->getLength() / mSpeed / mTick));
+}
+
+bool ReservationTable::nodeFree(unsigned int node, unsigned int tick, unsigned int robot) const
+{
+  std::map<Key, unsigned int>::const_iterator it = mNodeReservations.find(key(tick, node));
+  return it == mNodeReservations.end() || it->second == robot;
+}
+
+//whether the edge is free in the ticks first up to and including last
+bool ReservationTable::edgeFree(unsigned int edge, unsigned int first, unsigned int last, unsigned int robot) const
+{
+  for (unsigned int tick = first; tick <= last; tick++)
+  {
+    std::map<Key, unsigned int>::const_iterator it = mEdgeReservations.find(key(tick, edge));
+    if (it != mEdgeReservations.end() && it->second != robot)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool ReservationTable::isNodeFree(unsigned int node, double time, unsigned int robot)
+{
+  boost::mutex::scoped_lock lock(mTableMutex);
+  return nodeFree(node, toTick(time), robot);
+}
+
+bool ReservationTable::isEdgeFree(unsigned int edge, double time, unsigned int robot)
+{
+  boost::mutex::scoped_lock lock(mTableMutex);
+  return edgeFree(edge, toTick(time), toTick(time), robot);
+}
+
+unsigned int ReservationTable::getReservationCount()
+{
+  boost::mutex::scoped_lock lock(mTableMutex);
+  return mNodeReservations.size() + mEdgeReservations.size();
+}
+
+//number of states expanded by the last search
+unsigned int ReservationTable::getExpanded() const
+{
+  return mExpanded;
+}
+
+void ReservationTable::reserve(std::map<Key, unsigned int> &reservations, Key k, unsigned int robot)
+{
+  reservations[k] = robot;
+}
+
+void ReservationTable::releaseLocked(unsigned int robot)
+{
+  for (std::map<Key, unsigned int>::iterator it = mNodeReservations.begin(); it != mNodeReservations.end();)
+  {
+    if (it->second == robot)
+    {
+      mNodeReservations.erase(it++);
+    }
+    else
+    {
+      it++;
+    }
+  }
+  for (std::map<Key, unsigned int>::iterator it = mEdgeReservations.begin(); it != mEdgeReservations.end();)
+  {
+    if (it->second == robot)
+    {
+      mEdgeReservations.erase(it++);
+    }
+    else
+    {
+      it++;
+    }
+  }
+}
+
+//drop the trajectory of a robot, for instance when it has been taken out of service
+void ReservationTable::release(unsigned int robot)
+{
+  boost::mutex::scoped_lock lock(mTableMutex);
+  releaseLocked(robot);
+}
+
+//drop all reservations, the node and edge ids refer to a roadmap that is replaced
+void ReservationTable::clear()
+{
+  boost::mutex::scoped_lock lock(mTableMutex);
+  mNodeReservations.clear();
+  mEdgeReservations.clear();
+}
+
+//drop the reservations of the ticks that have passed
+void ReservationTable::prune(double now)
+{
+  boost::mutex::scoped_lock lock(mTableMutex);
+  Key first = key(toTick(now), 0);
+  mNodeReservations.erase(mNodeReservations.begin(), mNodeReservations.lower_bound(first));
+  mEdgeReservations.erase(mEdgeReservations.begin(), mEdgeReservations.lower_bound(first));
+}
+
+/*
+ * find the earliest arrival of a robot at the target without meeting the reserved trajectories, and reserve it.
+ * after the last reserved tick the roadmap is free at all times, states past it are the same as the state at the
+ * first free tick: the search is finite and finds a path whenever the target can be reached on the roadmap.
+ * the path runs from the start to the target, a wait shows as the node repeated with the time the robot leaves it.
+ * the caller holds the roadmap shared
+ */
+bool ReservationTable::reservePath(Graph* p_graph, Node* p_start, Node* p_target, unsigned int robot,
+                                   double startTime, std::vector<TimedWaypoint> &v_path)
+{
+  boost::mutex::scoped_lock lock(mTableMutex);
+  v_path.clear();
+  mExpanded = 0;
+  releaseLocked(robot); //the new trajectory replaces the old one
+
+  unsigned int startTick = toTick(startTime);
+  unsigned int freeTick = startTick;
+  if (!mNodeReservations.empty())
+  {
+    freeTick = std::max(freeTick, (unsigned int)(mNodeReservations.rbegin()->first >> 32) + 1);
+  }
+  if (!mEdgeReservations.empty())
+  {
+    freeTick = std::max(freeTick, (unsigned int)(mEdgeReservations.rbegin()->first >> 32) + 1);
+  }
+  double now = MapData::getTime();
+  float ticksPerCell = 1 / (mSpeed * mTick);
+
+  v_mStates.clear();
+  std::set<Key> closed;
+  std::priority_queue<SpaceTimeOpen> open;
+  Arrival first;
+  first.mNode = p_start->getId();
+  first.mTick = startTick;
+  first.mPrevious = 0;
+  v_mStates.push_back(first);
+  open.push(SpaceTimeOpen(p_start->estimateDist(p_target->getXpos(), p_target->getYpos()) * ticksPerCell, 0, 0));
+  int goal = -1;
+  while (!open.empty())
+  {
+    unsigned int s = open.top().mState;
+    open.pop();
+    Arrival arrival = v_mStates[s];
+    if (!closed.insert(key(std::min(arrival.mTick, freeTick), arrival.mNode)).second)
+    {
+      continue;
+    }
+    mExpanded++;
+
+    if (arrival.mNode == p_target->getId())
+    {
+      bool free = true;
+      for (unsigned int tick = arrival.mTick; free && tick < arrival.mTick + mHoldTicks && tick < freeTick; tick++)
+      {
+        free = nodeFree(arrival.mNode, tick, robot);
+      }
+      if (free)
+      {
+        goal = s;
+        break;
+      }
+    }
+
+    Node* p_node = p_graph->getNode(arrival.mNode);
+    Arrival next;
+    next.mPrevious = s;
+    //wait a tick, only while other robots may pass
+    if (arrival.mTick < freeTick && nodeFree(arrival.mNode, arrival.mTick + 1, robot))
+    {
+      next.mNode = arrival.mNode;
+      next.mTick = arrival.mTick + 1;
+      v_mStates.push_back(next);
+      open.push(SpaceTimeOpen(next.mTick - startTick
+                                  + p_node->estimateDist(p_target->getXpos(), p_target->getYpos()) * ticksPerCell,
+                              next.mTick - startTick, v_mStates.size() - 1));
+    }
+    const std::vector<Adjacent> &v_adjacent = p_node->getAdjacencyList();
+    for (std::vector<Adjacent>::const_iterator it = v_adjacent.begin(); it != v_adjacent.end(); it++)
+    {
+      Edge* p_edge = p_graph->getEdge((*it).edge);
+      if (p_edge->getBlockedUntil() > now)
+      {
+        continue;
+      }
+      unsigned int ticks = travelTicks(p_edge);
+      if (!edgeFree((*it).edge, arrival.mTick, arrival.mTick + ticks - 1, robot)
+          || !nodeFree((*it).node, arrival.mTick + ticks, robot))
+      {
+        continue;
+      }
+      next.mNode = (*it).node;
+      next.mTick = arrival.mTick + ticks;
+      v_mStates.push_back(next);
+      Node* p_next = p_graph->getNode(next.mNode);
+      open.push(SpaceTimeOpen(next.mTick - startTick
+                                  + p_next->estimateDist(p_target->getXpos(), p_target->getYpos()) * ticksPerCell,
+                              next.mTick - startTick, v_mStates.size() - 1));
+    }
+  }
+  if (goal < 0)
+  {
+    return false;
+  }
+
+  //the states from the target back to the start
+  std::vector<Arrival> v_states;
+  for (unsigned int s = goal; ; s = v_mStates[s].mPrevious)
+  {
+    v_states.push_back(v_mStates[s]);
+    if (s == 0)
+    {
+      break;
+    }
+  }
+  std::reverse(v_states.begin(), v_states.end());
+
+  reserve(mNodeReservations, key(startTick, v_states[0].mNode), robot);
+  for (unsigned int i = 1; i < v_states.size(); i++)
+  {
+    const Arrival &from = v_states[i - 1];
+    const Arrival &to = v_states[i];
+    if (from.mNode != to.mNode)
+    {
+      const std::vector<Adjacent> &v_adjacent = p_graph->getNode(from.mNode)->getAdjacencyList();
+      for (std::vector<Adjacent>::const_iterator it = v_adjacent.begin(); it != v_adjacent.end(); it++)
+      {
+        if ((*it).node == to.mNode)
+        {
+          for (unsigned int tick = from.mTick; tick < to.mTick; tick++)
+          {
+            reserve(mEdgeReservations, key(tick, (*it).edge), robot);
+          }
+          break;
+        }
+      }
+    }
+    reserve(mNodeReservations, key(to.mTick, to.mNode), robot);
+  }
+  unsigned int arrivalTick = v_states.back().mTick;
+  for (unsigned int tick = arrivalTick + 1; tick < arrivalTick + mHoldTicks; tick++)
+  {
+    reserve(mNodeReservations, key(tick, v_states.back().mNode), robot);
+  }
+
+  //keep the first and the last tick of a wait
+  for (unsigned int i = 0; i < v_states.size(); i++)
+  {
+    bool waited = i > 0 && v_states[i - 1].mNode == v_states[i].mNode;
+    bool waits = i + 1 < v_states.size() && v_states[i + 1].mNode == v_states[i].mNode;
+    if (!waited || !waits)
+    {
+      v_path.push_back(TimedWaypoint(p_graph->getNode(v_states[i].mNode), toTime(v_states[i].mTick)));
+    }
+  }
+  return true;
+}
@@ -0,0 +1,275 @@
+/*
+ * route_table.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "route_table.h"
+
+RouteTable::RouteTable()
+{
+}
+
+RouteTable::~RouteTable()
+{
+}
+
+/*
+ * update the table to the fixed waypoints in v_fixedWPs, which are already added to the roadmap of p_graph.
+ * waypoints that are not on the roadmap (colliding with the environment) are left out
+ */
+void RouteTable::update(Graph* p_graph, const std::vector<Node*> &v_fixedWPs)
+{
+  std::vector<Anchor> v_anchors;
+  std::vector<int> v_oldIndex; //index of the anchor in the previous table, -1 for new anchors
+  for (std::vector<Node*>::const_iterator it = v_fixedWPs.begin(); it != v_fixedWPs.end(); it++)
+  {
+    Node* p_node = p_graph->returnNodeExist((*it)->getXpos(), (*it)->getYpos());
+    bool duplicate = false;
+    for (std::vector<Anchor>::const_iterator anchor = v_anchors.begin(); anchor != v_anchors.end(); anchor++)
+    {
+      duplicate = duplicate || (p_node && (*anchor).mNode == p_node->getId());
+    }
+    if (!p_node || duplicate)
+    {
+      continue;
+    }
+    Anchor anchor;
+    anchor.mXpos = p_node->getXpos();
+    anchor.mYpos = p_node->getYpos();
+    anchor.mNode = p_node->getId();
+    int oldIndex = findAnchor(anchor.mXpos, anchor.mYpos);
+    if (oldIndex >= 0 && v_mAnchors[oldIndex].mNode != anchor.mNode)
+    {
+      oldIndex = -1; //same position on another roadmap
+    }
+    v_anchors.push_back(anchor);
+    v_oldIndex.push_back(oldIndex);
+  }
+
+  unsigned int n = v_anchors.size();
+  unsigned int oldN = v_mAnchors.size();
+  std::vector<float> v_cost(n * n, CostTraits<float>::infinity());
+  std::vector<std::vector<Point> > v_routes(n * n);
+
+  //keep the routes between anchors that stay
+  for (unsigned int a = 0; a < n; a++)
+  {
+    v_cost[a * n + a] = 0;
+    for (unsigned int b = a + 1; b < n && v_oldIndex[a] >= 0; b++)
+    {
+      if (v_oldIndex[b] < 0)
+      {
+        continue;
+      }
+      unsigned int oldA = v_oldIndex[a];
+      unsigned int oldB = v_oldIndex[b];
+      v_cost[a * n + b] = v_mCost[oldA * oldN + oldB];
+      v_cost[b * n + a] = v_cost[a * n + b];
+      if (oldA < oldB)
+      {
+        v_routes[a * n + b] = v_mRoutes[oldA * oldN + oldB];
+      }
+      else
+      {
+        v_routes[a * n + b].assign(v_mRoutes[oldB * oldN + oldA].rbegin(), v_mRoutes[oldB * oldN + oldA].rend());
+      }
+    }
+  }
+
+  //search the roadmap from every new anchor to all other anchors
+  RoadmapGraph roadmap(p_graph);
+  AStarSearch<RoadmapGraph, ZeroHeuristic, float> dijkstra(roadmap);
+  std::vector<unsigned int> v_ids;
+  std::vector<unsigned int> v_newAnchors;
+  for (unsigned int k = 0; k < n; k++)
+  {
+    if (v_oldIndex[k] >= 0)
+    {
+      continue;
+    }
+    v_newAnchors.push_back(k);
+    dijkstra.search(v_anchors[k].mNode, NO_VERTEX);
+    for (unsigned int b = 0; b < n; b++)
+    {
+      if (b == k || !dijkstra.isReached(v_anchors[b].mNode))
+      {
+        continue;
+      }
+      v_cost[k * n + b] = dijkstra.getCost(v_anchors[b].mNode);
+      v_cost[b * n + k] = v_cost[k * n + b];
+
+      //the path runs from b back to k
+      dijkstra.getPath(v_anchors[b].mNode, v_ids);
+      std::vector<Point> &v_route = b < k ? v_routes[b * n + k] : v_routes[k * n + b];
+      v_route.clear();
+      for (unsigned int i = 0; i < v_ids.size(); i++)
+      {
+        Node* p_node = p_graph->getNode(b < k ? v_ids[i] : v_ids[v_ids.size() - 1 - i]);
+        v_route.push_back(Point(p_node->getXpos(), p_node->getYpos()));
+      }
+    }
+  }
+
+  v_mAnchors = v_anchors;
+  v_mCost = v_cost;
+  v_mRoutes = v_routes;
+
+  /*
+   * the new anchors add roadmap edges, a shorter route between two kept anchors now passes through a new anchor.
+   * the costs from the new anchors are exact, so one pass over them is enough
+   */
+  std::vector<Point> v_route;
+  for (std::vector<unsigned int>::const_iterator k = v_newAnchors.begin(); k != v_newAnchors.end(); k++)
+  {
+    for (unsigned int a = 0; a < n; a++)
+    {
+      for (unsigned int b = a + 1; b < n; b++)
+      {
+        if (v_oldIndex[a] < 0 || v_oldIndex[b] < 0 || v_mCost[a * n + *k] == CostTraits<float>::infinity()
+            || v_mCost[*k * n + b] == CostTraits<float>::infinity())
+        {
+          continue;
+        }
+        if (v_mCost[a * n + *k] + v_mCost[*k * n + b] < v_mCost[a * n + b])
+        {
+          v_mCost[a * n + b] = v_mCost[a * n + *k] + v_mCost[*k * n + b];
+          v_mCost[b * n + a] = v_mCost[a * n + b];
+          v_route.clear();
+          appendRoute(a, *k, v_route);
+          appendRoute(*k, b, v_route);
+          v_mRoutes[a * n + b] = v_route;
+        }
+      }
+    }
+  }
+  ROS_INFO("route table: %u anchors, %u searched", n, (unsigned int)v_newAnchors.size());
+}
+
+//drop all routes, the next update() searches from every anchor
+void RouteTable::clear()
+{
+  v_mAnchors.clear();
+  v_mCost.clear();
+  v_mRoutes.clear();
+}
+
+/*
+ * search all routes again. update() keeps the routes between anchors that stay, rebuild after the edges of the
+ * roadmap changed: an edit of the map blocks or frees edges, learned costs make other routes shorter
+ */
+void RouteTable::rebuild(Graph* p_graph, const std::vector<Node*> &v_fixedWPs)
+{
+  clear();
+  update(p_graph, v_fixedWPs);
+}
+
+//the route between two anchors, from start to target
+bool RouteTable::findRoute(unsigned int xStart, unsigned int yStart, unsigned int xTarget, unsigned int yTarget,
+                           std::vector<Point> &v_path) const
+{
+  int from = findAnchor(xStart, yStart);
+  int to = findAnchor(xTarget, yTarget);
+  if (from < 0 || to < 0 || from == to || getCost(from, to) == CostTraits<float>::infinity())
+  {
+    return false;
+  }
+  v_path.clear();
+  appendRoute(from, to, v_path);
+  return true;
+}
+
+/*
+ * a route from start to target through the anchors nearest to them: start and target are connected to
+ * an anchor within the neighbour distance of the roadmap, by a straight line that does not collide with the map
+ */
+bool RouteTable::findStitchedRoute(MapData* p_mapData, unsigned int xStart, unsigned int yStart,
+                                   unsigned int xTarget, unsigned int yTarget, std::vector<Point> &v_path) const
+{
+  Line line;
+  int from = findVisibleAnchor(p_mapData, xStart, yStart, &line);
+  int to = findVisibleAnchor(p_mapData, xTarget, yTarget, &line);
+  if (from < 0 || to < 0 || getCost(from, to) == CostTraits<float>::infinity())
+  {
+    return false;
+  }
+  v_path.clear();
+  v_path.push_back(Point(xStart, yStart));
+  appendRoute(from, to, v_path);
+  if (v_path.back().mXpos != xTarget || v_path.back().mYpos != yTarget)
+  {
+    v_path.push_back(Point(xTarget, yTarget));
+  }
+  return true;
+}
+
+unsigned int RouteTable::getAnchorCount() const
+{
+  return v_mAnchors.size();
+}
+
+float RouteTable::getCost(unsigned int from, unsigned int to) const
+{
+  return v_mCost[from * v_mAnchors.size() + to];
+}
+
+//index of the anchor at (x, y), -1 if there is none
+int RouteTable::findAnchor(unsigned int x, unsigned int y) const
+{
+  for (unsigned int i = 0; i < v_mAnchors.size(); i++)
+  {
+    if (v_mAnchors[i].mXpos == x && v_mAnchors[i].mYpos == y)
+    {
+      return i;
+    }
+  }
+  return -1;
+}
+
+//index of the nearest anchor that can be reached from (x, y) in a straight line, -1 if there is none
+int RouteTable::findVisibleAnchor(MapData* p_mapData, unsigned int x, unsigned int y, Line* p_line) const
+{
+  int best = -1;
+  float bestDist = p_mapData->getMaxNDist();
+  for (unsigned int i = 0; i < v_mAnchors.size(); i++)
+  {
+    float dx = float(v_mAnchors[i].mXpos) - float(x);
+    float dy = float(v_mAnchors[i].mYpos) - float(y);
+    float dist = sqrt(dx * dx + dy * dy);
+    if (dist > bestDist)
+    {
+      continue;
+    }
+    p_mapData->Bresenham(Point(x, y), Point(v_mAnchors[i].mXpos, v_mAnchors[i].mYpos), p_line);
+    if (!p_mapData->checkLineCollission(p_line))
+    {
+      best = i;
+      bestDist = dist;
+    }
+  }
+  return best;
+}
+
+//append the route from anchor from to anchor to, the first point is left out when v_path already ends there
+void RouteTable::appendRoute(unsigned int from, unsigned int to, std::vector<Point> &v_path) const
+{
+  unsigned int n = v_mAnchors.size();
+  if (from == to)
+  {
+    if (v_path.empty() || v_path.back().mXpos != v_mAnchors[from].mXpos || v_path.back().mYpos != v_mAnchors[from].mYpos)
+    {
+      v_path.push_back(Point(v_mAnchors[from].mXpos, v_mAnchors[from].mYpos));
+    }
+    return;
+  }
+  const std::vector<Point> &v_route = from < to ? v_mRoutes[from * n + to] : v_mRoutes[to * n + from];
+  for (unsigned int i = 0; i < v_route.size(); i++)
+  {
+    const Point &point = from < to ? v_route[i] : v_route[v_route.size() - 1 - i];
+    if (i == 0 && !v_path.empty() && v_path.back().mXpos == point.mXpos && v_path.back().mYpos == point.mYpos)
+    {
+      continue;
+    }
+    v_path.push_back(point);
+  }
+}
@@ -0,0 +1,60 @@
+/*
+ * route_table.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef ROUTE_TABLE_H_
+#define ROUTE_TABLE_H_
+#include <ros/ros.h>
+#include <vector>
+
+#include "graph.h"
+#include "search_graphs.h"
+
+/*
+ * shortest routes on the roadmap between every pair of fixed waypoints (the anchors), with their cost.
+ * a query between two anchors is a table lookup. other queries can be stitched: a straight leg from the start
+ * to a visible anchor nearby, the route between the anchors and a straight leg to the target.
+ *
+ * update() only searches from anchors that are new since the last update; routes between the other anchors are kept
+ * and improved through the new anchors. roadmap nodes added for other queries are only used after clear().
+ * when edges change, by an edit of the map or by learned costs, the kept routes are stale and rebuild() searches all.
+ * the table is not locked, update() and clear() must not run at the same time as a lookup.
+ */
+class RouteTable
+{
+public:
+  RouteTable();
+  virtual ~RouteTable();
+
+  void update(Graph* p_graph, const std::vector<Node*> &v_fixedWPs);
+  void clear();
+  void rebuild(Graph* p_graph, const std::vector<Node*> &v_fixedWPs);
+
+  bool findRoute(unsigned int xStart, unsigned int yStart, unsigned int xTarget, unsigned int yTarget,
+                 std::vector<Point> &v_path) const;
+  bool findStitchedRoute(MapData* p_mapData, unsigned int xStart, unsigned int yStart, unsigned int xTarget,
+                         unsigned int yTarget, std::vector<Point> &v_path) const;
+
+  unsigned int getAnchorCount() const;
+  float getCost(unsigned int from, unsigned int to) const;
+
+private:
+  struct Anchor
+  {
+    unsigned int mXpos;
+    unsigned int mYpos;
+    unsigned int mNode; //id of the roadmap node of the anchor
+  };
+
+  int findAnchor(unsigned int x, unsigned int y) const;
+  int findVisibleAnchor(MapData* p_mapData, unsigned int x, unsigned int y, Line* p_line) const;
+  void appendRoute(unsigned int from, unsigned int to, std::vector<Point> &v_path) const;
+
+  std::vector<Anchor> v_mAnchors;
+  std::vector<float> v_mCost; //cost from anchor a to anchor b at a * anchors + b
+  std::vector<std::vector<Point> > v_mRoutes; //route from anchor a to anchor b at a * anchors + b, only for a < b
+};
+
+#endif /* ROUTE_TABLE_H_ */
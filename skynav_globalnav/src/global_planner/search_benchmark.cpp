@@ -0,0 +1,241 @@
+/*
+ * search_benchmark.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+/*
+ * times the instantiations of AStarSearch on one ascii map (as read by map_reader, '#' is an object).
+ * usage: search_benchmark <map file> [queries]
+ * the random, Voronoi and visibility roadmaps are all built, their searches query random pairs of roadmap nodes.
+ * the grid searches query random pairs of free cells.
+ */
+
+#include <ros/ros.h>
+#include <fstream>
+#include <cstdio>
+#include <cstdlib>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include "graph.h"
+#include "path_finder.h"
+#include "search_graphs.h"
+#include "theta_star.h"
+
+typedef std::vector<std::pair<unsigned int, unsigned int> > QueryList;
+
+MapData* readMap(const char* filePath)
+{
+  std::ifstream file(filePath);
+  if (!file.good())
+  {
+    return NULL;
+  }
+  file.unsetf(std::ios_base::skipws);
+  std::vector<int> occupancy;
+  unsigned int yDim = 0;
+  for (char c; file >> c;)
+  {
+    if (c == '#')
+    {
+      occupancy.push_back(100);
+    }
+    else if (c == '\n')
+    {
+      yDim++;
+    }
+    else if (c != '\r')
+    {
+      occupancy.push_back(1);
+    }
+  }
+  if (yDim == 0)
+  {
+    return NULL;
+  }
+  MapData* p_mapData = new MapData(occupancy.size() / yDim, yDim, 1);
+  p_mapData->parseOccupancyList(occupancy);
+  return p_mapData;
+}
+
+//run all queries with one search object and print the time and expansions per query
+template<class SearchT>
+void timeQueries(const char* name, SearchT &search, const QueryList &queries)
+{
+  unsigned long expanded = 0;
+  unsigned int found = 0;
+  boost::posix_time::ptime start = boost::posix_time::microsec_clock::local_time();
+  for (QueryList::const_iterator it = queries.begin(); it != queries.end(); it++)
+  {
+    if (search.search((*it).first, (*it).second))
+    {
+      found++;
+    }
+    expanded += search.getExpanded();
+  }
+  boost::posix_time::time_duration duration = boost::posix_time::microsec_clock::local_time() - start;
+  printf("%-28s %10.1f us/query %10lu expanded/query %6u/%u found\n", name,
+         double(duration.total_microseconds()) / queries.size(), expanded / queries.size(), found,
+         (unsigned int)queries.size());
+}
+
+//the pointer based roadmap, through the PathFinder used by Graph::findPath
+void timePathFinder(const char* name, Graph* p_graph, const QueryList &queries)
+{
+  PathFinder finder(p_graph);
+  unsigned long expanded = 0;
+  unsigned long waypoints = 0;
+  boost::posix_time::ptime start = boost::posix_time::microsec_clock::local_time();
+  for (QueryList::const_iterator it = queries.begin(); it != queries.end(); it++)
+  {
+    finder.findPath(p_graph->getNode((*it).first), p_graph->getNode((*it).second));
+    expanded += finder.getExpanded();
+    waypoints += finder.getPath().size();
+  }
+  printf("%-28s %10.1f us/query %10lu expanded/query %4.1f waypoints/query\n", name,
+         double((boost::posix_time::microsec_clock::local_time() - start).total_microseconds()) / queries.size(),
+         expanded / queries.size(), double(waypoints) / queries.size());
+}
+
+int main(int argc, char **argv)
+{
+  if (argc < 2)
+  {
+    printf("usage: search_benchmark <map file> [queries]\n");
+    return 1;
+  }
+  unsigned int queryCount = argc > 2 ? atoi(argv[2]) : 1000;
+  MapData* p_mapData = readMap(argv[1]);
+  if (!p_mapData)
+  {
+    printf("could not read map %s\n", argv[1]);
+    return 1;
+  }
+  boost::posix_time::ptime start = boost::posix_time::microsec_clock::local_time();
+  Graph* p_voronoiGraph = new Graph(p_mapData, roadmapTypes::Voronoi_roadmap);
+  printf("map %ux%u, voronoi roadmap %u nodes %u edges, built in %ld ms\n", p_mapData->getXdimension(),
+         p_mapData->getYdimension(), p_voronoiGraph->getNodeCount(), p_voronoiGraph->getEdgeCount(),
+         (long)(boost::posix_time::microsec_clock::local_time() - start).total_milliseconds());
+
+  start = boost::posix_time::microsec_clock::local_time();
+  Graph* p_visibilityGraph = new Graph(p_mapData, roadmapTypes::Visibility_roadmap);
+  printf("map %ux%u, visibility roadmap %u nodes %u edges, built in %ld ms\n", p_mapData->getXdimension(),
+         p_mapData->getYdimension(), p_visibilityGraph->getNodeCount(), p_visibilityGraph->getEdgeCount(),
+         (long)(boost::posix_time::microsec_clock::local_time() - start).total_milliseconds());
+
+  start = boost::posix_time::microsec_clock::local_time();
+  Graph* p_graph = new Graph(p_mapData);
+  printf("map %ux%u, random roadmap %u nodes %u edges, built in %ld ms\n", p_mapData->getXdimension(),
+         p_mapData->getYdimension(), p_graph->getNodeCount(), p_graph->getEdgeCount(),
+         (long)(boost::posix_time::microsec_clock::local_time() - start).total_milliseconds());
+  srand(1);
+
+  QueryList roadmapQueries;
+  for (unsigned int i = 0; i < queryCount; i++)
+  {
+    roadmapQueries.push_back(std::make_pair(rand() % p_graph->getNodeCount(), rand() % p_graph->getNodeCount()));
+  }
+
+  timePathFinder("PathFinder", p_graph, roadmapQueries);
+  QueryList voronoiQueries;
+  for (unsigned int i = 0; i < queryCount; i++)
+  {
+    voronoiQueries.push_back(std::make_pair(rand() % p_voronoiGraph->getNodeCount(),
+                                            rand() % p_voronoiGraph->getNodeCount()));
+  }
+  timePathFinder("PathFinder voronoi", p_voronoiGraph, voronoiQueries);
+  if (p_visibilityGraph->getNodeCount() > 0)
+  {
+    QueryList visibilityQueries;
+    for (unsigned int i = 0; i < queryCount; i++)
+    {
+      visibilityQueries.push_back(std::make_pair(rand() % p_visibilityGraph->getNodeCount(),
+                                                 rand() % p_visibilityGraph->getNodeCount()));
+    }
+    timePathFinder("PathFinder visibility", p_visibilityGraph, visibilityQueries);
+  }
+
+  RoadmapGraph roadmap(p_graph);
+  CsrGraph csr(p_graph);
+  ALTHeuristic<CsrGraph> roadmapALT;
+  roadmapALT.build(csr, 8, 0);
+  {
+    AStarSearch<RoadmapGraph, EuclideanHeuristic, float> search(roadmap);
+    timeQueries("roadmap euclidean float", search, roadmapQueries);
+  }
+  {
+    AStarSearch<CsrGraph, EuclideanHeuristic, float> search(csr);
+    timeQueries("csr euclidean float", search, roadmapQueries);
+  }
+  {
+    AStarSearch<CsrGraph, EuclideanHeuristic, double> search(csr);
+    timeQueries("csr euclidean double", search, roadmapQueries);
+  }
+  {
+    AStarSearch<CsrGraph, ALTHeuristic<CsrGraph>, float> search(csr, roadmapALT);
+    timeQueries("csr alt float", search, roadmapQueries);
+  }
+
+  GridGraph grid(p_mapData);
+  QueryList gridQueries;
+  while (gridQueries.size() < queryCount)
+  {
+    unsigned int source = rand() % grid.size();
+    unsigned int target = rand() % grid.size();
+    if (!grid.isBlocked(source) && !grid.isBlocked(target))
+    {
+      gridQueries.push_back(std::make_pair(source, target));
+    }
+  }
+  unsigned int first = 0;
+  while (grid.isBlocked(first))
+  {
+    first++;
+  }
+  ALTHeuristic<GridGraph> gridALT;
+  gridALT.build(grid, 8, first);
+  {
+    AStarSearch<GridGraph, EuclideanHeuristic, float> search(grid);
+    timeQueries("grid euclidean float", search, gridQueries);
+  }
+  {
+    AStarSearch<GridGraph, OctileHeuristic, float> search(grid);
+    timeQueries("grid octile float", search, gridQueries);
+  }
+  {
+    AStarSearch<GridGraph, OctileHeuristic, int> search(grid);
+    timeQueries("grid octile int", search, gridQueries);
+  }
+  {
+    AStarSearch<GridGraph, ALTHeuristic<GridGraph>, float> search(grid, gridALT);
+    timeQueries("grid alt float", search, gridQueries);
+  }
+
+  //any-angle searches, with the number of waypoints of the path
+  ThetaStar thetaStar(grid);
+  for (unsigned int lazy = 0; lazy < 2; lazy++)
+  {
+    unsigned long expanded = 0;
+    unsigned long sightChecks = 0;
+    unsigned long waypoints = 0;
+    start = boost::posix_time::microsec_clock::local_time();
+    for (QueryList::const_iterator it = gridQueries.begin(); it != gridQueries.end(); it++)
+    {
+      thetaStar.search(grid.getX((*it).first), grid.getY((*it).first), grid.getX((*it).second),
+                       grid.getY((*it).second), lazy);
+      expanded += thetaStar.getExpanded();
+      sightChecks += thetaStar.getSightChecks();
+      waypoints += thetaStar.getPath().size();
+    }
+    printf("%-28s %10.1f us/query %10lu expanded/query %6lu sight checks/query %4.1f waypoints/query\n",
+           lazy ? "grid lazy theta*" : "grid theta*",
+           double((boost::posix_time::microsec_clock::local_time() - start).total_microseconds()) / queryCount,
+           expanded / queryCount, sightChecks / queryCount, double(waypoints) / queryCount);
+  }
+
+  delete p_voronoiGraph;
+  delete p_visibilityGraph;
+  delete p_graph;
+  delete p_mapData;
+  return 0;
+}
@@ -0,0 +1,387 @@
+/*
+ * search_core.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef SEARCH_CORE_H_
+#define SEARCH_CORE_H_
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <math.h>
+#include <boost/shared_ptr.hpp>
+
+#include "search_state.h"
+
+#define SQRT2 1.41421356f
+#define HEURISTIC_TIE_BREAK 1.00001f //floating point estimates are scaled up slightly, see CostTraits
+
+/*
+ * conversion of a distance (in map cells) to the cost type of a search.
+ * integer costs are scaled by 10, so diagonal grid steps (14) are not rounded to straight steps.
+ * integer estimates are rounded down so a heuristic stays admissible. floating point estimates are scaled up
+ * by HEURISTIC_TIE_BREAK: with an exact heuristic many vertices have the same f, and rounding noise in g + h
+ * would otherwise decide the order instead of the preference for the deepest vertex. paths are at most 0.001% longer
+ */
+template<class CostT>
+struct CostTraits
+{
+  static CostT fromDistance(float d)
+  {
+    return static_cast<CostT>(d);
+  }
+  static CostT fromEstimate(float d)
+  {
+    return static_cast<CostT>(d * HEURISTIC_TIE_BREAK);
+  }
+  static CostT infinity()
+  {
+    return std::numeric_limits<CostT>::max();
+  }
+};
+
+template<>
+struct CostTraits<int>
+{
+  static int fromDistance(float d)
+  {
+    return static_cast<int>(d * 10 + 0.5f);
+  }
+  static int fromEstimate(float d)
+  {
+    return static_cast<int>(d * 10);
+  }
+  static int infinity()
+  {
+    return std::numeric_limits<int>::max();
+  }
+};
+
+template<>
+struct CostTraits<unsigned int>
+{
+  static unsigned int fromDistance(float d)
+  {
+    return static_cast<unsigned int>(d * 10 + 0.5f);
+  }
+  static unsigned int fromEstimate(float d)
+  {
+    return static_cast<unsigned int>(d * 10);
+  }
+  static unsigned int infinity()
+  {
+    return std::numeric_limits<unsigned int>::max();
+  }
+};
+
+/*
+ * heuristics, estimate the distance between vertex v and target t of a graph.
+ * a graph type provides getX(v) and getY(v) in map cells
+ */
+
+//no estimate, turns A* into Dijkstra
+struct ZeroHeuristic
+{
+  template<class GraphT>
+  float operator()(const GraphT &/*graph*/, unsigned int /*v*/, unsigned int /*t*/) const
+  {
+    return 0;
+  }
+};
+
+//straight line distance, admissible for roadmaps and grids
+struct EuclideanHeuristic
+{
+  template<class GraphT>
+  float operator()(const GraphT &graph, unsigned int v, unsigned int t) const
+  {
+    float dx = float(graph.getX(v)) - float(graph.getX(t));
+    float dy = float(graph.getY(v)) - float(graph.getY(t));
+    return sqrtf(dx * dx + dy * dy);
+  }
+};
+
+//exact distance on an empty 8-connected grid. not admissible on roadmaps, where edges can be any angle
+struct OctileHeuristic
+{
+  template<class GraphT>
+  float operator()(const GraphT &graph, unsigned int v, unsigned int t) const
+  {
+    unsigned int dx = graph.getX(v) > graph.getX(t) ? graph.getX(v) - graph.getX(t) : graph.getX(t) - graph.getX(v);
+    unsigned int dy = graph.getY(v) > graph.getY(t) ? graph.getY(v) - graph.getY(t) : graph.getY(t) - graph.getY(v);
+    if (dx > dy)
+    {
+      return dx + (SQRT2 - 1) * dy;
+    }
+    return dy + (SQRT2 - 1) * dx;
+  }
+};
+
+/*
+ * A* search on a graph type GraphT, with heuristic HeuristicT and path costs accumulated in CostT.
+ * all three are template parameters, so edge iteration, the heuristic and the cost arithmetic inline.
+ *
+ * GraphT provides
+ *   unsigned int size() const                       number of vertex ids
+ *   unsigned int getX(v) const, getY(v) const        position in map cells
+ *   template<class S> void expand(v, S &search) const   calls search.relax(v, w, length) for every neighbour w
+ *
+ * the open list is a binary heap with lazy deletion, the search data is reused between queries,
+ * so a search object that is reused does not allocate once its arrays have grown to the graph size.
+ */
+template<class GraphT, class HeuristicT, class CostT>
+class AStarSearch
+{
+public:
+  AStarSearch(const GraphT &graph, const HeuristicT &heuristic = HeuristicT()) :
+      mGraph(graph), mHeuristic(heuristic)
+  {
+    mTarget = NO_VERTEX;
+    mExpanded = 0;
+  }
+  virtual ~AStarSearch()
+  {
+  }
+
+  /*
+   * search a path from source to target. with target NO_VERTEX the whole graph is searched (Dijkstra),
+   * after which getCost() gives the cost from source to every reached vertex
+   */
+  bool search(unsigned int source, unsigned int target)
+  {
+    begin(target);
+    addSource(source, 0);
+    return run();
+  }
+
+  //start a new query, sources are added with addSource() before run()
+  void begin(unsigned int target)
+  {
+    mState.reset(mGraph.size());
+    v_mHeap.clear();
+    mTarget = target;
+    mExpanded = 0;
+  }
+
+  //add a start vertex with an initial cost, for searches from several sources at once
+  void addSource(unsigned int source, CostT cost)
+  {
+    if (mState.getList(source) != listState::Unvisited && mState.getG(source) <= cost)
+    {
+      return;
+    }
+    mState.setG(source, cost);
+    mState.setParent(source, NO_VERTEX);
+    mState.setList(source, listState::Open);
+    push(source, cost);
+  }
+
+  //expand vertices until the target is closed or the open list is empty
+  bool run()
+  {
+    while (!v_mHeap.empty())
+    {
+      std::pop_heap(v_mHeap.begin(), v_mHeap.end(), HeapCompare());
+      HeapEntry entry = v_mHeap.back();
+      v_mHeap.pop_back();
+
+      if (mState.getList(entry.v) == listState::Closed || entry.g != mState.getG(entry.v))
+      {
+        continue; //outdated heap entry, the vertex was reached cheaper after it was pushed
+      }
+      mState.setList(entry.v, listState::Closed);
+      if (entry.v == mTarget)
+      {
+        return true;
+      }
+      mExpanded++;
+      mGraph.expand(entry.v, *this);
+    }
+    return mTarget == NO_VERTEX;
+  }
+
+  //called by the graph for every neighbour of an expanded vertex
+  void relax(unsigned int from, unsigned int to, float length)
+  {
+    CostT g = mState.getG(from) + CostTraits<CostT>::fromDistance(length);
+    listType e_list = mState.getList(to);
+    if (e_list == listState::Unvisited || g < mState.getG(to))
+    {
+      mState.setG(to, g);
+      mState.setParent(to, from);
+      mState.setList(to, listState::Open);
+      push(to, g);
+    }
+  }
+
+  bool isReached(unsigned int v) const
+  {
+    return mState.getList(v) != listState::Unvisited;
+  }
+
+  CostT getCost(unsigned int v) const
+  {
+    if (!isReached(v))
+    {
+      return CostTraits<CostT>::infinity();
+    }
+    return mState.getG(v);
+  }
+
+  unsigned int getParent(unsigned int v) const
+  {
+    return mState.getParent(v);
+  }
+
+  //the path from target back to the source, the caller's vector is reused
+  void getPath(unsigned int target, std::vector<unsigned int> &v_path) const
+  {
+    v_path.clear();
+    for (unsigned int v = target; v != NO_VERTEX; v = mState.getParent(v))
+    {
+      v_path.push_back(v);
+    }
+  }
+
+  //number of vertices expanded by the last query
+  unsigned int getExpanded() const
+  {
+    return mExpanded;
+  }
+
+  const GraphT& getGraph() const
+  {
+    return mGraph;
+  }
+
+private:
+  struct HeapEntry
+  {
+    CostT f;
+    CostT g;
+    unsigned int v;
+  };
+  //std heap functions build a max heap, the comparison is reversed so the top is the lowest f. ties prefer the deepest vertex
+  struct HeapCompare
+  {
+    bool operator()(const HeapEntry &a, const HeapEntry &b) const
+    {
+      return a.f > b.f || (a.f == b.f && a.g < b.g);
+    }
+  };
+
+  void push(unsigned int v, CostT g)
+  {
+    HeapEntry entry;
+    entry.g = g;
+    entry.f = g;
+    if (mTarget != NO_VERTEX)
+    {
+      entry.f += CostTraits<CostT>::fromEstimate(mHeuristic(mGraph, v, mTarget));
+    }
+    entry.v = v;
+    mState.setF(v, entry.f);
+    v_mHeap.push_back(entry);
+    std::push_heap(v_mHeap.begin(), v_mHeap.end(), HeapCompare());
+  }
+
+  const GraphT &mGraph;
+  HeuristicT mHeuristic;
+  BasicSearchState<CostT> mState;
+  std::vector<HeapEntry> v_mHeap; //open list
+  unsigned int mTarget;
+  unsigned int mExpanded;
+};
+
+/*
+ * ALT heuristic (A*, landmarks, triangle inequality). the distances from a few landmarks to every vertex
+ * are computed once per graph; the estimate is the largest |d(L, t) - d(L, v)| over the landmarks.
+ * admissible and consistent on undirected graphs, usually much tighter than the straight line distance.
+ * copies share the landmark distances, so it can be passed to a search by value.
+ */
+template<class GraphT>
+class ALTHeuristic
+{
+public:
+  ALTHeuristic()
+  {
+    mVertices = 0;
+  }
+
+  /*
+   * select landmarkCount landmarks by farthest point selection, starting from vertex first,
+   * and compute their distance to every vertex
+   */
+  void build(const GraphT &graph, unsigned int landmarkCount, unsigned int first)
+  {
+    mVertices = graph.size();
+    p_mLandmarks.reset(new std::vector<unsigned int>());
+    p_mDist.reset(new std::vector<float>());
+    std::vector<unsigned int> &v_mLandmarks = *p_mLandmarks;
+    std::vector<float> &v_mDist = *p_mDist;
+    v_mDist.reserve(landmarkCount * mVertices);
+    AStarSearch<GraphT, ZeroHeuristic, float> dijkstra(graph);
+    std::vector<float> v_minDist(mVertices, std::numeric_limits<float>::max());
+
+    unsigned int landmark = first;
+    for (unsigned int l = 0; l < landmarkCount && landmark != NO_VERTEX; l++)
+    {
+      v_mLandmarks.push_back(landmark);
+      dijkstra.search(landmark, NO_VERTEX);
+      unsigned int farthest = NO_VERTEX;
+      float farthestDist = 0;
+      for (unsigned int v = 0; v < mVertices; v++)
+      {
+        float d = dijkstra.isReached(v) ? dijkstra.getCost(v) : std::numeric_limits<float>::max();
+        v_mDist.push_back(d);
+        v_minDist[v] = std::min(v_minDist[v], d);
+        if (dijkstra.isReached(v) && v_minDist[v] > farthestDist)
+        {
+          farthestDist = v_minDist[v];
+          farthest = v;
+        }
+      }
+      landmark = farthest;
+    }
+  }
+
+  template<class G>
+  float operator()(const G &/*graph*/, unsigned int v, unsigned int t) const
+  {
+    if (!p_mDist)
+    {
+      return 0;
+    }
+    const std::vector<unsigned int> &v_mLandmarks = *p_mLandmarks;
+    const std::vector<float> &v_mDist = *p_mDist;
+    float best = 0;
+    for (unsigned int l = 0; l < v_mLandmarks.size(); l++)
+    {
+      float dv = v_mDist[l * mVertices + v];
+      float dt = v_mDist[l * mVertices + t];
+      if (dv == std::numeric_limits<float>::max() || dt == std::numeric_limits<float>::max())
+      {
+        continue; //vertex not connected to this landmark
+      }
+      float d = dv > dt ? dv - dt : dt - dv;
+      if (d > best)
+      {
+        best = d;
+      }
+    }
+    return best;
+  }
+
+  unsigned int getLandmarkCount() const
+  {
+    return p_mLandmarks ? p_mLandmarks->size() : 0;
+  }
+
+private:
+  boost::shared_ptr<std::vector<unsigned int> > p_mLandmarks;
+  boost::shared_ptr<std::vector<float> > p_mDist; //distance from landmark l to vertex v at l * mVertices + v
+  unsigned int mVertices;
+};
+
+#endif /* SEARCH_CORE_H_ */
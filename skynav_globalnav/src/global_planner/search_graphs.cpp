@@ -0,0 +1,182 @@
+/*
+ * search_graphs.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "search_graphs.h"
+#include <limits>
+#include <cstring>
+#include <boost/thread/thread.hpp>
+#include <boost/bind.hpp>
+
+const double RoadmapGraph::ALL_EDGES = std::numeric_limits<double>::max();
+
+RoadmapGraph::RoadmapGraph(Graph* p_graph)
+{
+  this->p_mGraph = p_graph;
+  this->mNow = ALL_EDGES;
+}
+
+CsrGraph::CsrGraph()
+{
+}
+
+CsrGraph::CsrGraph(Graph* p_graph)
+{
+  build(p_graph);
+}
+
+//copy the adjacency of the roadmap into the compressed arrays
+void CsrGraph::build(Graph* p_graph)
+{
+  unsigned int nodeCount = p_graph->getNodeCount();
+  v_mOffsets.clear();
+  v_mTargets.clear();
+  v_mLengths.clear();
+  v_mX.resize(nodeCount);
+  v_mY.resize(nodeCount);
+  v_mOffsets.reserve(nodeCount + 1);
+  v_mTargets.reserve(2 * p_graph->getEdgeCount());
+  v_mLengths.reserve(2 * p_graph->getEdgeCount());
+
+  for (unsigned int v = 0; v < nodeCount; v++)
+  {
+    Node* p_node = p_graph->getNode(v);
+    v_mX[v] = p_node->getXpos();
+    v_mY[v] = p_node->getYpos();
+    v_mOffsets.push_back(v_mTargets.size());
+
+    const std::vector<Adjacent> &v_adjacencyList = p_node->getAdjacencyList();
+    for (std::vector<Adjacent>::const_iterator it = v_adjacencyList.begin(); it != v_adjacencyList.end(); it++)
+    {
+      v_mTargets.push_back((*it).node);
+      v_mLengths.push_back(p_graph->getEdge((*it).edge)->getCost());
+    }
+  }
+  v_mOffsets.push_back(v_mTargets.size());
+}
+
+GridGraph::GridGraph()
+{
+  this->mWidth = 0;
+  this->mHeight = 0;
+}
+
+GridGraph::GridGraph(MapData* p_mapData, unsigned int inflation, unsigned int threads)
+{
+  build(p_mapData, inflation, threads);
+}
+
+/*
+ * copy the occupancy of the map into a flat array of blocked flags, cells within inflation of an object are blocked
+ * too. the grid is built in bands of one tile row, spread over threads (0 uses one thread per core). a band copies
+ * its tiles and then blocks the discs around the objects of its own rows and of the rows within inflation of it,
+ * clipped to its own rows: the bands only read the map and write their own rows, so they need no locking
+ */
+void GridGraph::build(MapData* p_mapData, unsigned int inflation, unsigned int threads)
+{
+  this->mWidth = p_mapData->getXdimension();
+  this->mHeight = p_mapData->getYdimension();
+  v_mBlocked.resize(mWidth * mHeight);
+  unsigned int bands = (mHeight + TILE_MASK) >> TILE_SHIFT;
+  threads = std::min(threads ? threads : std::max(1u, boost::thread::hardware_concurrency()), bands);
+  if (threads == 0)
+  {
+    return;
+  }
+
+  //the half width of the disc in the row dy away
+  std::vector<unsigned int> v_halfWidths(2 * inflation + 1);
+  for (int dy = -int(inflation); dy <= int(inflation); dy++)
+  {
+    unsigned int w = 0;
+    while ((w + 1) * (w + 1) + dy * dy <= inflation * inflation)
+    {
+      w++;
+    }
+    v_halfWidths[dy + inflation] = w;
+  }
+
+  const TiledGrid<unsigned char>* p_cells = &p_mapData->getMapData();
+  boost::thread_group workers;
+  for (unsigned int i = 1; i < threads; i++)
+  {
+    workers.create_thread(
+        boost::bind(&GridGraph::buildBands, this, p_cells, &v_halfWidths[0], inflation, i, threads));
+  }
+  buildBands(p_cells, &v_halfWidths[0], inflation, 0, threads);
+  workers.join_all();
+}
+
+//build the bands first, first + step, ... of the grid
+void GridGraph::buildBands(const TiledGrid<unsigned char>* p_cells, const unsigned int* p_halfWidths,
+                           unsigned int inflation, unsigned int first, unsigned int step)
+{
+  int radius = inflation;
+  for (unsigned int ty = first; ty << TILE_SHIFT < mHeight; ty += step)
+  {
+    unsigned int y0 = ty << TILE_SHIFT;
+    unsigned int y1 = std::min(mHeight, y0 + TILE_SIZE);
+    for (unsigned int tx = 0; tx << TILE_SHIFT < mWidth; tx++)
+    {
+      unsigned int x0 = tx << TILE_SHIFT;
+      unsigned int columns = std::min(mWidth - x0, TILE_SIZE);
+      const unsigned char* p_tile = p_cells->getTile(tx, ty);
+      for (unsigned int y = y0; y < y1; y++)
+      {
+        unsigned char* p_row = &v_mBlocked[y * mWidth + x0];
+        if (!p_tile)
+        {
+          memset(p_row, p_cells->getUniform(tx, ty) == spaceType::Object, columns);
+          continue;
+        }
+        const unsigned char* p_tileRow = p_tile + ((y - y0) << TILE_SHIFT);
+        for (unsigned int x = 0; x < columns; x++)
+        {
+          p_row[x] = p_tileRow[x] == spaceType::Object;
+        }
+      }
+    }
+    if (inflation == 0)
+    {
+      continue;
+    }
+
+    //the objects within inflation of the band, read from the map as the rows around it belong to other bands
+    int yFrom = std::max(0, int(y0) - radius);
+    int yTo = std::min(int(mHeight), int(y1) + radius);
+    for (unsigned int oy = yFrom >> TILE_SHIFT; int(oy << TILE_SHIFT) < yTo; oy++)
+    {
+      for (unsigned int tx = 0; tx << TILE_SHIFT < mWidth; tx++)
+      {
+        const unsigned char* p_tile = p_cells->getTile(tx, oy);
+        if (!p_tile && p_cells->getUniform(tx, oy) != spaceType::Object)
+        {
+          continue; //no objects in the tile
+        }
+        int x0 = tx << TILE_SHIFT;
+        int xEnd = std::min(int(mWidth), x0 + int(TILE_SIZE));
+        int yBegin = std::max(yFrom, int(oy << TILE_SHIFT));
+        int yEnd = std::min(yTo, int((oy + 1) << TILE_SHIFT));
+        for (int y = yBegin; y < yEnd; y++)
+        {
+          for (int x = x0; x < xEnd; x++)
+          {
+            if (p_tile && p_tile[((y & TILE_MASK) << TILE_SHIFT) | (x & TILE_MASK)] != spaceType::Object)
+            {
+              continue;
+            }
+            for (int dy = std::max(-radius, int(y0) - y); dy <= radius && y + dy < int(y1); dy++)
+            {
+              int w = p_halfWidths[dy + radius];
+              int left = std::max(0, x - w);
+              int right = std::min(int(mWidth) - 1, x + w);
+              memset(&v_mBlocked[(y + dy) * mWidth + left], 1, right - left + 1);
+            }
+          }
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,147 @@
+/*
+ * search_state.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef SEARCH_STATE_H_
+#define SEARCH_STATE_H_
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+
+#define NO_VERTEX 0xFFFFFFFFu //id used for "no node", for instance the parent of the start
+
+namespace listState
+{
+enum listType
+{
+  Unvisited, Open, Closed
+};
+}
+typedef listState::listType listType;
+
+/*
+ * the per query search data of the vertices in a graph (g, f, parent and open/closed list membership).
+ * the data is indexed by vertex id, so the graph itself does not change during a query
+ * and several queries can run on the same graph, each with its own search state.
+ *
+ * the arrays are reused between queries, reset() only increments a generation counter
+ * so a vertex that has not been touched in the current query reads as unvisited.
+ * CostT is the type in which path costs are accumulated.
+ */
+template<class CostT>
+class BasicSearchState
+{
+public:
+  BasicSearchState()
+  {
+    this->mGeneration = 0;
+  }
+  virtual ~BasicSearchState()
+  {
+  }
+
+  //prepare the state for a new query on a graph with vertexCount vertex ids.
+  //the arrays only grow, old data is invalidated by the generation counter
+  void reset(unsigned int vertexCount)
+  {
+    if (v_mGeneration.size() < vertexCount)
+    {
+      v_mGeneration.resize(vertexCount, 0);
+      v_mList.resize(vertexCount, listState::Unvisited);
+      v_mG.resize(vertexCount, 0);
+      v_mF.resize(vertexCount, 0);
+      v_mParent.resize(vertexCount, NO_VERTEX);
+    }
+    mGeneration++;
+    if (mGeneration == 0) //counter wrapped around, old stamps could become valid again
+    {
+      std::fill(v_mGeneration.begin(), v_mGeneration.end(), 0);
+      mGeneration = 1;
+    }
+  }
+
+  unsigned int size() const
+  {
+    return v_mGeneration.size();
+  }
+
+  listType getList(unsigned int id) const
+  {
+    if (v_mGeneration[id] != mGeneration)
+    {
+      return listState::Unvisited;
+    }
+    return listType(v_mList[id]);
+  }
+  void setList(unsigned int id, listType e_list)
+  {
+    touch(id);
+    v_mList[id] = e_list;
+  }
+  CostT getG(unsigned int id) const
+  {
+    if (v_mGeneration[id] != mGeneration)
+    {
+      return 0;
+    }
+    return v_mG[id];
+  }
+  void setG(unsigned int id, CostT g)
+  {
+    touch(id);
+    v_mG[id] = g;
+  }
+  CostT getF(unsigned int id) const
+  {
+    if (v_mGeneration[id] != mGeneration)
+    {
+      return 0;
+    }
+    return v_mF[id];
+  }
+  void setF(unsigned int id, CostT f)
+  {
+    touch(id);
+    v_mF[id] = f;
+  }
+  unsigned int getParent(unsigned int id) const
+  {
+    if (v_mGeneration[id] != mGeneration)
+    {
+      return NO_VERTEX;
+    }
+    return v_mParent[id];
+  }
+  void setParent(unsigned int id, unsigned int parent)
+  {
+    touch(id);
+    v_mParent[id] = parent;
+  }
+
+private:
+  //reset the data of a vertex the first time it is written in this query
+  void touch(unsigned int id)
+  {
+    if (v_mGeneration[id] != mGeneration)
+    {
+      v_mGeneration[id] = mGeneration;
+      v_mList[id] = listState::Unvisited;
+      v_mG[id] = 0;
+      v_mF[id] = 0;
+      v_mParent[id] = NO_VERTEX;
+    }
+  }
+
+  std::vector<unsigned int> v_mGeneration; //generation in which the vertex data was last written
+  std::vector<unsigned char> v_mList; //listType of the vertex
+  std::vector<CostT> v_mG; //cost from start to vertex
+  std::vector<CostT> v_mF; //g + estimated cost from vertex to target
+  std::vector<unsigned int> v_mParent; //the vertex this vertex was reached from
+  unsigned int mGeneration; //the current query
+};
+
+typedef BasicSearchState<float> SearchState;
+
+#endif /* SEARCH_STATE_H_ */
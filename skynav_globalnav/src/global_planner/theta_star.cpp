@@ -0,0 +1,228 @@
+/*
+ * theta_star.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "theta_star.h"
+
+ThetaStar::ThetaStar(const GridGraph &grid) :
+    mGrid(grid)
+{
+  this->mTarget = NO_VERTEX;
+  this->mLazy = false;
+  this->mCost = 0;
+  this->mExpanded = 0;
+  this->mSightChecks = 0;
+}
+
+ThetaStar::~ThetaStar()
+{
+}
+
+const std::vector<Point>& ThetaStar::getPath() const
+{
+  return v_mPath;
+}
+
+//length of the last path
+float ThetaStar::getCost() const
+{
+  return mCost;
+}
+
+unsigned int ThetaStar::getExpanded() const
+{
+  return mExpanded;
+}
+
+//number of line of sight checks in the last search
+unsigned int ThetaStar::getSightChecks() const
+{
+  return mSightChecks;
+}
+
+float ThetaStar::distance(unsigned int a, unsigned int b) const
+{
+  float dx = float(mGrid.getX(a)) - float(mGrid.getX(b));
+  float dy = float(mGrid.getY(a)) - float(mGrid.getY(b));
+  return sqrtf(dx * dx + dy * dy);
+}
+
+/*
+ * search an any-angle path between two cells, with Lazy Theta* when lazy is set.
+ * on success getPath() holds the waypoints from start to target
+ */
+bool ThetaStar::search(unsigned int xStart, unsigned int yStart, unsigned int xTarget, unsigned int yTarget,
+                       bool lazy)
+{
+  v_mPath.clear();
+  mCost = 0;
+  mExpanded = 0;
+  mSightChecks = 0;
+  if (xStart >= mGrid.getWidth() || yStart >= mGrid.getHeight() || xTarget >= mGrid.getWidth()
+      || yTarget >= mGrid.getHeight())
+  {
+    return false;
+  }
+  unsigned int start = mGrid.getVertex(xStart, yStart);
+  mTarget = mGrid.getVertex(xTarget, yTarget);
+  if (mGrid.isBlocked(start) || mGrid.isBlocked(mTarget))
+  {
+    return false;
+  }
+  mLazy = lazy;
+  mState.reset(mGrid.size());
+  v_mHeap.clear();
+  update(start, start, 0); //the start is its own parent
+
+  while (!v_mHeap.empty())
+  {
+    std::pop_heap(v_mHeap.begin(), v_mHeap.end(), HeapCompare());
+    HeapEntry entry = v_mHeap.back();
+    v_mHeap.pop_back();
+    unsigned int v = entry.v;
+    if (mState.getList(v) == listState::Closed || entry.g != mState.getG(v))
+    {
+      continue; //outdated heap entry
+    }
+
+    if (mLazy && !lineOfSight(mState.getParent(v), v))
+    {
+      //the assumed line of sight does not exist, take the best closed neighbour as parent instead
+      ClosedNeighbour neighbour;
+      neighbour.p_mSearch = this;
+      neighbour.mBest = NO_VERTEX;
+      neighbour.mBestG = CostTraits<float>::infinity();
+      mGrid.expand(v, neighbour);
+      mState.setParent(v, neighbour.mBest);
+      mState.setG(v, neighbour.mBestG);
+    }
+    mState.setList(v, listState::Closed);
+    if (v == mTarget)
+    {
+      break;
+    }
+    mExpanded++;
+    mGrid.expand(v, *this);
+  }
+  if (mState.getList(mTarget) != listState::Closed)
+  {
+    return false;
+  }
+
+  mCost = mState.getG(mTarget);
+  for (unsigned int v = mTarget;; v = mState.getParent(v))
+  {
+    v_mPath.push_back(Point(mGrid.getX(v), mGrid.getY(v)));
+    if (mState.getParent(v) == v)
+    {
+      break;
+    }
+  }
+  std::reverse(v_mPath.begin(), v_mPath.end());
+  return true;
+}
+
+void ThetaStar::relax(unsigned int from, unsigned int to, float length)
+{
+  if (mState.getList(to) == listState::Closed)
+  {
+    return;
+  }
+  unsigned int parent = mState.getParent(from);
+  if (mLazy || lineOfSight(parent, to))
+  {
+    //path 2: straight from the parent of from
+    float g = mState.getG(parent) + distance(parent, to);
+    if (mState.getList(to) == listState::Unvisited || g < mState.getG(to))
+    {
+      update(to, parent, g);
+    }
+  }
+  else
+  {
+    //path 1: through from, as in A*
+    float g = mState.getG(from) + length;
+    if (mState.getList(to) == listState::Unvisited || g < mState.getG(to))
+    {
+      update(to, from, g);
+    }
+  }
+}
+
+void ThetaStar::ClosedNeighbour::relax(unsigned int /*from*/, unsigned int to, float length)
+{
+  const BasicSearchState<float> &state = p_mSearch->mState;
+  if (state.getList(to) == listState::Closed && state.getG(to) + length < mBestG)
+  {
+    mBest = to;
+    mBestG = state.getG(to) + length;
+  }
+}
+
+void ThetaStar::update(unsigned int v, unsigned int parent, float g)
+{
+  mState.setG(v, g);
+  mState.setParent(v, parent);
+  mState.setList(v, listState::Open);
+
+  HeapEntry entry;
+  entry.g = g;
+  entry.f = g + distance(v, mTarget) * HEURISTIC_TIE_BREAK;
+  entry.v = v;
+  v_mHeap.push_back(entry);
+  std::push_heap(v_mHeap.begin(), v_mHeap.end(), HeapCompare());
+}
+
+/*
+ * check the cells the straight line between the centres of two cells passes through. where the line passes
+ * exactly through the corner of a cell, both cells beside the corner must be free, like a diagonal step on the grid.
+ * walks the grid directly, without building the line
+ */
+bool ThetaStar::lineOfSight(unsigned int from, unsigned int to)
+{
+  mSightChecks++;
+  int x = mGrid.getX(from);
+  int y = mGrid.getY(from);
+  int x1 = mGrid.getX(to);
+  int y1 = mGrid.getY(to);
+  int dx = std::abs(x1 - x);
+  int dy = std::abs(y1 - y);
+  int sx = x1 > x ? 1 : -1;
+  int sy = y1 > y ? 1 : -1;
+  int error = dx - dy;
+  dx *= 2;
+  dy *= 2;
+
+  for (int n = (dx + dy) / 2; n > 0; n--)
+  {
+    if (error > 0)
+    {
+      x += sx;
+      error -= dy;
+    }
+    else if (error < 0)
+    {
+      y += sy;
+      error += dx;
+    }
+    else
+    {
+      //through a corner
+      if (mGrid.isBlocked(mGrid.getVertex(x + sx, y)) || mGrid.isBlocked(mGrid.getVertex(x, y + sy)))
+      {
+        return false;
+      }
+      x += sx;
+      y += sy;
+      error += dx - dy;
+      n--;
+    }
+    if (mGrid.isBlocked(mGrid.getVertex(x, y)))
+    {
+      return false;
+    }
+  }
+  return true;
+}
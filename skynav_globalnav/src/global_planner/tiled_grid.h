@@ -0,0 +1,257 @@
+/*
+ * tiled_grid.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef TILED_GRID_H_
+#define TILED_GRID_H_
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+
+#define TILE_SHIFT 6 //2^6 cells along the side of a tile
+#define TILE_SIZE (1u << TILE_SHIFT)
+#define TILE_MASK (TILE_SIZE - 1)
+#define TILE_CELLS (TILE_SIZE * TILE_SIZE)
+
+/*
+ * a grid of cells stored in square tiles, for maps that are mostly one value (free or unknown space).
+ * a tile whose cells all have the same value holds only that value, cells are allocated when one of them is set to
+ * another value. copies of a grid share their tiles, a shared tile is copied when it is written (copy-on-write).
+ *
+ * a tile is filled before it is put in place, so a cell read while another cell of its tile is set reads either
+ * the old value or the new one. sharing tiles is not locked: grids that share tiles are copied, written and
+ * destroyed by one thread at a time.
+ */
+template<class T>
+class TiledGrid
+{
+public:
+  TiledGrid()
+  {
+    mWidth = mHeight = mTilesX = mTilesY = 0;
+  }
+  TiledGrid(unsigned int width, unsigned int height, const T &value)
+  {
+    mWidth = mHeight = mTilesX = mTilesY = 0;
+    resize(width, height, value);
+  }
+  TiledGrid(const TiledGrid &other)
+  {
+    share(other);
+  }
+  TiledGrid& operator=(const TiledGrid &other)
+  {
+    if (this != &other)
+    {
+      release();
+      share(other);
+    }
+    return *this;
+  }
+  virtual ~TiledGrid()
+  {
+    release();
+  }
+
+  //drop all cells, the grid becomes width by height cells of value
+  void resize(unsigned int width, unsigned int height, const T &value)
+  {
+    release();
+    mWidth = width;
+    mHeight = height;
+    mTilesX = (width + TILE_MASK) >> TILE_SHIFT;
+    mTilesY = (height + TILE_MASK) >> TILE_SHIFT;
+    v_mTiles.assign(mTilesX * mTilesY, (Tile*) NULL);
+    v_mUniform.assign(mTilesX * mTilesY, value);
+  }
+
+  const T& get(unsigned int x, unsigned int y) const
+  {
+    unsigned int t = (y >> TILE_SHIFT) * mTilesX + (x >> TILE_SHIFT);
+    const Tile* p_tile = v_mTiles[t];
+    return p_tile ? p_tile->mCells[((y & TILE_MASK) << TILE_SHIFT) | (x & TILE_MASK)] : v_mUniform[t];
+  }
+
+  void set(unsigned int x, unsigned int y, const T &value)
+  {
+    unsigned int t = (y >> TILE_SHIFT) * mTilesX + (x >> TILE_SHIFT);
+    Tile* p_tile = v_mTiles[t];
+    if (!p_tile)
+    {
+      if (v_mUniform[t] == value)
+      {
+        return;
+      }
+      p_tile = materialise(t);
+    }
+    else if (p_tile->mRefs > 1)
+    {
+      p_tile = unshare(t);
+    }
+    p_tile->mCells[((y & TILE_MASK) << TILE_SHIFT) | (x & TILE_MASK)] = value;
+  }
+
+  //set all TILE_CELLS cells of a tile, row by row. a tile of one value only keeps the value
+  void setTile(unsigned int tx, unsigned int ty, const T* p_cells)
+  {
+    unsigned int i = 1;
+    while (i < TILE_CELLS && p_cells[i] == p_cells[0])
+    {
+      i++;
+    }
+    if (i == TILE_CELLS)
+    {
+      setUniform(tx, ty, p_cells[0]);
+      return;
+    }
+    unsigned int t = ty * mTilesX + tx;
+    Tile* p_tile = new Tile;
+    std::copy(p_cells, p_cells + TILE_CELLS, p_tile->mCells);
+    p_tile->mRefs = 1;
+    Tile* p_old = v_mTiles[t];
+    v_mTiles[t] = p_tile;
+    releaseTile(p_old);
+  }
+
+  //set all cells of a tile to value
+  void setUniform(unsigned int tx, unsigned int ty, const T &value)
+  {
+    unsigned int t = ty * mTilesX + tx;
+    v_mUniform[t] = value;
+    Tile* p_old = v_mTiles[t];
+    v_mTiles[t] = NULL;
+    releaseTile(p_old);
+  }
+
+  //the cells of a tile row by row, NULL when they all have the value getUniform()
+  const T* getTile(unsigned int tx, unsigned int ty) const
+  {
+    const Tile* p_tile = v_mTiles[ty * mTilesX + tx];
+    return p_tile ? p_tile->mCells : NULL;
+  }
+
+  const T& getUniform(unsigned int tx, unsigned int ty) const
+  {
+    return v_mUniform[ty * mTilesX + tx];
+  }
+
+  //let go of the cells of tiles that have come to hold one value
+  void compact()
+  {
+    for (unsigned int t = 0; t < v_mTiles.size(); t++)
+    {
+      if (v_mTiles[t])
+      {
+        const T* p_cells = v_mTiles[t]->mCells;
+        unsigned int i = 1;
+        while (i < TILE_CELLS && p_cells[i] == p_cells[0])
+        {
+          i++;
+        }
+        if (i == TILE_CELLS)
+        {
+          setUniform(t % mTilesX, t / mTilesX, p_cells[0]);
+        }
+      }
+    }
+  }
+
+  unsigned int getWidth() const
+  {
+    return mWidth;
+  }
+  unsigned int getHeight() const
+  {
+    return mHeight;
+  }
+  unsigned int getTilesX() const
+  {
+    return mTilesX;
+  }
+  unsigned int getTilesY() const
+  {
+    return mTilesY;
+  }
+
+  //number of tiles that hold their cells
+  unsigned int getAllocatedTiles() const
+  {
+    unsigned int count = 0;
+    for (unsigned int t = 0; t < v_mTiles.size(); t++)
+    {
+      count += v_mTiles[t] != NULL;
+    }
+    return count;
+  }
+
+private:
+  struct Tile
+  {
+    T mCells[TILE_CELLS];
+    unsigned int mRefs; //grids sharing the tile
+  };
+
+  Tile* materialise(unsigned int t)
+  {
+    Tile* p_tile = new Tile;
+    std::fill(p_tile->mCells, p_tile->mCells + TILE_CELLS, v_mUniform[t]);
+    p_tile->mRefs = 1;
+    v_mTiles[t] = p_tile;
+    return p_tile;
+  }
+
+  Tile* unshare(unsigned int t)
+  {
+    Tile* p_tile = new Tile(*v_mTiles[t]);
+    p_tile->mRefs = 1;
+    v_mTiles[t]->mRefs--;
+    v_mTiles[t] = p_tile;
+    return p_tile;
+  }
+
+  static void releaseTile(Tile* p_tile)
+  {
+    if (p_tile && --p_tile->mRefs == 0)
+    {
+      delete p_tile;
+    }
+  }
+
+  void release()
+  {
+    for (unsigned int t = 0; t < v_mTiles.size(); t++)
+    {
+      releaseTile(v_mTiles[t]);
+    }
+    v_mTiles.clear();
+    v_mUniform.clear();
+  }
+
+  void share(const TiledGrid &other)
+  {
+    mWidth = other.mWidth;
+    mHeight = other.mHeight;
+    mTilesX = other.mTilesX;
+    mTilesY = other.mTilesY;
+    v_mTiles = other.v_mTiles;
+    v_mUniform = other.v_mUniform;
+    for (unsigned int t = 0; t < v_mTiles.size(); t++)
+    {
+      if (v_mTiles[t])
+      {
+        v_mTiles[t]->mRefs++;
+      }
+    }
+  }
+
+  unsigned int mWidth;
+  unsigned int mHeight;
+  unsigned int mTilesX;
+  unsigned int mTilesY;
+  std::vector<Tile*> v_mTiles; //row by row, NULL for a tile of one value
+  std::vector<T> v_mUniform; //the value of every cell of a tile without cells
+};
+
+#endif /* TILED_GRID_H_ */
@@ -0,0 +1,181 @@
+/*
+ * tour.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "tour.h"
+#include <algorithm>
+
+#define TOUR_MIN_GAIN 1e-4f //smallest improvement for which a move is made, so rounding can not make moves cycle
+#define TOUR_MAX_SEGMENT 3 //longest segment moved by or-opt
+
+Tour::Tour(const std::vector<float> &v_costs, unsigned int stops)
+{
+  this->v_mCosts = v_costs;
+  this->mStops = stops;
+  for (unsigned int i = 0; i < stops; i++)
+  {
+    v_mOrder.push_back(i);
+  }
+}
+
+Tour::~Tour()
+{
+}
+
+float Tour::cost(unsigned int a, unsigned int b) const
+{
+  return v_mCosts[a * mStops + b];
+}
+
+//from the start, always visit the nearest stop that has not been visited yet
+void Tour::nearestNeighbour()
+{
+  std::vector<bool> v_visited(mStops, false);
+  v_mOrder.clear();
+  v_mOrder.push_back(0);
+  v_visited[0] = true;
+  for (unsigned int i = 1; i < mStops; i++)
+  {
+    unsigned int current = v_mOrder.back();
+    unsigned int nearest = 0;
+    for (unsigned int s = 1; s < mStops; s++)
+    {
+      if (!v_visited[s] && (nearest == 0 || cost(current, s) < cost(current, nearest)))
+      {
+        nearest = s;
+      }
+    }
+    v_visited[nearest] = true;
+    v_mOrder.push_back(nearest);
+  }
+}
+
+//apply 2-opt and or-opt moves until no move shortens the tour
+void Tour::improve()
+{
+  bool improved = true;
+  while (improved)
+  {
+    improved = twoOpt();
+    improved = orOpt() || improved;
+  }
+}
+
+/*
+ * reverse the part of the tour between positions i and j when that is shorter.
+ * the tour is open, so reversing up to the last stop only changes the edge into position i
+ */
+bool Tour::twoOpt()
+{
+  bool improved = false;
+  unsigned int n = v_mOrder.size();
+  for (unsigned int i = 1; i + 1 < n; i++)
+  {
+    for (unsigned int j = i + 1; j < n; j++)
+    {
+      float delta = cost(v_mOrder[i - 1], v_mOrder[j]) - cost(v_mOrder[i - 1], v_mOrder[i]);
+      if (j + 1 < n)
+      {
+        delta += cost(v_mOrder[i], v_mOrder[j + 1]) - cost(v_mOrder[j], v_mOrder[j + 1]);
+      }
+      if (delta < -TOUR_MIN_GAIN)
+      {
+        std::reverse(v_mOrder.begin() + i, v_mOrder.begin() + j + 1);
+        improved = true;
+      }
+    }
+  }
+  return improved;
+}
+
+/*
+ * move a segment of up to TOUR_MAX_SEGMENT stops, possibly reversed, to another place in the tour
+ * when that is shorter
+ */
+bool Tour::orOpt()
+{
+  bool improved = false;
+  for (unsigned int length = 1; length <= TOUR_MAX_SEGMENT; length++)
+  {
+    for (unsigned int i = 1; i + length <= v_mOrder.size(); i++)
+    {
+      unsigned int n = v_mOrder.size();
+      unsigned int first = v_mOrder[i];
+      unsigned int last = v_mOrder[i + length - 1];
+      unsigned int prev = v_mOrder[i - 1];
+      //gain of taking the segment out
+      float removeGain = cost(prev, first);
+      if (i + length < n)
+      {
+        removeGain += cost(last, v_mOrder[i + length]) - cost(prev, v_mOrder[i + length]);
+      }
+
+      //best place to put it back: after position p, outside the segment
+      float bestDelta = -TOUR_MIN_GAIN;
+      int bestPos = -1;
+      bool bestReversed = false;
+      for (unsigned int p = 0; p < n; p++)
+      {
+        if (p + 1 >= i && p < i + length)
+        {
+          continue; //in the segment or directly before it, where it is now
+        }
+        unsigned int a = v_mOrder[p];
+        for (unsigned int reversed = 0; reversed < 2; reversed++)
+        {
+          unsigned int in = reversed ? last : first;
+          unsigned int out = reversed ? first : last;
+          float insertCost = cost(a, in);
+          if (p + 1 < n)
+          {
+            insertCost += cost(out, v_mOrder[p + 1]) - cost(a, v_mOrder[p + 1]);
+          }
+          if (insertCost - removeGain < bestDelta)
+          {
+            bestDelta = insertCost - removeGain;
+            bestPos = p;
+            bestReversed = reversed;
+          }
+        }
+      }
+      if (bestPos < 0)
+      {
+        continue;
+      }
+
+      std::vector<unsigned int> v_segment(v_mOrder.begin() + i, v_mOrder.begin() + i + length);
+      if (bestReversed)
+      {
+        std::reverse(v_segment.begin(), v_segment.end());
+      }
+      v_mOrder.erase(v_mOrder.begin() + i, v_mOrder.begin() + i + length);
+      unsigned int insertAt = bestPos < int(i) ? bestPos + 1 : bestPos + 1 - length;
+      v_mOrder.insert(v_mOrder.begin() + insertAt, v_segment.begin(), v_segment.end());
+      improved = true;
+    }
+  }
+  return improved;
+}
+
+const std::vector<unsigned int>& Tour::getOrder() const
+{
+  return v_mOrder;
+}
+
+void Tour::setOrder(const std::vector<unsigned int> &v_order)
+{
+  this->v_mOrder = v_order;
+}
+
+//total cost of the tour in the current order
+float Tour::getCost() const
+{
+  float total = 0;
+  for (unsigned int i = 1; i < v_mOrder.size(); i++)
+  {
+    total += cost(v_mOrder[i - 1], v_mOrder[i]);
+  }
+  return total;
+}
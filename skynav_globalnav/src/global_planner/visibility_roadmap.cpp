@@ -0,0 +1,269 @@
+/*
+ * visibility_roadmap.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "visibility_roadmap.h"
+#include "polyline.h"
+#include "theta_star.h"
+#include <cmath>
+
+/*
+ * an outline runs along the boundaries between cells, from corner to corner, with the object on its left.
+ * directions are east, south, west, north (y points down). for a step in a direction from corner (X, Y),
+ * the cell on its left is (X + LEFT_X, Y + LEFT_Y), the cell on its right (X + RIGHT_X, Y + RIGHT_Y)
+ */
+static const int STEP_X[4] = {1, 0, -1, 0};
+static const int STEP_Y[4] = {0, 1, 0, -1};
+static const int LEFT_X[4] = {0, 0, -1, -1};
+static const int LEFT_Y[4] = {-1, 0, 0, -1};
+static const int RIGHT_X[4] = {0, -1, -1, 0};
+static const int RIGHT_Y[4] = {0, 0, -1, -1};
+
+VisibilityRoadmap::VisibilityRoadmap(unsigned int inflation)
+{
+  this->mInflation = inflation;
+}
+
+VisibilityRoadmap::~VisibilityRoadmap()
+{
+}
+
+const std::vector<Point>& VisibilityRoadmap::getNodes() const
+{
+  return v_mNodes;
+}
+
+const std::vector<std::pair<unsigned int, unsigned int> >& VisibilityRoadmap::getEdges() const
+{
+  return v_mEdges;
+}
+
+const std::vector<std::vector<Point> >& VisibilityRoadmap::getPolygons() const
+{
+  return v_mPolygons;
+}
+
+//cells outside the map count as objects
+bool VisibilityRoadmap::isFree(int x, int y) const
+{
+  return x >= 0 && y >= 0 && x < int(mGrid.getWidth()) && y < int(mGrid.getHeight())
+      && !mGrid.isBlocked(mGrid.getVertex(x, y));
+}
+
+void VisibilityRoadmap::build(MapData* p_mapData)
+{
+  mGrid.build(p_mapData, mInflation);
+  v_mCorners.clear();
+  v_mPolygons.clear();
+  v_mNodes.clear();
+  v_mEdges.clear();
+  ThetaStar sight(mGrid);
+  traceContours(sight);
+  connectCorners(sight);
+}
+
+//trace every outline once, starting at the first free cell (in map order) next to it
+void VisibilityRoadmap::traceContours(ThetaStar &sight)
+{
+  v_mTraced.assign(mGrid.size(), 0);
+  for (unsigned int y = 0; y < mGrid.getHeight(); y++)
+  {
+    for (unsigned int x = 0; x < mGrid.getWidth(); x++)
+    {
+      if (!isFree(x, y))
+      {
+        continue;
+      }
+      for (unsigned int d = 0; d < 4; d++)
+      {
+        //the step in direction d that has this cell on its right, and the object on its left
+        int startX = int(x) - RIGHT_X[d];
+        int startY = int(y) - RIGHT_Y[d];
+        if (!(v_mTraced[mGrid.getVertex(x, y)] & (1 << d)) && !isFree(startX + LEFT_X[d], startY + LEFT_Y[d]))
+        {
+          traceContour(sight, startX, startY, d);
+        }
+      }
+    }
+  }
+}
+
+/*
+ * follow the outline of an object, keeping the object on the left, until the first step comes round again.
+ * objects that only touch at a corner are followed as separate objects, as a line can pass between them.
+ * the corners where the outline turns are simplified to a polygon. when that cuts off cells along a side, so that
+ * the corners at its ends do not see each other, the outline is simplified again with half the tolerance
+ */
+void VisibilityRoadmap::traceContour(ThetaStar &sight, unsigned int x, unsigned int y, unsigned int direction)
+{
+  v_mContour.clear();
+  int cornerX = x;
+  int cornerY = y;
+  unsigned int d = direction;
+  do
+  {
+    v_mTraced[mGrid.getVertex(cornerX + RIGHT_X[d], cornerY + RIGHT_Y[d])] |= 1 << d;
+    cornerX += STEP_X[d];
+    cornerY += STEP_Y[d];
+    unsigned int next;
+    if (isFree(cornerX + LEFT_X[d], cornerY + LEFT_Y[d]))
+    {
+      next = (d + 3) % 4; //the object ends, turn left around it
+    }
+    else if (isFree(cornerX + RIGHT_X[d], cornerY + RIGHT_Y[d]))
+    {
+      next = d;
+    }
+    else
+    {
+      next = (d + 1) % 4; //the object continues ahead, turn right along it
+    }
+    if (next != d)
+    {
+      v_mContour.push_back(Point(cornerX, cornerY));
+    }
+    d = next;
+  } while (cornerX != int(x) || cornerY != int(y) || d != direction);
+
+  //start the polygon at its top left corner, that is always a corner of the polygon
+  unsigned int topLeft = 0;
+  for (unsigned int i = 1; i < v_mContour.size(); i++)
+  {
+    if (v_mContour[i].mYpos < v_mContour[topLeft].mYpos
+        || (v_mContour[i].mYpos == v_mContour[topLeft].mYpos && v_mContour[i].mXpos < v_mContour[topLeft].mXpos))
+    {
+      topLeft = i;
+    }
+  }
+  std::rotate(v_mContour.begin(), v_mContour.begin() + topLeft, v_mContour.end());
+  v_mContour.push_back(v_mContour.front());
+  float tolerance = VISIBILITY_TOLERANCE;
+  unsigned int first = v_mCorners.size();
+  while (true)
+  {
+    simplifyPolyline(v_mContour, tolerance, v_mPolygon);
+    v_mPolygon.pop_back();
+    addCorners(v_mPolygon);
+    if (tolerance == 0 || seeAlongSides(sight, first, v_mPolygon.size()))
+    {
+      break;
+    }
+    v_mCorners.resize(first);
+    tolerance = tolerance > 0.1f ? tolerance / 2 : 0;
+  }
+  v_mPolygons.push_back(v_mPolygon);
+}
+
+//check that the corners from first on, which are on one polygon, see the corner at the other end of their side
+bool VisibilityRoadmap::seeAlongSides(ThetaStar &sight, unsigned int first, unsigned int polygonSize)
+{
+  for (unsigned int i = first; i < v_mCorners.size(); i++)
+  {
+    const Corner &corner = v_mCorners[i];
+    const Corner &next = v_mCorners[i + 1 < v_mCorners.size() ? i + 1 : first];
+    if (next.mIndex == (corner.mIndex + 1) % polygonSize && !sight.lineOfSight(corner.mCell, next.mCell))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+/*
+ * every convex corner of the polygon where the object has a single cell, with the three cells around the corner free,
+ * gives a node at the free cell diagonally opposite that object cell
+ */
+void VisibilityRoadmap::addCorners(const std::vector<Point> &v_polygon)
+{
+  unsigned int n = v_polygon.size();
+  for (unsigned int i = 0; i < n; i++)
+  {
+    const Point &previous = v_polygon[(i + n - 1) % n];
+    const Point &corner = v_polygon[i];
+    const Point &next = v_polygon[(i + 1) % n];
+    float inX = float(corner.mXpos) - float(previous.mXpos);
+    float inY = float(corner.mYpos) - float(previous.mYpos);
+    float outX = float(next.mXpos) - float(corner.mXpos);
+    float outY = float(next.mYpos) - float(corner.mYpos);
+    if (inX * outY - inY * outX >= 0)
+    {
+      continue; //the outline turns right or goes straight on: not a convex corner of the object
+    }
+
+    int blockedX = 0;
+    int blockedY = 0;
+    unsigned int blocked = 0;
+    for (int cy = int(corner.mYpos) - 1; cy <= int(corner.mYpos); cy++)
+    {
+      for (int cx = int(corner.mXpos) - 1; cx <= int(corner.mXpos); cx++)
+      {
+        if (!isFree(cx, cy))
+        {
+          blockedX = cx;
+          blockedY = cy;
+          blocked++;
+        }
+      }
+    }
+    if (blocked != 1)
+    {
+      continue;
+    }
+    Corner c;
+    c.mCell = mGrid.getVertex(2 * corner.mXpos - 1 - blockedX, 2 * corner.mYpos - 1 - blockedY);
+    c.mIndex = i;
+    c.mX = corner.mXpos;
+    c.mY = corner.mYpos;
+    c.mPreviousX = previous.mXpos;
+    c.mPreviousY = previous.mYpos;
+    c.mNextX = next.mXpos;
+    c.mNextY = next.mYpos;
+    v_mCorners.push_back(c);
+  }
+}
+
+/*
+ * a line from a corner in direction (dx, dy) can be part of a shortest path when the corners before and after it
+ * are on the same side of the line: the line touches the object instead of cutting past it
+ */
+bool VisibilityRoadmap::isTangent(const Corner &corner, float dx, float dy) const
+{
+  float previous = dx * (corner.mPreviousY - corner.mY) - dy * (corner.mPreviousX - corner.mX);
+  float next = dx * (corner.mNextY - corner.mY) - dy * (corner.mNextX - corner.mX);
+  return !((previous > 0 && next < 0) || (previous < 0 && next > 0));
+}
+
+//join the corners that see each other with tangent lines, through the inflated map
+void VisibilityRoadmap::connectCorners(ThetaStar &sight)
+{
+  //corners of different polygons can share a cell, they become one node
+  std::vector<int> v_nodeOfCell(mGrid.size(), -1);
+  std::vector<unsigned int> v_node(v_mCorners.size());
+  for (unsigned int i = 0; i < v_mCorners.size(); i++)
+  {
+    unsigned int cell = v_mCorners[i].mCell;
+    if (v_nodeOfCell[cell] < 0)
+    {
+      v_nodeOfCell[cell] = v_mNodes.size();
+      v_mNodes.push_back(Point(mGrid.getX(cell), mGrid.getY(cell)));
+    }
+    v_node[i] = v_nodeOfCell[cell];
+  }
+
+  for (unsigned int i = 0; i < v_mCorners.size(); i++)
+  {
+    const Corner &a = v_mCorners[i];
+    for (unsigned int j = i + 1; j < v_mCorners.size(); j++)
+    {
+      const Corner &b = v_mCorners[j];
+      float dx = b.mX - a.mX;
+      float dy = b.mY - a.mY;
+      if (v_node[i] != v_node[j] && isTangent(a, dx, dy) && isTangent(b, dx, dy) && sight.lineOfSight(a.mCell, b.mCell))
+      {
+        v_mEdges.push_back(std::make_pair(v_node[i], v_node[j]));
+      }
+    }
+  }
+}
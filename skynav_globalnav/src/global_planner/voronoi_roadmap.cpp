@@ -0,0 +1,502 @@
+/*
+ * voronoi_roadmap.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "voronoi_roadmap.h"
+#include "polyline.h"
+#include <cmath>
+
+//the 8 neighbours of a cell, clockwise from north
+static const int DIRECTION_X[8] = {0, 1, 1, 1, 0, -1, -1, -1};
+static const int DIRECTION_Y[8] = {-1, -1, 0, 1, 1, 1, 0, -1};
+
+VoronoiRoadmap::VoronoiRoadmap(unsigned int minClearance)
+{
+  this->mMinClearance = minClearance;
+  this->mWidth = 0;
+  this->mHeight = 0;
+}
+
+VoronoiRoadmap::~VoronoiRoadmap()
+{
+}
+
+const std::vector<Point>& VoronoiRoadmap::getNodes() const
+{
+  return v_mNodes;
+}
+
+const std::vector<std::pair<unsigned int, unsigned int> >& VoronoiRoadmap::getEdges() const
+{
+  return v_mEdges;
+}
+
+bool VoronoiRoadmap::isSkeleton(unsigned int x, unsigned int y) const
+{
+  return v_mSkeleton[(y + 1) * mWidth + x + 1] != 0;
+}
+
+//distance from a cell to the nearest object
+float VoronoiRoadmap::getClearance(unsigned int x, unsigned int y) const
+{
+  return sqrtf(float(distance2((y + 1) * mWidth + x + 1)));
+}
+
+unsigned int VoronoiRoadmap::neighbour(unsigned int cell, unsigned int direction) const
+{
+  return cell + DIRECTION_Y[direction] * int(mWidth) + DIRECTION_X[direction];
+}
+
+//squared distance from a cell to its nearest object
+int VoronoiRoadmap::distance2(unsigned int cell) const
+{
+  int dx = int(cell % mWidth) - v_mSite[cell] % int(mWidth);
+  int dy = int(cell / mWidth) - v_mSite[cell] / int(mWidth);
+  return dx * dx + dy * dy;
+}
+
+void VoronoiRoadmap::build(MapData* p_mapData)
+{
+  distanceTransform(p_mapData);
+  markSkeleton();
+  thin();
+  findNodes();
+  traceBranches();
+  pruneBranches();
+  createEdges(p_mapData);
+}
+
+//take the nearest object of a neighbour when it is nearer than the current one
+void VoronoiRoadmap::propagate(unsigned int cell, unsigned int neighbour)
+{
+  int site = v_mSite[neighbour];
+  if (site < 0)
+  {
+    return;
+  }
+  int dx = int(cell % mWidth) - site % int(mWidth);
+  int dy = int(cell / mWidth) - site / int(mWidth);
+  if (v_mSite[cell] < 0 || dx * dx + dy * dy < distance2(cell))
+  {
+    v_mSite[cell] = site;
+  }
+}
+
+/*
+ * nearest object cell of every cell, by passing the nearest objects of the neighbours on in a forward and
+ * a backward scan over the map (8SSEDT). nearly exact, and linear in the size of the map
+ */
+void VoronoiRoadmap::distanceTransform(MapData* p_mapData)
+{
+  mWidth = p_mapData->getXdimension() + 2;
+  mHeight = p_mapData->getYdimension() + 2;
+  v_mSite.assign(mWidth * mHeight, -1);
+  for (unsigned int y = 0; y < mHeight; y++)
+  {
+    for (unsigned int x = 0; x < mWidth; x++)
+    {
+      if (x == 0 || y == 0 || x == mWidth - 1 || y == mHeight - 1 || p_mapData->getCell(x - 1, y - 1) == spaceType::Object)
+      {
+        v_mSite[y * mWidth + x] = y * mWidth + x;
+      }
+    }
+  }
+
+  for (unsigned int y = 1; y < mHeight - 1; y++)
+  {
+    for (unsigned int x = 1; x < mWidth - 1; x++)
+    {
+      unsigned int cell = y * mWidth + x;
+      propagate(cell, cell - 1);
+      propagate(cell, cell - mWidth - 1);
+      propagate(cell, cell - mWidth);
+      propagate(cell, cell - mWidth + 1);
+    }
+    for (unsigned int x = mWidth - 2; x > 0; x--)
+    {
+      propagate(y * mWidth + x, y * mWidth + x + 1);
+    }
+  }
+  for (unsigned int y = mHeight - 2; y > 0; y--)
+  {
+    for (unsigned int x = mWidth - 2; x > 0; x--)
+    {
+      unsigned int cell = y * mWidth + x;
+      propagate(cell, cell + 1);
+      propagate(cell, cell + mWidth + 1);
+      propagate(cell, cell + mWidth);
+      propagate(cell, cell + mWidth - 1);
+    }
+    for (unsigned int x = 1; x < mWidth - 1; x++)
+    {
+      propagate(y * mWidth + x, y * mWidth + x - 1);
+    }
+  }
+}
+
+/*
+ * a cell is on the diagram when a neighbouring cell has its nearest object in another direction:
+ * the two objects are further apart than the clearance, so they are not two cells of one straight wall
+ */
+void VoronoiRoadmap::markSkeleton()
+{
+  int minClearance2 = mMinClearance * mMinClearance;
+  v_mSkeleton.assign(mWidth * mHeight, 0);
+  for (unsigned int y = 1; y < mHeight - 1; y++)
+  {
+    for (unsigned int x = 1; x < mWidth - 1; x++)
+    {
+      unsigned int cell = y * mWidth + x;
+      int clearance2 = distance2(cell);
+      if (clearance2 == 0 || clearance2 < minClearance2)
+      {
+        continue;
+      }
+      unsigned int v_others[2] = {cell + 1, cell + mWidth};
+      for (unsigned int i = 0; i < 2; i++)
+      {
+        unsigned int other = v_others[i];
+        int otherClearance2 = distance2(other);
+        if (otherClearance2 == 0 || otherClearance2 < minClearance2)
+        {
+          continue;
+        }
+        int sx = v_mSite[cell] % int(mWidth) - v_mSite[other] % int(mWidth);
+        int sy = v_mSite[cell] / int(mWidth) - v_mSite[other] / int(mWidth);
+        int separation2 = sx * sx + sy * sy;
+        if (separation2 >= 4 && separation2 > std::max(clearance2, otherClearance2))
+        {
+          v_mSkeleton[cell] = 1;
+          v_mSkeleton[other] = 1;
+        }
+      }
+    }
+  }
+}
+
+/*
+ * thin the marked cells to lines of one cell wide, keeping them connected. this is Zhang-Suen, except that cells
+ * with two neighbours are kept: plain Zhang-Suen wears a diagonal line of two cells wide away from its ends.
+ * the corners of the staircases this leaves are removed afterwards
+ */
+void VoronoiRoadmap::thin()
+{
+  std::vector<unsigned int> v_remove;
+  bool changed = true;
+  while (changed)
+  {
+    changed = false;
+    for (unsigned int pass = 0; pass < 2; pass++)
+    {
+      v_remove.clear();
+      for (unsigned int y = 1; y < mHeight - 1; y++)
+      {
+        for (unsigned int x = 1; x < mWidth - 1; x++)
+        {
+          unsigned int cell = y * mWidth + x;
+          if (!v_mSkeleton[cell])
+          {
+            continue;
+          }
+          unsigned char p[8];
+          unsigned int count = 0;
+          unsigned int transitions = 0;
+          for (unsigned int d = 0; d < 8; d++)
+          {
+            p[d] = v_mSkeleton[neighbour(cell, d)];
+            count += p[d];
+          }
+          for (unsigned int d = 0; d < 8; d++)
+          {
+            transitions += (!p[d] && p[(d + 1) % 8]);
+          }
+          if (count < 3 || count > 6 || transitions != 1)
+          {
+            continue;
+          }
+          //p[0] north, p[2] east, p[4] south, p[6] west
+          if (pass == 0 && !(p[0] && p[2] && p[4]) && !(p[2] && p[4] && p[6]))
+          {
+            v_remove.push_back(cell);
+          }
+          else if (pass == 1 && !(p[0] && p[2] && p[6]) && !(p[0] && p[4] && p[6]))
+          {
+            v_remove.push_back(cell);
+          }
+        }
+      }
+      for (std::vector<unsigned int>::const_iterator it = v_remove.begin(); it != v_remove.end(); it++)
+      {
+        v_mSkeleton[*it] = 0;
+      }
+      changed = changed || !v_remove.empty();
+    }
+  }
+
+  for (unsigned int cell = 0; cell < v_mSkeleton.size(); cell++)
+  {
+    if (!v_mSkeleton[cell])
+    {
+      continue;
+    }
+    unsigned int count = 0;
+    unsigned int first = 0;
+    for (unsigned int d = 0; d < 8; d++)
+    {
+      if (v_mSkeleton[neighbour(cell, d)])
+      {
+        first = count == 0 ? d : first;
+        count++;
+      }
+    }
+    //a corner between a straight and a diagonal step: the neighbours are straight ones, a quarter turn apart
+    if (count == 2 && first % 2 == 0
+        && (v_mSkeleton[neighbour(cell, (first + 2) % 8)] || (first == 0 && v_mSkeleton[neighbour(cell, 6)])))
+    {
+      v_mSkeleton[cell] = 0;
+    }
+  }
+}
+
+/*
+ * the junctions and ends of the skeleton become nodes: the cells where the number of skeleton branches around
+ * the cell is not two. neighbouring junction cells form one node, at the cell with the largest clearance
+ */
+void VoronoiRoadmap::findNodes()
+{
+  v_mNodeOfCell.assign(mWidth * mHeight, -1);
+  v_mNodeCells.clear();
+  std::vector<unsigned char> v_isNodeCell(mWidth * mHeight, 0);
+  for (unsigned int cell = 0; cell < v_mSkeleton.size(); cell++)
+  {
+    if (!v_mSkeleton[cell])
+    {
+      continue;
+    }
+    unsigned int transitions = 0;
+    for (unsigned int d = 0; d < 8; d++)
+    {
+      transitions += (!v_mSkeleton[neighbour(cell, d)] && v_mSkeleton[neighbour(cell, (d + 1) % 8)]);
+    }
+    if (transitions == 0)
+    {
+      v_mSkeleton[cell] = 0; //a single cell, not part of any branch
+    }
+    else if (transitions != 2)
+    {
+      v_isNodeCell[cell] = 1;
+    }
+  }
+
+  std::vector<unsigned int> v_stack;
+  for (unsigned int cell = 0; cell < v_isNodeCell.size(); cell++)
+  {
+    if (!v_isNodeCell[cell] || v_mNodeOfCell[cell] >= 0)
+    {
+      continue;
+    }
+    int node = v_mNodeCells.size();
+    unsigned int best = cell;
+    v_stack.push_back(cell);
+    v_mNodeOfCell[cell] = node;
+    while (!v_stack.empty())
+    {
+      unsigned int current = v_stack.back();
+      v_stack.pop_back();
+      if (distance2(current) > distance2(best))
+      {
+        best = current;
+      }
+      for (unsigned int d = 0; d < 8; d++)
+      {
+        unsigned int other = neighbour(current, d);
+        if (v_isNodeCell[other] && v_mNodeOfCell[other] < 0)
+        {
+          v_mNodeOfCell[other] = node;
+          v_stack.push_back(other);
+        }
+      }
+    }
+    v_mNodeCells.push_back(best);
+  }
+}
+
+//follow every branch of the skeleton from node to node
+void VoronoiRoadmap::traceBranches()
+{
+  v_mTraced.assign(mWidth * mHeight, 0);
+  v_mBranches.clear();
+  for (unsigned int cell = 0; cell < v_mSkeleton.size(); cell++)
+  {
+    if (v_mNodeOfCell[cell] < 0)
+    {
+      continue;
+    }
+    for (unsigned int d = 0; d < 8; d++)
+    {
+      unsigned int other = neighbour(cell, d);
+      if (v_mSkeleton[other] && v_mNodeOfCell[other] < 0 && !v_mTraced[other])
+      {
+        traceBranch(v_mNodeOfCell[cell], other, cell);
+      }
+    }
+  }
+
+  //closed loops without a junction, around a single object: one of their cells becomes a node
+  for (unsigned int cell = 0; cell < v_mSkeleton.size(); cell++)
+  {
+    if (v_mSkeleton[cell] && v_mNodeOfCell[cell] < 0 && !v_mTraced[cell])
+    {
+      v_mNodeOfCell[cell] = v_mNodeCells.size();
+      v_mNodeCells.push_back(cell);
+      for (unsigned int d = 0; d < 8; d++)
+      {
+        unsigned int other = neighbour(cell, d);
+        if (v_mSkeleton[other] && v_mNodeOfCell[other] < 0 && !v_mTraced[other])
+        {
+          traceBranch(v_mNodeOfCell[cell], other, cell);
+        }
+      }
+    }
+  }
+}
+
+/*
+ * follow a branch from a node, starting at cell, until it reaches a node. prefers straight steps over diagonal ones,
+ * so a staircase is followed cell by cell. returns false for a branch that stops without reaching a node
+ */
+bool VoronoiRoadmap::traceBranch(unsigned int node, unsigned int cell, unsigned int first)
+{
+  Branch branch;
+  branch.mFrom = node;
+  branch.mCells.push_back(Point(v_mNodeCells[node] % mWidth - 1, v_mNodeCells[node] / mWidth - 1));
+  unsigned int previous = first;
+  while (true)
+  {
+    v_mTraced[cell] = 1;
+    branch.mCells.push_back(Point(cell % mWidth - 1, cell / mWidth - 1));
+
+    int next = -1;
+    int end = -1;
+    for (unsigned int d = 0; d < 8; d++)
+    {
+      unsigned int other = neighbour(cell, d);
+      if (!v_mSkeleton[other] || other == previous)
+      {
+        continue;
+      }
+      if (v_mNodeOfCell[other] >= 0)
+      {
+        //back at the start node only after going round a loop
+        if (v_mNodeOfCell[other] != int(node) || branch.mCells.size() > 3)
+        {
+          end = v_mNodeOfCell[other];
+        }
+      }
+      else if (!v_mTraced[other] && (next < 0 || d % 2 == 0))
+      {
+        next = other;
+      }
+    }
+    if (end >= 0)
+    {
+      branch.mTo = end;
+      branch.mCells.push_back(Point(v_mNodeCells[end] % mWidth - 1, v_mNodeCells[end] / mWidth - 1));
+      v_mBranches.push_back(branch);
+      return true;
+    }
+    if (next < 0)
+    {
+      return false;
+    }
+    previous = cell;
+    cell = next;
+  }
+}
+
+/*
+ * remove dead ends that are shorter than twice the clearance of the junction they start from.
+ * these run from a junction into the corner of a room and do not lead anywhere
+ */
+void VoronoiRoadmap::pruneBranches()
+{
+  std::vector<unsigned int> v_degree(v_mNodeCells.size(), 0);
+  for (std::vector<Branch>::const_iterator it = v_mBranches.begin(); it != v_mBranches.end(); it++)
+  {
+    v_degree[(*it).mFrom]++;
+    v_degree[(*it).mTo]++;
+  }
+  std::vector<Branch> v_kept;
+  for (std::vector<Branch>::const_iterator it = v_mBranches.begin(); it != v_mBranches.end(); it++)
+  {
+    unsigned int junction = v_degree[(*it).mFrom] == 1 ? (*it).mTo : (*it).mFrom;
+    bool deadEnd = (v_degree[(*it).mFrom] == 1) != (v_degree[(*it).mTo] == 1);
+    float clearance = sqrtf(float(distance2(v_mNodeCells[junction])));
+    if (deadEnd && v_degree[junction] > 2 && (*it).mCells.size() < 2 * clearance)
+    {
+      v_degree[junction]--;
+      continue;
+    }
+    v_kept.push_back(*it);
+  }
+  v_mBranches.swap(v_kept);
+}
+
+//check that the straight lines between the points do not cross an object
+bool VoronoiRoadmap::isFree(MapData* p_mapData, const std::vector<Point> &v_points)
+{
+  for (unsigned int i = 1; i < v_points.size(); i++)
+  {
+    p_mapData->Bresenham(v_points[i - 1], v_points[i], &mEdgeLine);
+    if (p_mapData->checkLineCollission(&mEdgeLine))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+/*
+ * replace every branch by straight edges that stay within GVD_TOLERANCE of it, the bends become extra nodes.
+ * where such an edge would cross an object the tolerance is halved, until the edges follow the branch cell by cell.
+ * only nodes that are still on a branch are kept
+ */
+void VoronoiRoadmap::createEdges(MapData* p_mapData)
+{
+  v_mNodes.clear();
+  v_mEdges.clear();
+  std::vector<int> v_index(v_mNodeCells.size(), -1);
+  std::vector<Point> v_simplified;
+  for (std::vector<Branch>::const_iterator it = v_mBranches.begin(); it != v_mBranches.end(); it++)
+  {
+    float tolerance = GVD_TOLERANCE;
+    simplifyPolyline((*it).mCells, tolerance, v_simplified);
+    while (tolerance > 0 && !isFree(p_mapData, v_simplified))
+    {
+      tolerance = tolerance > 0.1f ? tolerance / 2 : 0;
+      simplifyPolyline((*it).mCells, tolerance, v_simplified);
+    }
+    unsigned int ends[2] = {(*it).mFrom, (*it).mTo};
+    for (unsigned int e = 0; e < 2; e++)
+    {
+      if (v_index[ends[e]] < 0)
+      {
+        v_index[ends[e]] = v_mNodes.size();
+        v_mNodes.push_back(v_simplified[e == 0 ? 0 : v_simplified.size() - 1]);
+      }
+    }
+    unsigned int previous = v_index[(*it).mFrom];
+    for (unsigned int i = 1; i + 1 < v_simplified.size(); i++)
+    {
+      v_mNodes.push_back(v_simplified[i]);
+      v_mEdges.push_back(std::make_pair(previous, (unsigned int)v_mNodes.size() - 1));
+      previous = v_mNodes.size() - 1;
+    }
+    if (previous != (unsigned int)v_index[(*it).mTo])
+    {
+      v_mEdges.push_back(std::make_pair(previous, (unsigned int)v_index[(*it).mTo]));
+    }
+  }
+}
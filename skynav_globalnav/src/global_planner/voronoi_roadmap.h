@@ -0,0 +1,76 @@
+/*
+ * voronoi_roadmap.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef VORONOI_ROADMAP_H_
+#define VORONOI_ROADMAP_H_
+#include <vector>
+
+#include "graph.h"
+
+#define GVD_MIN_CLEARANCE 1 //cells closer than this to an object are not part of the diagram
+#define GVD_TOLERANCE 1.0f //largest distance in cells between a diagram branch and the edges that replace it
+
+/*
+ * sparse roadmap on the generalised Voronoi diagram of a map: the cells that are equally far from two or more
+ * objects. these lie in the middle of corridors and between objects, where the clearance is largest.
+ *
+ * build() computes the nearest object cell of every cell (a distance transform in two passes over the map),
+ * marks the cells whose neighbour has a nearest object in another direction, thins them to a skeleton of
+ * one cell wide, and turns the skeleton into nodes at the junctions and ends, joined by straight edges that
+ * follow the branches within GVD_TOLERANCE (less where that would cut through an object). short dead ends into the corners of rooms are left out.
+ * the map border counts as an object.
+ */
+class VoronoiRoadmap
+{
+public:
+  VoronoiRoadmap(unsigned int minClearance = GVD_MIN_CLEARANCE);
+  virtual ~VoronoiRoadmap();
+
+  void build(MapData* p_mapData);
+
+  const std::vector<Point>& getNodes() const;
+  const std::vector<std::pair<unsigned int, unsigned int> >& getEdges() const;
+  bool isSkeleton(unsigned int x, unsigned int y) const;
+  float getClearance(unsigned int x, unsigned int y) const;
+
+private:
+  //a branch of the skeleton between two nodes, with all its cells
+  struct Branch
+  {
+    unsigned int mFrom;
+    unsigned int mTo;
+    std::vector<Point> mCells;
+  };
+
+  void distanceTransform(MapData* p_mapData);
+  void propagate(unsigned int cell, unsigned int neighbour);
+  void markSkeleton();
+  void thin();
+  void findNodes();
+  void traceBranches();
+  bool traceBranch(unsigned int node, unsigned int cell, unsigned int first);
+  void pruneBranches();
+  void createEdges(MapData* p_mapData);
+  bool isFree(MapData* p_mapData, const std::vector<Point> &v_points);
+
+  int distance2(unsigned int cell) const;
+  unsigned int neighbour(unsigned int cell, unsigned int direction) const;
+
+  unsigned int mMinClearance;
+  unsigned int mWidth; //width of the map plus a border cell on either side
+  unsigned int mHeight; //height of the map plus a border cell on either side
+  std::vector<int> v_mSite; //cell index of the nearest object, -1 while unknown
+  std::vector<unsigned char> v_mSkeleton; //1 for cells of the diagram
+  std::vector<int> v_mNodeOfCell; //node of a skeleton cell that is a junction or an end, -1 for other cells
+  std::vector<unsigned char> v_mTraced; //skeleton cells that belong to a traced branch
+  std::vector<unsigned int> v_mNodeCells; //the cell of every node
+  std::vector<Branch> v_mBranches;
+  std::vector<Point> v_mNodes; //nodes of the roadmap, in map coordinates
+  std::vector<std::pair<unsigned int, unsigned int> > v_mEdges; //edges of the roadmap, as indices in v_mNodes
+  Line mEdgeLine; //scratch line for the collision check of a simplified branch
+};
+
+#endif /* VORONOI_ROADMAP_H_ */
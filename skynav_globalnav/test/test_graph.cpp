@@ -0,0 +1,1386 @@
+#include <gtest/gtest.h>
+#include <boost/thread/thread.hpp>
+#include <boost/bind.hpp>
+#include <graph.h>
+#include <path_finder.h>
+#include <search_graphs.h>
+#include <navigation_function.h>
+#include <route_table.h>
+#include <tour.h>
+#include <theta_star.h>
+#include <voronoi_roadmap.h>
+#include <visibility_roadmap.h>
+#include <d_star_lite.h>
+#include <map_store.h>
+#include <reservation_table.h>
+#include <tiled_grid.h>
+#include <map_pyramid.h>
+#include <coarse_to_fine.h>
+#include <environment_store.h>
+#include <new>
+#include <cstdlib>
+
+#define TEST_MAP_X 60
+#define TEST_MAP_Y 60
+#define TEST_QUERIES 8
+
+//count the heap allocations made while counting is enabled
+static bool countAllocations = false;
+static unsigned int allocationCount = 0;
+
+//the heap behind the replacement operators. not inlined, so gcc does not pair the malloc and free it sees
+//with the new and delete of the caller, and warn about a mismatch (-Wmismatched-new-delete)
+__attribute__((noinline)) static void* allocateBlock(std::size_t size)
+{
+  return std::malloc(size ? size : 1);
+}
+
+__attribute__((noinline)) static void releaseBlock(void* p)
+{
+  std::free(p);
+}
+
+//no exception specifications, they mean other things in C++98 and C++11 and are gone in C++17
+void* operator new(std::size_t size)
+{
+  if (countAllocations)
+  {
+    allocationCount++;
+  }
+  void* p = allocateBlock(size);
+  if (!p)
+  {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void* operator new[](std::size_t size)
+{
+  return operator new(size);
+}
+
+void operator delete(void* p)
+{
+  releaseBlock(p);
+}
+
+void operator delete[](void* p)
+{
+  operator delete(p);
+}
+
+//the sized forms that C++14 calls, so every allocation is freed by the counterpart of its new
+void operator delete(void* p, std::size_t)
+{
+  operator delete(p);
+}
+
+void operator delete[](void* p, std::size_t)
+{
+  operator delete[](p);
+}
+
+struct Query
+{
+  unsigned int xStart, yStart, xTarget, yTarget;
+  std::vector<Node*> path;
+  bool found;
+};
+
+//an empty map with a wall in the middle, open at the top and bottom
+MapData* createTestMap()
+{
+  MapData* p_mapData = new MapData(TEST_MAP_X, TEST_MAP_Y, 1, 300, 10, 20);
+  std::vector<int> occupancy(TEST_MAP_X * TEST_MAP_Y, 1);
+  for (unsigned int y = 10; y < TEST_MAP_Y - 10; y++)
+  {
+    occupancy[y * TEST_MAP_X + TEST_MAP_X / 2] = 100;
+  }
+  p_mapData->parseOccupancyList(occupancy);
+  return p_mapData;
+}
+
+void runQuery(Graph* p_graph, Query* p_query)
+{
+  p_query->found = p_graph->findPath(p_query->xStart, p_query->yStart, 0, p_query->xTarget, p_query->yTarget, 0,
+                                     p_query->path);
+}
+
+TEST(GraphTestSuite, concurrentQueries)
+{
+  MapData* p_mapData = createTestMap();
+  Graph* p_graph = new Graph(p_mapData);
+
+  std::vector<Query> sequential(TEST_QUERIES);
+  for (unsigned int i = 0; i < TEST_QUERIES; i++)
+  {
+    sequential[i].xStart = 2 + i;
+    sequential[i].yStart = 5 + 6 * i;
+    sequential[i].xTarget = TEST_MAP_X - 3 - i;
+    sequential[i].yTarget = TEST_MAP_Y - 5 - 6 * i;
+  }
+  std::vector<Query> concurrent = sequential;
+
+  //first run adds the start and target nodes to the roadmap, after that the roadmap is the same for all queries
+  std::vector<Query> warmup = sequential;
+  for (unsigned int i = 0; i < TEST_QUERIES; i++)
+  {
+    runQuery(p_graph, &warmup[i]);
+  }
+  for (unsigned int i = 0; i < TEST_QUERIES; i++)
+  {
+    runQuery(p_graph, &sequential[i]);
+  }
+
+  boost::thread_group threads;
+  for (unsigned int i = 0; i < TEST_QUERIES; i++)
+  {
+    threads.create_thread(boost::bind(&runQuery, p_graph, &concurrent[i]));
+  }
+  threads.join_all();
+
+  for (unsigned int i = 0; i < TEST_QUERIES; i++)
+  {
+    EXPECT_EQ(sequential[i].found, concurrent[i].found);
+    EXPECT_TRUE(sequential[i].path == concurrent[i].path) << "query " << i << " differs";
+    //queries only add to the roadmap, the map grid they share is not written
+    EXPECT_EQ(spaceType::Cfree, p_mapData->getCell(sequential[i].xStart, sequential[i].yStart));
+  }
+
+  delete p_graph;
+  delete p_mapData;
+}
+
+TEST(GraphTestSuite, arenaKeepsAddresses)
+{
+  Arena<Point> arena;
+  unsigned int first = arena.add(Point(1, 2));
+  Point* p_first = &arena[first];
+
+  //fill several blocks, the first object may not move
+  for (unsigned int i = 1; i < 3 * ARENA_BLOCK_SIZE; i++)
+  {
+    EXPECT_EQ(i, arena.add(Point(i, i)));
+  }
+  EXPECT_EQ(p_first, &arena[first]);
+  EXPECT_EQ(2u, arena[first].mYpos);
+  EXPECT_EQ(ARENA_BLOCK_SIZE + 5, arena[ARENA_BLOCK_SIZE + 5].mXpos);
+
+  arena.clear();
+  EXPECT_EQ(0u, arena.size());
+}
+
+TEST(GraphTestSuite, roadmapIds)
+{
+  MapData* p_mapData = createTestMap();
+  Graph* p_graph = new Graph(p_mapData);
+
+  for (unsigned int i = 0; i < p_graph->getNodeCount(); i++)
+  {
+    EXPECT_EQ(i, p_graph->getNode(i)->getId());
+  }
+  for (unsigned int i = 0; i < p_graph->getEdgeCount(); i++)
+  {
+    Edge* p_edge = p_graph->getEdge(i);
+    EXPECT_EQ(p_edge, p_graph->getEdgeBetween(p_graph->getNode(p_edge->getA()), p_graph->getNode(p_edge->getB())));
+    EXPECT_EQ(p_edge, p_graph->getEdgeBetween(p_graph->getNode(p_edge->getB()), p_graph->getNode(p_edge->getA())));
+  }
+
+  delete p_graph;
+  delete p_mapData;
+}
+
+TEST(GraphTestSuite, noAllocationsPerExpansion)
+{
+  MapData* p_mapData = createTestMap();
+  Graph* p_graph = new Graph(p_mapData);
+  std::vector<Node*> path;
+  ASSERT_TRUE(p_graph->findPath(2, 2, 0, TEST_MAP_X - 3, TEST_MAP_Y - 3, 0, path));
+
+  Node* p_start = p_graph->returnNodeExist(2, 2);
+  Node* p_target = p_graph->returnNodeExist(TEST_MAP_X - 3, TEST_MAP_Y - 3);
+  PathFinder finder(p_graph);
+  ASSERT_TRUE(finder.findPath(p_start, p_target)); //first query sizes the search data and open list
+
+  allocationCount = 0;
+  countAllocations = true;
+  bool found = finder.findPath(p_start, p_target);
+  countAllocations = false;
+
+  EXPECT_TRUE(found);
+  EXPECT_EQ(0u, allocationCount);
+  EXPECT_TRUE(path == finder.getPath());
+
+  delete p_graph;
+  delete p_mapData;
+}
+
+TEST(GraphTestSuite, searchInstantiationsAgree)
+{
+  MapData* p_mapData = createTestMap();
+  Graph* p_graph = new Graph(p_mapData);
+
+  //the roadmap searches must find paths of the same length
+  RoadmapGraph roadmap(p_graph);
+  CsrGraph csr(p_graph);
+  ALTHeuristic<CsrGraph> alt;
+  alt.build(csr, 4, 0);
+  AStarSearch<RoadmapGraph, EuclideanHeuristic, float> roadmapSearch(roadmap);
+  AStarSearch<CsrGraph, EuclideanHeuristic, double> csrSearch(csr);
+  AStarSearch<CsrGraph, ALTHeuristic<CsrGraph>, float> altSearch(csr, alt);
+  for (unsigned int target = 1; target < p_graph->getNodeCount(); target += 7)
+  {
+    bool found = roadmapSearch.search(0, target);
+    EXPECT_EQ(found, csrSearch.search(0, target));
+    EXPECT_EQ(found, altSearch.search(0, target));
+    if (found)
+    {
+      EXPECT_NEAR(roadmapSearch.getCost(target), csrSearch.getCost(target), 0.01);
+      EXPECT_NEAR(roadmapSearch.getCost(target), altSearch.getCost(target), 0.01);
+    }
+  }
+
+  //the grid searches around the wall, a straight step costs 1 and a diagonal step sqrt 2
+  GridGraph grid(p_mapData);
+  AStarSearch<GridGraph, OctileHeuristic, float> octileSearch(grid);
+  AStarSearch<GridGraph, ZeroHeuristic, float> dijkstra(grid);
+  AStarSearch<GridGraph, OctileHeuristic, int> intSearch(grid);
+  unsigned int source = grid.getVertex(5, 30);
+  unsigned int target = grid.getVertex(TEST_MAP_X - 5, 30);
+  ASSERT_TRUE(octileSearch.search(source, target));
+  ASSERT_TRUE(dijkstra.search(source, target));
+  ASSERT_TRUE(intSearch.search(source, target));
+  EXPECT_NEAR(dijkstra.getCost(target), octileSearch.getCost(target), 0.01);
+  EXPECT_NEAR(dijkstra.getCost(target) * 10, intSearch.getCost(target), 10);
+  EXPECT_GT(octileSearch.getCost(target), TEST_MAP_X - 10);
+  EXPECT_LT(octileSearch.getExpanded(), dijkstra.getExpanded());
+
+  std::vector<unsigned int> v_path;
+  octileSearch.getPath(target, v_path);
+  EXPECT_EQ(target, v_path.front());
+  EXPECT_EQ(source, v_path.back());
+  for (std::vector<unsigned int>::const_iterator it = v_path.begin(); it != v_path.end(); it++)
+  {
+    EXPECT_FALSE(grid.isBlocked(*it));
+  }
+
+  delete p_graph;
+  delete p_mapData;
+}
+
+TEST(GraphTestSuite, navigationFunctions)
+{
+  MapData* p_mapData = createTestMap();
+  std::vector<Node*> v_fixedWPs;
+  v_fixedWPs.push_back(new Node(TEST_MAP_X - 5, 30, 0));
+  v_fixedWPs.push_back(new Node(5, 5, 1));
+  p_mapData->addFixedWPs(v_fixedWPs);
+
+  NavigationFunctionCache cache(1, 2);
+  cache.rebuild(p_mapData);
+  cache.wait();
+  ASSERT_EQ(2u, cache.getReadyCount());
+  EXPECT_FALSE(cache.find(6, 6));
+
+  //the descent ends at the goal with the cost of a search on the same grid
+  boost::shared_ptr<const NavigationFunction> p_function = cache.find(TEST_MAP_X - 5, 30);
+  ASSERT_TRUE(p_function);
+  GridGraph grid(p_mapData, 1);
+  AStarSearch<GridGraph, OctileHeuristic, float> search(grid);
+  ASSERT_TRUE(search.search(grid.getVertex(5, 30), grid.getVertex(TEST_MAP_X - 5, 30)));
+  EXPECT_NEAR(search.getCost(grid.getVertex(TEST_MAP_X - 5, 30)), p_function->getCost(5, 30), 0.01);
+
+  std::vector<Point> v_path;
+  ASSERT_TRUE(p_function->descend(5, 30, v_path));
+  ASSERT_GE(v_path.size(), 3u); //around the wall
+  EXPECT_EQ(5u, v_path.front().mXpos);
+  EXPECT_EQ(30u, v_path.front().mYpos);
+  EXPECT_EQ(TEST_MAP_X - 5, v_path.back().mXpos);
+  EXPECT_EQ(30u, v_path.back().mYpos);
+  //the waypoints are joined by straight or diagonal segments through free cells
+  for (unsigned int i = 1; i < v_path.size(); i++)
+  {
+    int dx = int(v_path[i].mXpos) - int(v_path[i - 1].mXpos);
+    int dy = int(v_path[i].mYpos) - int(v_path[i - 1].mYpos);
+    EXPECT_TRUE(dx == 0 || dy == 0 || dx == dy || dx == -dy);
+    int steps = std::max(std::abs(dx), std::abs(dy));
+    for (int s = 0; s <= steps; s++)
+    {
+      EXPECT_FALSE(grid.isBlocked(grid.getVertex(v_path[i - 1].mXpos + dx / steps * s, v_path[i - 1].mYpos + dy / steps * s)));
+    }
+  }
+
+  //the wall cell itself can not be reached
+  EXPECT_FALSE(p_function->isReachable(TEST_MAP_X / 2, 30));
+  EXPECT_FALSE(p_function->descend(TEST_MAP_X / 2, 30, v_path));
+
+  cache.invalidate();
+  EXPECT_EQ(0u, cache.getReadyCount());
+  EXPECT_FALSE(cache.find(TEST_MAP_X - 5, 30));
+  EXPECT_TRUE(p_function->descend(5, 30, v_path)); //a function in use stays valid
+
+  //a rebuild while the builders of the last one still run does not wait for them, only its own functions are kept
+  for (unsigned int i = 0; i < 5; i++)
+  {
+    cache.rebuild(p_mapData);
+  }
+  cache.wait();
+  EXPECT_EQ(2u, cache.getReadyCount());
+  ASSERT_TRUE(cache.find(5, 5));
+  EXPECT_NEAR(p_function->getCost(5, 5), cache.find(TEST_MAP_X - 5, 30)->getCost(5, 5), 0.01);
+
+  delete p_mapData;
+}
+
+TEST(GraphTestSuite, routeTable)
+{
+  MapData* p_mapData = createTestMap();
+  Graph* p_graph = new Graph(p_mapData);
+  std::vector<Node*> v_fixedWPs;
+  v_fixedWPs.push_back(new Node(5, 30, 0));
+  v_fixedWPs.push_back(new Node(TEST_MAP_X - 5, 30, 1));
+  v_fixedWPs.push_back(new Node(30, 5, 2));
+  p_mapData->updateFixedWPs(v_fixedWPs);
+  p_graph->updateFixedWaypoints();
+
+  RouteTable table;
+  table.update(p_graph, p_mapData->getFixedWPs());
+  ASSERT_EQ(3u, table.getAnchorCount());
+
+  //add a waypoint, the table is updated incrementally and must equal a table built from scratch
+  v_fixedWPs.clear();
+  v_fixedWPs.push_back(new Node(5, 30, 0));
+  v_fixedWPs.push_back(new Node(TEST_MAP_X - 5, 30, 1));
+  v_fixedWPs.push_back(new Node(30, 5, 2));
+  v_fixedWPs.push_back(new Node(30, TEST_MAP_Y - 5, 3));
+  p_mapData->updateFixedWPs(v_fixedWPs);
+  p_graph->updateFixedWaypoints();
+  table.update(p_graph, p_mapData->getFixedWPs());
+  RouteTable fullTable;
+  fullTable.update(p_graph, p_mapData->getFixedWPs());
+  ASSERT_EQ(4u, table.getAnchorCount());
+
+  RoadmapGraph roadmap(p_graph);
+  AStarSearch<RoadmapGraph, EuclideanHeuristic, float> search(roadmap);
+  for (unsigned int a = 0; a < 4; a++)
+  {
+    for (unsigned int b = 0; b < 4; b++)
+    {
+      EXPECT_NEAR(fullTable.getCost(a, b), table.getCost(a, b), 0.01);
+      Node* p_a = p_graph->returnNodeExist(v_fixedWPs[a]->getXpos(), v_fixedWPs[a]->getYpos());
+      Node* p_b = p_graph->returnNodeExist(v_fixedWPs[b]->getXpos(), v_fixedWPs[b]->getYpos());
+      if (search.search(p_a->getId(), p_b->getId()))
+      {
+        EXPECT_NEAR(search.getCost(p_b->getId()), table.getCost(a, b), 0.01);
+      }
+    }
+  }
+
+  //a route runs from start to target over roadmap nodes
+  std::vector<Point> v_route;
+  ASSERT_TRUE(table.findRoute(5, 30, TEST_MAP_X - 5, 30, v_route));
+  EXPECT_EQ(5u, v_route.front().mXpos);
+  EXPECT_EQ(TEST_MAP_X - 5, v_route.back().mXpos);
+  for (std::vector<Point>::const_iterator it = v_route.begin(); it != v_route.end(); it++)
+  {
+    EXPECT_TRUE(p_graph->nodeExist((*it).mXpos, (*it).mYpos));
+  }
+  EXPECT_FALSE(table.findRoute(6, 30, TEST_MAP_X - 5, 30, v_route));
+
+  //a stitched route starts and ends at the query coordinates
+  ASSERT_TRUE(table.findStitchedRoute(p_mapData, 6, 31, TEST_MAP_X - 6, 29, v_route));
+  EXPECT_EQ(6u, v_route.front().mXpos);
+  EXPECT_EQ(31u, v_route.front().mYpos);
+  EXPECT_EQ(TEST_MAP_X - 6, v_route.back().mXpos);
+  EXPECT_EQ(29u, v_route.back().mYpos);
+  EXPECT_EQ(5u, v_route[1].mXpos);
+
+  delete p_graph;
+  delete p_mapData;
+}
+
+TEST(GraphTestSuite, tourOrder)
+{
+  //stops on a line, the best tour from the first stop visits them from left to right
+  unsigned int positions[] = {0, 70, 20, 90, 10, 50, 30, 80, 60, 40};
+  unsigned int n = 10;
+  std::vector<float> v_costs(n * n);
+  for (unsigned int a = 0; a < n; a++)
+  {
+    for (unsigned int b = 0; b < n; b++)
+    {
+      v_costs[a * n + b] = std::abs(int(positions[a]) - int(positions[b]));
+    }
+  }
+  Tour tour(v_costs, n);
+  std::vector<unsigned int> v_order;
+  for (unsigned int i = 0; i < n; i++)
+  {
+    v_order.push_back(i); //visit in the given order, a long zig-zag
+  }
+  tour.setOrder(v_order);
+  tour.improve();
+  EXPECT_FLOAT_EQ(90, tour.getCost());
+  ASSERT_EQ(n, tour.getOrder().size());
+  EXPECT_EQ(0u, tour.getOrder()[0]);
+
+  //random stops, the improved tour visits every stop once and is not longer than the nearest neighbour tour
+  srand(3);
+  for (unsigned int run = 0; run < 20; run++)
+  {
+    n = 5 + rand() % 25;
+    std::vector<float> v_x(n), v_y(n);
+    for (unsigned int i = 0; i < n; i++)
+    {
+      v_x[i] = rand() % 100;
+      v_y[i] = rand() % 100;
+    }
+    v_costs.resize(n * n);
+    for (unsigned int a = 0; a < n; a++)
+    {
+      for (unsigned int b = 0; b < n; b++)
+      {
+        v_costs[a * n + b] = sqrtf((v_x[a] - v_x[b]) * (v_x[a] - v_x[b]) + (v_y[a] - v_y[b]) * (v_y[a] - v_y[b]));
+      }
+    }
+    Tour randomTour(v_costs, n);
+    randomTour.nearestNeighbour();
+    float nearestCost = randomTour.getCost();
+    randomTour.improve();
+    EXPECT_LE(randomTour.getCost(), nearestCost + 0.001);
+    std::vector<unsigned int> v_sorted(randomTour.getOrder());
+    EXPECT_EQ(0u, v_sorted[0]);
+    std::sort(v_sorted.begin(), v_sorted.end());
+    for (unsigned int i = 0; i < n; i++)
+    {
+      EXPECT_EQ(i, v_sorted[i]);
+    }
+  }
+}
+
+TEST(GraphTestSuite, findTour)
+{
+  MapData* p_mapData = createTestMap();
+  Graph* p_graph = new Graph(p_mapData);
+  std::vector<Point> v_stops;
+  v_stops.push_back(Point(5, 5));
+  v_stops.push_back(Point(TEST_MAP_X - 5, TEST_MAP_Y - 5));
+  v_stops.push_back(Point(10, 10));
+  v_stops.push_back(Point(TEST_MAP_X - 10, TEST_MAP_Y - 10));
+  v_stops.push_back(Point(15, 15));
+
+  std::vector<unsigned int> v_order;
+  std::vector<Node*> v_path;
+  float cost;
+  ASSERT_TRUE(p_graph->findTour(v_stops, v_order, v_path, cost));
+  ASSERT_EQ(5u, v_order.size());
+  EXPECT_EQ(0u, v_order[0]);
+  //the stops on the near side of the wall come first
+  EXPECT_EQ(2u, v_order[1]);
+  EXPECT_EQ(4u, v_order[2]);
+  EXPECT_EQ(5u, v_path.front()->getXpos());
+  EXPECT_EQ(v_stops[v_order[4]].mXpos, v_path.back()->getXpos());
+
+  //consecutive path nodes are joined by roadmap edges, the legs are the ones the cost of the tour was taken from
+  float pathCost = 0;
+  for (unsigned int i = 1; i < v_path.size(); i++)
+  {
+    ASSERT_TRUE(p_graph->edgeExist(v_path[i - 1], v_path[i]));
+    pathCost += p_graph->getEdgeBetween(v_path[i - 1], v_path[i])->getCost();
+  }
+  EXPECT_NEAR(cost, pathCost, 0.01f * cost);
+
+  delete p_graph;
+  delete p_mapData;
+}
+
+TEST(GraphTestSuite, thetaStar)
+{
+  MapData* p_mapData = createTestMap();
+  GridGraph grid(p_mapData, 1);
+  ThetaStar thetaStar(grid);
+  AStarSearch<GridGraph, OctileHeuristic, float> search(grid);
+  unsigned int start = grid.getVertex(5, 30);
+  unsigned int target = grid.getVertex(TEST_MAP_X - 5, 35);
+  ASSERT_TRUE(search.search(start, target));
+  std::vector<unsigned int> v_gridPath;
+  search.getPath(target, v_gridPath);
+
+  for (unsigned int lazy = 0; lazy < 2; lazy++)
+  {
+    ASSERT_TRUE(thetaStar.search(5, 30, TEST_MAP_X - 5, 35, lazy));
+    const std::vector<Point> &v_path = thetaStar.getPath();
+    //a taut path around the end of the wall: start, one or two bends, target
+    EXPECT_LE(v_path.size(), 4u);
+    EXPECT_LT(thetaStar.getCost(), search.getCost(target));
+    EXPECT_EQ(5u, v_path.front().mXpos);
+    EXPECT_EQ(TEST_MAP_X - 5, v_path.back().mXpos);
+    float length = 0;
+    for (unsigned int i = 1; i < v_path.size(); i++)
+    {
+      unsigned int a = grid.getVertex(v_path[i - 1].mXpos, v_path[i - 1].mYpos);
+      unsigned int b = grid.getVertex(v_path[i].mXpos, v_path[i].mYpos);
+      EXPECT_TRUE(thetaStar.lineOfSight(a, b));
+      float dx = float(v_path[i].mXpos) - float(v_path[i - 1].mXpos);
+      float dy = float(v_path[i].mYpos) - float(v_path[i - 1].mYpos);
+      length += sqrtf(dx * dx + dy * dy);
+    }
+    EXPECT_NEAR(length, thetaStar.getCost(), 0.01);
+  }
+
+  //no line of sight through the wall, or through its inflation
+  EXPECT_FALSE(thetaStar.lineOfSight(grid.getVertex(5, 30), grid.getVertex(TEST_MAP_X - 5, 30)));
+  EXPECT_FALSE(thetaStar.lineOfSight(grid.getVertex(TEST_MAP_X / 2 - 1, 5), grid.getVertex(TEST_MAP_X / 2 - 1, 20)));
+  EXPECT_TRUE(thetaStar.lineOfSight(grid.getVertex(5, 5), grid.getVertex(TEST_MAP_X - 5, 5)));
+  EXPECT_FALSE(thetaStar.search(TEST_MAP_X / 2, 30, 5, 5, false));
+
+  delete p_mapData;
+}
+
+TEST(GraphTestSuite, voronoiRoadmap)
+{
+  MapData* p_mapData = createTestMap();
+  VoronoiRoadmap voronoi;
+  voronoi.build(p_mapData);
+
+  //the diagram runs halfway between the border and the wall
+  bool middle = false;
+  for (unsigned int x = 14; x <= 16; x++)
+  {
+    middle = middle || voronoi.isSkeleton(x, 30);
+  }
+  EXPECT_TRUE(middle);
+  EXPECT_FALSE(voronoi.isSkeleton(TEST_MAP_X / 2, 30));
+  EXPECT_NEAR(15.0f, voronoi.getClearance(15, 30), 1.0f);
+
+  Graph* p_graph = new Graph(p_mapData, roadmapTypes::Voronoi_roadmap);
+  //a few junctions and bends instead of hundreds of random samples
+  EXPECT_GT(p_graph->getNodeCount(), 3u);
+  EXPECT_LT(p_graph->getNodeCount(), 60u);
+
+  Line line;
+  for (unsigned int i = 0; i < p_graph->getEdgeCount(); i++)
+  {
+    Edge* p_edge = p_graph->getEdge(i);
+    Node* p_A = p_graph->getNode(p_edge->getA());
+    Node* p_B = p_graph->getNode(p_edge->getB());
+    p_mapData->Bresenham(Point(p_A->getXpos(), p_A->getYpos()), Point(p_B->getXpos(), p_B->getYpos()), &line);
+    EXPECT_FALSE(p_mapData->checkLineCollission(&line));
+  }
+
+  //every node can be reached from every other one
+  for (unsigned int i = 1; i < p_graph->getNodeCount(); i++)
+  {
+    std::vector<Node*> v_path;
+    Node* p_A = p_graph->getNode(0);
+    Node* p_B = p_graph->getNode(i);
+    EXPECT_TRUE(p_graph->findPath(p_A->getXpos(), p_A->getYpos(), 0, p_B->getXpos(), p_B->getYpos(), 0, v_path));
+  }
+
+  //a query from one side of the wall to the other
+  std::vector<Node*> v_path;
+  EXPECT_TRUE(p_graph->findPath(10, 30, 0, TEST_MAP_X - 10, 30, 0, v_path));
+
+  delete p_graph;
+  delete p_mapData;
+}
+
+TEST(GraphTestSuite, visibilityRoadmap)
+{
+  MapData* p_mapData = createTestMap();
+  VisibilityRoadmap visibility;
+  visibility.build(p_mapData);
+  //the outline of the map and the outline of the wall
+  EXPECT_EQ(2u, visibility.getPolygons().size());
+
+  //nodes only at the two ends of the inflated wall
+  const std::vector<Point> &v_nodes = visibility.getNodes();
+  EXPECT_GE(v_nodes.size(), 4u);
+  EXPECT_LE(v_nodes.size(), 8u);
+  for (std::vector<Point>::const_iterator it = v_nodes.begin(); it != v_nodes.end(); it++)
+  {
+    EXPECT_TRUE((*it).mYpos < 10 || (*it).mYpos >= TEST_MAP_Y - 10);
+    EXPECT_NEAR(TEST_MAP_X / 2, (*it).mXpos, 3u);
+  }
+
+  //the same map gives the same roadmap
+  VisibilityRoadmap again;
+  again.build(p_mapData);
+  ASSERT_EQ(v_nodes.size(), again.getNodes().size());
+  EXPECT_EQ(visibility.getEdges().size(), again.getEdges().size());
+
+  Graph* p_graph = new Graph(p_mapData, roadmapTypes::Visibility_roadmap);
+  EXPECT_EQ(v_nodes.size(), p_graph->getNodeCount());
+  std::vector<Node*> v_path;
+  ASSERT_TRUE(p_graph->findPath(5, 30, 0, TEST_MAP_X - 5, 35, 0, v_path));
+  //start, the corners at one end of the wall, target: no longer than the any-angle path on the same grid
+  EXPECT_LE(v_path.size(), 4u);
+  float length = 0;
+  for (unsigned int i = 1; i < v_path.size(); i++)
+  {
+    length += v_path[i]->estimateDist(v_path[i - 1]->getXpos(), v_path[i - 1]->getYpos());
+  }
+  GridGraph grid(p_mapData, VISIBILITY_INFLATION);
+  ThetaStar thetaStar(grid);
+  ASSERT_TRUE(thetaStar.search(5, 30, TEST_MAP_X - 5, 35, false));
+  EXPECT_LE(length, thetaStar.getCost() + 0.01f);
+
+  delete p_graph;
+  delete p_mapData;
+}
+
+TEST(GraphTestSuite, dStarLite)
+{
+  MapData* p_mapData = createTestMap();
+  GridGraph grid(p_mapData, 1);
+  AStarSearch<GridGraph, OctileHeuristic, float> search(grid);
+  unsigned int start = grid.getVertex(5, 30);
+  unsigned int target = grid.getVertex(TEST_MAP_X - 5, 35);
+  ASSERT_TRUE(search.search(start, target));
+
+  DStarLite replanner(grid);
+  replanner.setGoal(TEST_MAP_X - 5, 35);
+  replanner.setStart(5, 30);
+  ASSERT_TRUE(replanner.replan());
+  EXPECT_NEAR(search.getCost(target), replanner.getCost(), 0.01f);
+  const std::vector<Point> &v_path = replanner.getPath();
+  ASSERT_GE(v_path.size(), 3u);
+  EXPECT_EQ(5u, v_path.front().mXpos);
+  EXPECT_EQ(30u, v_path.front().mYpos);
+  EXPECT_EQ(TEST_MAP_X - 5, v_path.back().mXpos);
+  EXPECT_EQ(35u, v_path.back().mYpos);
+
+  //an object on the first bend of the path: the repaired path costs as much as a new search, with fewer expansions
+  Point bend = v_path[1];
+  replanner.addObstacle(bend.mXpos, bend.mYpos, 2, 10);
+  ASSERT_TRUE(replanner.replan());
+  EXPECT_TRUE(replanner.isBlocked(bend.mXpos, bend.mYpos));
+  EXPECT_GT(replanner.getCost(), search.getCost(target));
+  DStarLite fresh(grid);
+  fresh.setGoal(TEST_MAP_X - 5, 35);
+  fresh.setStart(5, 30);
+  fresh.addObstacle(bend.mXpos, bend.mYpos, 2, 10);
+  ASSERT_TRUE(fresh.replan());
+  EXPECT_NEAR(fresh.getCost(), replanner.getCost(), 0.01f);
+  EXPECT_LT(replanner.getExpanded(), fresh.getExpanded());
+  for (unsigned int i = 0; i < replanner.getPath().size(); i++)
+  {
+    EXPECT_FALSE(replanner.isBlocked(replanner.getPath()[i].mXpos, replanner.getPath()[i].mYpos));
+  }
+
+  //the object has expired, its cells are free again but the cells of the map stay blocked
+  replanner.removeExpiredObstacles(5);
+  EXPECT_TRUE(replanner.isBlocked(bend.mXpos, bend.mYpos));
+  replanner.removeExpiredObstacles(10);
+  EXPECT_FALSE(replanner.isBlocked(bend.mXpos, bend.mYpos));
+  EXPECT_TRUE(replanner.isBlocked(TEST_MAP_X / 2, 30));
+  ASSERT_TRUE(replanner.replan());
+  EXPECT_NEAR(search.getCost(target), replanner.getCost(), 0.01f);
+
+  //the robot moved on towards the bend
+  unsigned int moved = grid.getVertex(10, 25);
+  ASSERT_TRUE(search.search(moved, target));
+  replanner.setStart(10, 25);
+  ASSERT_TRUE(replanner.replan());
+  EXPECT_NEAR(search.getCost(target), replanner.getCost(), 0.01f);
+
+  //both ends of the wall closed
+  replanner.addObstacle(TEST_MAP_X / 2, 4, 5, 20);
+  replanner.addObstacle(TEST_MAP_X / 2, TEST_MAP_Y - 5, 5, 20);
+  EXPECT_FALSE(replanner.replan());
+  EXPECT_TRUE(replanner.getPath().empty());
+
+  //the objects do not stay walls for a later goal
+  replanner.setGoal(TEST_MAP_X - 5, 30);
+  replanner.removeExpiredObstacles(20);
+  ASSERT_TRUE(replanner.replan());
+  ASSERT_TRUE(search.search(moved, grid.getVertex(TEST_MAP_X - 5, 30)));
+  EXPECT_NEAR(search.getCost(grid.getVertex(TEST_MAP_X - 5, 30)), replanner.getCost(), 0.01f);
+
+  delete p_mapData;
+}
+
+//the length of a path along the roadmap, and whether it passes the wall at the top
+float pathLength(const std::vector<Node*> &v_path, bool &top)
+{
+  float length = 0;
+  top = false;
+  for (unsigned int i = 0; i < v_path.size(); i++)
+  {
+    top = top || v_path[i]->getYpos() < 10;
+    if (i > 0)
+    {
+      length += v_path[i]->estimateDist(v_path[i - 1]->getXpos(), v_path[i - 1]->getYpos());
+    }
+  }
+  return length;
+}
+
+TEST(GraphTestSuite, temporaryObstacles)
+{
+  MapData* p_mapData = createTestMap();
+  Graph* p_graph = new Graph(p_mapData, roadmapTypes::Visibility_roadmap);
+  std::vector<Node*> v_path;
+  ASSERT_TRUE(p_graph->findPath(5, 30, 0, TEST_MAP_X - 5, 35, 0, v_path));
+  bool top;
+  float length = pathLength(v_path, top);
+
+  //close the opening the path runs through with an object that is not on the map
+  std::vector<Point> v_cells;
+  for (unsigned int y = 0; y < 10; y++)
+  {
+    v_cells.push_back(Point(TEST_MAP_X / 2, top ? y : TEST_MAP_Y - 1 - y));
+  }
+  p_mapData->addTemporaryObstacles(v_cells, 1, 0.5f);
+  EXPECT_TRUE(p_mapData->hasTemporaryObstacles(MapData::getTime()));
+  EXPECT_TRUE(p_mapData->checkTemporaryObstacle(TEST_MAP_X / 2 + 1, top ? 5 : TEST_MAP_Y - 5, MapData::getTime()));
+
+  std::vector<Node*> v_detour;
+  ASSERT_TRUE(p_graph->findPath(5, 30, 0, TEST_MAP_X - 5, 35, 0, v_detour));
+  bool detourTop;
+  pathLength(v_detour, detourTop);
+  EXPECT_NE(top, detourTop);
+  Line line;
+  for (unsigned int i = 1; i < v_detour.size(); i++)
+  {
+    p_mapData->Bresenham(Point(v_detour[i - 1]->getXpos(), v_detour[i - 1]->getYpos()),
+                         Point(v_detour[i]->getXpos(), v_detour[i]->getYpos()), &line);
+    EXPECT_EQ(0, p_mapData->checkTemporaryLineCollision(&line, MapData::getTime()));
+  }
+  //a path found before the object arrived runs into it, the detour does not
+  std::vector<Point> v_points;
+  for (unsigned int i = 0; i < v_path.size(); i++)
+  {
+    v_points.push_back(Point(v_path[i]->getXpos(), v_path[i]->getYpos()));
+  }
+  EXPECT_TRUE(p_mapData->checkTemporaryPathCollision(v_points, MapData::getTime()));
+  v_points.clear();
+  for (unsigned int i = 0; i < v_detour.size(); i++)
+  {
+    v_points.push_back(Point(v_detour[i]->getXpos(), v_detour[i]->getYpos()));
+  }
+  EXPECT_FALSE(p_mapData->checkTemporaryPathCollision(v_points, MapData::getTime()));
+  //only edges of the paths that were found are checked and left out
+  unsigned int blocked = 0;
+  for (unsigned int i = 0; i < p_graph->getEdgeCount(); i++)
+  {
+    blocked += p_graph->getEdge(i)->getBlockedUntil() > 0;
+  }
+  EXPECT_GT(blocked, 0u);
+  EXPECT_LT(blocked, p_graph->getEdgeCount() / 2);
+
+  //once the object has expired the edges are used again
+  boost::this_thread::sleep(boost::posix_time::milliseconds(600));
+  EXPECT_FALSE(p_mapData->hasTemporaryObstacles(MapData::getTime()));
+  std::vector<Node*> v_after;
+  ASSERT_TRUE(p_graph->findPath(5, 30, 0, TEST_MAP_X - 5, 35, 0, v_after));
+  bool afterTop;
+  EXPECT_NEAR(length, pathLength(v_after, afterTop), 0.01f);
+
+  delete p_graph;
+  delete p_mapData;
+}
+
+TEST(GraphTestSuite, learnedEdgeCosts)
+{
+  MapData* p_mapData = createTestMap();
+  Graph* p_graph = new Graph(p_mapData, roadmapTypes::Visibility_roadmap);
+  std::vector<Node*> v_fixedWPs;
+  v_fixedWPs.push_back(new Node(5, 30, 0));
+  v_fixedWPs.push_back(new Node(TEST_MAP_X - 5, 35, 1));
+  p_mapData->updateFixedWPs(v_fixedWPs);
+  p_graph->updateFixedWaypoints();
+  RouteTable table;
+  table.update(p_graph, p_mapData->getFixedWPs());
+  float routeCost = table.getCost(0, 1);
+  std::vector<Node*> v_path;
+  ASSERT_TRUE(p_graph->findPath(5, 30, 0, TEST_MAP_X - 5, 35, 0, v_path));
+  ASSERT_GE(v_path.size(), 3u);
+  bool top;
+  float length = pathLength(v_path, top);
+
+  //the robot keeps running into objects on the middle edge of the path
+  Node* p_A = v_path[1];
+  Node* p_B = v_path[2];
+  Edge* p_edge = p_graph->getEdgeBetween(p_A, p_B);
+  ASSERT_TRUE(p_edge != NULL);
+  EXPECT_FLOAT_EQ(1.0f, p_edge->getCostFactor());
+  EXPECT_FALSE(p_graph->reportTraversal(0, 0, 1, 1, 2.0f, 0, true));
+  for (unsigned int i = 0; i < 10; i++)
+  {
+    EXPECT_TRUE(p_graph->reportTraversal(p_A->getXpos(), p_A->getYpos(), p_B->getXpos(), p_B->getYpos(), 1.5f, 2,
+                                         true));
+  }
+  EXPECT_GT(p_edge->getCostFactor(), 3.0f);
+  EXPECT_LE(p_edge->getCostFactor(), EDGE_COST_MAX);
+  EXPECT_NEAR(p_edge->getLength() * p_edge->getCostFactor(), p_edge->getCost(), 0.01f);
+
+  //the next path goes around the edge, although it is longer
+  std::vector<Node*> v_learned;
+  ASSERT_TRUE(p_graph->findPath(5, 30, 0, TEST_MAP_X - 5, 35, 0, v_learned));
+  for (unsigned int i = 1; i < v_learned.size(); i++)
+  {
+    EXPECT_FALSE((v_learned[i - 1] == p_A && v_learned[i] == p_B) || (v_learned[i - 1] == p_B && v_learned[i] == p_A));
+  }
+  bool learnedTop;
+  EXPECT_GT(pathLength(v_learned, learnedTop), length);
+
+  //so does the route between the fixed waypoints once the table is searched again
+  std::vector<Point> v_route;
+  table.rebuild(p_graph, p_mapData->getFixedWPs());
+  EXPECT_GT(table.getCost(0, 1), routeCost);
+  ASSERT_TRUE(table.findRoute(5, 30, TEST_MAP_X - 5, 35, v_route));
+  for (unsigned int i = 1; i < v_route.size(); i++)
+  {
+    bool fromA = v_route[i - 1].mXpos == p_A->getXpos() && v_route[i - 1].mYpos == p_A->getYpos();
+    bool toB = v_route[i].mXpos == p_B->getXpos() && v_route[i].mYpos == p_B->getYpos();
+    EXPECT_FALSE(fromA && toB);
+  }
+
+  //fast traversals bring the factor back down, but never below 1
+  for (unsigned int i = 0; i < 50; i++)
+  {
+    p_graph->reportTraversal(p_A->getXpos(), p_A->getYpos(), p_B->getXpos(), p_B->getYpos(), 0.5f, 0, true);
+  }
+  EXPECT_NEAR(1.0f, p_edge->getCostFactor(), 0.01f);
+  EXPECT_GE(p_edge->getCostFactor(), 1.0f);
+  p_graph->reportTraversal(p_A->getXpos(), p_A->getYpos(), p_B->getXpos(), p_B->getYpos(), 1.0f, 0, false);
+  EXPECT_GT(p_edge->getCostFactor(), 1.0f);
+
+  //the learned costs are saved with the roadmap, the start and target of other queries are not
+  std::string filePath = "/tmp/globalnav_test_roadmap.txt";
+  unsigned int nodeCount = p_graph->getNodeCount();
+  unsigned int edgeCount = p_graph->getEdgeCount();
+  std::vector<Node*> v_query;
+  ASSERT_TRUE(p_graph->findPath(10, 5, 0, 50, 55, 0, v_query));
+  ASSERT_GT(p_graph->getNodeCount(), nodeCount);
+  ASSERT_TRUE(p_graph->exportGraph(filePath));
+  Graph* p_imported = new Graph(p_mapData, roadmapTypes::Visibility_roadmap, filePath);
+  EXPECT_EQ(nodeCount, p_imported->getNodeCount());
+  EXPECT_EQ(edgeCount, p_imported->getEdgeCount());
+  EXPECT_TRUE(p_imported->returnNodeExist(10, 5) == NULL);
+  EXPECT_TRUE(p_imported->returnNodeExist(5, 30) != NULL);
+  Edge* p_importedEdge = p_imported->getEdgeBetween(p_imported->returnNodeExist(p_A->getXpos(), p_A->getYpos()),
+                                                    p_imported->returnNodeExist(p_B->getXpos(), p_B->getYpos()));
+  ASSERT_TRUE(p_importedEdge != NULL);
+  EXPECT_NEAR(p_edge->getCostFactor(), p_importedEdge->getCostFactor(), 0.001f);
+
+  //an edge through the wall, saved before the wall was built, is left out
+  std::string wallPath = "/tmp/globalnav_test_roadmap_wall.txt";
+  {
+    std::ofstream file(wallPath.c_str());
+    file << "roadmap " << roadmapTypes::Visibility_roadmap << " " << TEST_MAP_X << " " << TEST_MAP_Y << " 3 2\n";
+    file << "20 30 " << nodeTypes::Visibility_node << "\n40 30 " << nodeTypes::Visibility_node << "\n";
+    file << "20 5 " << nodeTypes::Visibility_node << "\n0 1 1\n0 2 1\n";
+  }
+  Graph* p_wall = new Graph(p_mapData, roadmapTypes::Visibility_roadmap, wallPath);
+  EXPECT_EQ(3u, p_wall->getNodeCount());
+  EXPECT_EQ(1u, p_wall->getEdgeCount());
+  EXPECT_TRUE(p_wall->getEdgeBetween(p_wall->getNode(0), p_wall->getNode(1)) == NULL);
+  std::remove(wallPath.c_str());
+  delete p_wall;
+
+  //a roadmap of another type is not imported
+  Graph* p_voronoi = new Graph(p_mapData, roadmapTypes::Voronoi_roadmap);
+  unsigned int voronoiNodes = p_voronoi->getNodeCount();
+  EXPECT_FALSE(p_voronoi->importGraph(filePath));
+  EXPECT_EQ(voronoiNodes, p_voronoi->getNodeCount());
+  EXPECT_FALSE(p_voronoi->importGraph("/tmp/globalnav_test_no_roadmap.txt"));
+  std::remove(filePath.c_str());
+
+  delete p_voronoi;
+  delete p_imported;
+  delete p_graph;
+  delete p_mapData;
+}
+
+TEST(GraphTestSuite, mapStore)
+{
+  MapStore store;
+  MapData* p_groundData = createTestMap();
+  Graph* p_ground = new Graph(p_groundData, roadmapTypes::Visibility_roadmap);
+  ASSERT_TRUE(store.addMap("ground", p_groundData, p_ground));
+  ASSERT_TRUE(store.addMap("first", createTestMap(), roadmapTypes::Visibility_roadmap));
+  Graph* p_first = store.getGraph("first");
+  ASSERT_TRUE(p_first != NULL);
+  EXPECT_TRUE(store.getGraph("second") == NULL);
+  EXPECT_EQ(2u, store.getMapNames().size());
+
+  //without a link the first floor can not be reached
+  std::vector<MapWaypoint> v_path;
+  float cost;
+  EXPECT_FALSE(store.findPath("ground", 5, 30, "first", 5, 35, v_path, cost));
+  EXPECT_FALSE(store.addLink("ground", TEST_MAP_X - 5, 35, "second", 5, 35, 1));
+  EXPECT_FALSE(store.addLink("ground", TEST_MAP_X + 5, 35, "first", 5, 35, 1));
+  ASSERT_TRUE(store.addLink("ground", TEST_MAP_X - 5, 35, "first", TEST_MAP_X - 5, 35, 50));
+  EXPECT_EQ(1u, store.getLinkCount());
+
+  //the path runs to the elevator on the ground floor and from the elevator on the first floor
+  ASSERT_TRUE(store.findPath("ground", 5, 30, "first", 5, 35, v_path, cost));
+  ASSERT_GE(v_path.size(), 4u);
+  EXPECT_EQ("ground", v_path.front().mMap);
+  EXPECT_EQ(5u, v_path.front().mXpos);
+  EXPECT_EQ("first", v_path.back().mMap);
+  EXPECT_EQ(35u, v_path.back().mYpos);
+  unsigned int switches = 0;
+  for (unsigned int i = 1; i < v_path.size(); i++)
+  {
+    if (v_path[i].mMap != v_path[i - 1].mMap)
+    {
+      switches++;
+      EXPECT_EQ(TEST_MAP_X - 5, v_path[i - 1].mXpos);
+      EXPECT_EQ(TEST_MAP_X - 5, v_path[i].mXpos);
+    }
+  }
+  EXPECT_EQ(1u, switches);
+  EXPECT_GT(cost, 50 + 2 * (TEST_MAP_X - 10) - 1);
+  float crossCost = cost;
+
+  //a query on one map does not take the link, switching maps leaves the roadmaps as they are
+  ASSERT_TRUE(store.findPath("first", 5, 30, "first", TEST_MAP_X - 5, 35, v_path, cost));
+  for (unsigned int i = 0; i < v_path.size(); i++)
+  {
+    EXPECT_EQ("first", v_path[i].mMap);
+  }
+  EXPECT_LT(cost, crossCost - 50);
+  EXPECT_TRUE(store.getGraph("first") == p_first);
+  EXPECT_TRUE(store.getGraph("ground") == p_ground);
+
+  //removing a map removes its links, a map that is not owned by the store stays
+  EXPECT_TRUE(store.removeMap("ground"));
+  EXPECT_FALSE(store.removeMap("ground"));
+  EXPECT_EQ(0u, store.getLinkCount());
+  EXPECT_FALSE(store.findPath("ground", 5, 30, "first", 5, 35, v_path, cost));
+  EXPECT_GT(p_ground->getNodeCount(), 0u);
+
+  delete p_ground;
+  delete p_groundData;
+}
+
+//whether two timed paths are at the same node at the same time, or on the same edge at overlapping times
+bool pathsMeet(const std::vector<TimedWaypoint> &v_a, const std::vector<TimedWaypoint> &v_b)
+{
+  for (unsigned int i = 0; i < v_a.size(); i++)
+  {
+    for (unsigned int j = 0; j < v_b.size(); j++)
+    {
+      if (v_a[i].p_mNode == v_b[j].p_mNode && fabs(v_a[i].mTime - v_b[j].mTime) < 0.01)
+      {
+        return true;
+      }
+      if (i == 0 || j == 0 || v_a[i - 1].p_mNode == v_a[i].p_mNode || v_b[j - 1].p_mNode == v_b[j].p_mNode)
+      {
+        continue;
+      }
+      bool same = (v_a[i - 1].p_mNode == v_b[j - 1].p_mNode && v_a[i].p_mNode == v_b[j].p_mNode)
+          || (v_a[i - 1].p_mNode == v_b[j].p_mNode && v_a[i].p_mNode == v_b[j - 1].p_mNode);
+      if (same && v_a[i - 1].mTime < v_b[j].mTime && v_b[j - 1].mTime < v_a[i].mTime)
+      {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+TEST(GraphTestSuite, reservationTable)
+{
+  MapData* p_mapData = createTestMap();
+  Graph* p_graph = new Graph(p_mapData, roadmapTypes::Visibility_roadmap);
+  ReservationTable table(0.5f, 20, 5);
+  double now = MapData::getTime();
+
+  //the first robot drives the shortest path, without waiting
+  std::vector<TimedWaypoint> v_first;
+  ASSERT_TRUE(p_graph->findTimedPath(5, 30, TEST_MAP_X - 5, 35, table, 1, now, v_first));
+  ASSERT_GE(v_first.size(), 2u);
+  EXPECT_EQ(5u, v_first.front().p_mNode->getXpos());
+  EXPECT_EQ(TEST_MAP_X - 5u, v_first.back().p_mNode->getXpos());
+  std::vector<Node*> v_path;
+  ASSERT_TRUE(p_graph->findPath(5, 30, 0, TEST_MAP_X - 5, 35, 0, v_path));
+  bool top;
+  float length = pathLength(v_path, top);
+  EXPECT_NEAR(length / 20, v_first.back().mTime - v_first.front().mTime, v_path.size() * 0.5f + 0.5f);
+  for (unsigned int i = 1; i < v_first.size(); i++)
+  {
+    EXPECT_GE(v_first[i].mTime, v_first[i - 1].mTime);
+    EXPECT_NE(v_first[i - 1].p_mNode, v_first[i].p_mNode);
+  }
+
+  //a robot coming the other way does not meet it, on a node nor head-on on an edge
+  std::vector<TimedWaypoint> v_second;
+  ASSERT_TRUE(p_graph->findTimedPath(TEST_MAP_X - 5, 35, 5, 30, table, 2, now, v_second));
+  EXPECT_FALSE(pathsMeet(v_first, v_second));
+
+  //a robot to the same target waits until the first one has left it
+  std::vector<TimedWaypoint> v_third;
+  ASSERT_TRUE(p_graph->findTimedPath(5, 31, TEST_MAP_X - 5, 35, table, 3, now, v_third));
+  EXPECT_FALSE(pathsMeet(v_first, v_third));
+  EXPECT_FALSE(pathsMeet(v_second, v_third));
+  EXPECT_GE(v_third.back().mTime, v_first.back().mTime + 5 - 0.01);
+
+  //a new query of a robot replaces its reservations, released robots leave nothing behind
+  unsigned int reservations = table.getReservationCount();
+  ASSERT_TRUE(p_graph->findTimedPath(5, 30, TEST_MAP_X - 5, 35, table, 1, now, v_first));
+  EXPECT_EQ(reservations, table.getReservationCount());
+  table.release(1);
+  table.release(2);
+  table.release(3);
+  EXPECT_EQ(0u, table.getReservationCount());
+  ASSERT_TRUE(p_graph->findTimedPath(5, 30, TEST_MAP_X - 5, 35, table, 1, now, v_first));
+  table.prune(now + 3600);
+  EXPECT_EQ(0u, table.getReservationCount());
+
+  delete p_graph;
+  delete p_mapData;
+}
+
+TEST(GraphTestSuite, mapChanges)
+{
+  MapData* p_mapData = createTestMap();
+  Graph* p_graph = new Graph(p_mapData, roadmapTypes::Visibility_roadmap);
+  std::vector<Node*> v_fixedWPs;
+  v_fixedWPs.push_back(new Node(5, 30, 0));
+  v_fixedWPs.push_back(new Node(TEST_MAP_X - 5, 35, 1));
+  p_mapData->updateFixedWPs(v_fixedWPs);
+  p_graph->updateFixedWaypoints();
+  RouteTable table;
+  table.update(p_graph, p_mapData->getFixedWPs());
+  std::vector<Node*> v_path;
+  ASSERT_TRUE(p_graph->findPath(5, 30, 0, TEST_MAP_X - 5, 35, 0, v_path));
+  bool top;
+  float length = pathLength(v_path, top);
+
+  //close the opening the path runs through on the map itself, as an edit of the map does
+  std::vector<Point> v_cells;
+  for (unsigned int y = 0; y < 10; y++)
+  {
+    for (unsigned int x = TEST_MAP_X / 2 - 1; x <= TEST_MAP_X / 2 + 1; x++)
+    {
+      Point cell(x, top ? y : TEST_MAP_Y - 1 - y);
+      if (p_mapData->setCell(cell.mXpos, cell.mYpos, 100))
+      {
+        v_cells.push_back(cell);
+      }
+    }
+  }
+  ASSERT_FALSE(v_cells.empty());
+  unsigned int blocked = p_graph->applyMapChanges(v_cells);
+  EXPECT_GT(blocked, 0u);
+  EXPECT_LT(blocked, p_graph->getEdgeCount() / 2);
+
+  std::vector<Node*> v_detour;
+  ASSERT_TRUE(p_graph->findPath(5, 30, 0, TEST_MAP_X - 5, 35, 0, v_detour));
+  bool detourTop;
+  pathLength(v_detour, detourTop);
+  EXPECT_NE(top, detourTop);
+  Line line;
+  for (unsigned int i = 1; i < v_detour.size(); i++)
+  {
+    p_mapData->Bresenham(Point(v_detour[i - 1]->getXpos(), v_detour[i - 1]->getYpos()),
+                         Point(v_detour[i]->getXpos(), v_detour[i]->getYpos()), &line);
+    EXPECT_FALSE(p_mapData->checkLineCollission(&line));
+  }
+
+  //the route between the fixed waypoints is searched again and takes the detour as well
+  std::vector<Point> v_route;
+  table.rebuild(p_graph, p_mapData->getFixedWPs());
+  ASSERT_TRUE(table.findRoute(5, 30, TEST_MAP_X - 5, 35, v_route));
+  bool routeTop = false;
+  for (unsigned int i = 1; i < v_route.size(); i++)
+  {
+    routeTop = routeTop || v_route[i].mYpos < 10;
+    p_mapData->Bresenham(v_route[i - 1], v_route[i], &line);
+    EXPECT_FALSE(p_mapData->checkLineCollission(&line));
+  }
+  EXPECT_NE(top, routeTop);
+
+  //clearing the cells again puts the same edges back
+  for (std::vector<Point>::iterator it = v_cells.begin(); it != v_cells.end(); it++)
+  {
+    EXPECT_TRUE(p_mapData->setCell((*it).mXpos, (*it).mYpos, 0));
+  }
+  EXPECT_EQ(blocked, p_graph->applyMapChanges(v_cells));
+  std::vector<Node*> v_after;
+  ASSERT_TRUE(p_graph->findPath(5, 30, 0, TEST_MAP_X - 5, 35, 0, v_after));
+  bool afterTop;
+  EXPECT_NEAR(length, pathLength(v_after, afterTop), 0.01f);
+
+  delete p_graph;
+  delete p_mapData;
+}
+
+TEST(GraphTestSuite, tiledGrid)
+{
+  //tiles of one value take no memory, copies share their tiles until they are written
+  TiledGrid<unsigned char> grid(1000, 700, 0);
+  EXPECT_EQ(0u, grid.getAllocatedTiles());
+  grid.set(999, 699, 1);
+  grid.set(10, 10, 0);
+  EXPECT_EQ(1u, grid.getAllocatedTiles());
+  TiledGrid<unsigned char> copy(grid);
+  copy.set(998, 699, 1);
+  EXPECT_EQ(0, grid.get(998, 699));
+  EXPECT_EQ(1, copy.get(998, 699));
+  EXPECT_EQ(1, copy.get(999, 699));
+  grid.set(999, 699, 0);
+  grid.compact();
+  EXPECT_EQ(0u, grid.getAllocatedTiles());
+  EXPECT_EQ(1, copy.get(999, 699));
+
+  //a large map of free space with a wall holds only the tiles along the wall, and parses as the cell list does
+  unsigned int width = 2000, height = 1500;
+  std::vector<int8_t> v_cells(width * height, 1);
+  std::vector<int> v_list(width * height, 1);
+  for (unsigned int y = 100; y < 1400; y++)
+  {
+    v_cells[y * width + 1000] = v_list[y * width + 1000] = 100;
+  }
+  MapData tiled(width, height, 1);
+  std::vector<int8_t> v_tile(TILE_CELLS);
+  for (unsigned int ty = 0; ty < (height + TILE_MASK) / TILE_SIZE; ty++)
+  {
+    for (unsigned int tx = 0; tx < (width + TILE_MASK) / TILE_SIZE; tx++)
+    {
+      bool uniform = true;
+      for (unsigned int i = 0; i < TILE_CELLS; i++)
+      {
+        unsigned int x = (tx << TILE_SHIFT) + (i & TILE_MASK), y = (ty << TILE_SHIFT) + (i >> TILE_SHIFT);
+        v_tile[i] = (x < width && y < height) ? v_cells[y * width + x] : 1;
+        uniform = uniform && v_tile[i] == v_tile[0];
+      }
+      tiled.parseOccupancyTile(tx, ty, uniform ? NULL : &v_tile[0], v_tile[0]);
+    }
+  }
+  MapData dense(width, height, 1);
+  dense.parseOccupancyList(v_list);
+  EXPECT_EQ(1399u / TILE_SIZE - 100u / TILE_SIZE + 1, tiled.getMapData().getAllocatedTiles());
+  EXPECT_EQ(dense.getMapData().getAllocatedTiles(), tiled.getMapData().getAllocatedTiles());
+  for (unsigned int y = 0; y <= height; y += 7)
+  {
+    for (unsigned int x = 995; x <= 1005; x++)
+    {
+      EXPECT_EQ(dense.getCell(x, y), tiled.getCell(x, y));
+    }
+  }
+  EXPECT_TRUE(tiled.checkCCollision(1000, 700));
+  EXPECT_FALSE(tiled.checkCCollision(1001, 700));
+}
+
+TEST(GraphTestSuite, mapPyramid)
+{
+  //a wall across the map with a passage at the far end
+  unsigned int width = 400, height = 300;
+  std::vector<int> v_list(width * height, 1);
+  for (unsigned int y = 0; y < 250; y++)
+  {
+    v_list[y * width + 200] = 100;
+  }
+  MapData mapData(width, height, 1);
+  mapData.parseOccupancyList(v_list);
+  mapData.buildPyramid(5);
+  const MapPyramid &pyramid = mapData.getPyramid();
+  ASSERT_EQ(5u, pyramid.getLevels());
+  EXPECT_EQ((width + 1 + 15) / 16, pyramid.getWidth(4));
+
+  //a coarse cell is occupied when any of its map cells is
+  for (unsigned int level = 1; level < pyramid.getLevels(); level++)
+  {
+    for (unsigned int y = 0; y < pyramid.getHeight(level); y++)
+    {
+      for (unsigned int x = 0; x < pyramid.getWidth(level); x++)
+      {
+        bool occupied = false;
+        for (unsigned int my = y << level; my < ((y + 1) << level) && my <= height; my++)
+        {
+          for (unsigned int mx = x << level; mx < ((x + 1) << level) && mx <= width; mx++)
+          {
+            occupied = occupied || mapData.getCell(mx, my) == spaceType::Object;
+          }
+        }
+        ASSERT_EQ(occupied, pyramid.isOccupied(level, x, y));
+      }
+    }
+  }
+  mapData.setCell(100, 100, 100);
+  EXPECT_TRUE(pyramid.isOccupied(4, 6, 6));
+  mapData.setCell(100, 100, 0);
+  EXPECT_FALSE(pyramid.isOccupied(4, 6, 6));
+
+  //the coarse-to-fine path is about as long as the shortest grid path, and expands far fewer cells
+  GridGraph grid(&mapData);
+  AStarSearch<GridGraph, OctileHeuristic, float> search(grid);
+  unsigned int start = grid.getVertex(20, 20);
+  unsigned int target = grid.getVertex(380, 20);
+  ASSERT_TRUE(search.search(start, target));
+  CoarseToFineSearch coarseToFine(grid, pyramid);
+  ThetaStar sight(grid);
+  ASSERT_TRUE(coarseToFine.search(20, 20, 380, 20));
+  EXPECT_EQ(4u, coarseToFine.getLevel());
+  EXPECT_LT(coarseToFine.getExpanded(), search.getExpanded() / 2);
+  EXPECT_LT(coarseToFine.getCost(), search.getCost(target) * 1.05f);
+  const std::vector<Point> &v_path = coarseToFine.getPath();
+  EXPECT_EQ(20u, v_path.front().mXpos);
+  EXPECT_EQ(380u, v_path.back().mXpos);
+  for (unsigned int i = 1; i < v_path.size(); i++)
+  {
+    EXPECT_TRUE(sight.lineOfSight(grid.getVertex(v_path[i - 1].mXpos, v_path[i - 1].mYpos),
+                                  grid.getVertex(v_path[i].mXpos, v_path[i].mYpos)));
+  }
+
+  //a passage of two cells is closed on the coarser levels, the search falls back to the level that keeps it open
+  for (unsigned int y = 250; y <= height; y++)
+  {
+    mapData.setCell(200, y, y == 270 || y == 271 ? 0 : 100);
+  }
+  grid.build(&mapData);
+  ASSERT_TRUE(coarseToFine.search(20, 20, 380, 20));
+  EXPECT_EQ(1u, coarseToFine.getLevel());
+  EXPECT_EQ(380u, coarseToFine.getPath().back().mXpos);
+}
+
+TEST(GraphTestSuite, parallelGridBuild)
+{
+  //random objects on a map that is not a whole number of tiles, built in bands by several threads
+  unsigned int width = 300, height = 211;
+  std::vector<int> v_list(width * height, 1);
+  srand(7);
+  for (unsigned int i = 0; i < 400; i++)
+  {
+    v_list[rand() % (width * height)] = 100;
+  }
+  MapData mapData(width, height, 1);
+  mapData.parseOccupancyList(v_list);
+
+  for (unsigned int inflation = 0; inflation < 4; inflation++)
+  {
+    //every object blocks the disc of radius inflation around it
+    std::vector<unsigned char> v_expected(width * height, 0);
+    int radius = inflation;
+    for (int y = 0; y < int(height); y++)
+    {
+      for (int x = 0; x < int(width); x++)
+      {
+        if (mapData.getCell(x, y) != spaceType::Object)
+        {
+          continue;
+        }
+        for (int dy = -radius; dy <= radius; dy++)
+        {
+          for (int dx = -radius; dx <= radius; dx++)
+          {
+            if (dx * dx + dy * dy <= radius * radius && x + dx >= 0 && y + dy >= 0 && x + dx < int(width)
+                && y + dy < int(height))
+            {
+              v_expected[(y + dy) * width + x + dx] = 1;
+            }
+          }
+        }
+      }
+    }
+    for (unsigned int threads = 1; threads <= 4; threads += 3)
+    {
+      GridGraph grid(&mapData, inflation, threads);
+      ASSERT_EQ(width * height, grid.size());
+      for (unsigned int v = 0; v < grid.size(); v++)
+      {
+        ASSERT_EQ(v_expected[v] != 0, grid.isBlocked(v)) << "cell " << grid.getX(v) << ", " << grid.getY(v);
+      }
+    }
+  }
+}
+
+TEST(GraphTestSuite, environmentStore)
+{
+  std::string filePath = "/tmp/globalnav_test_environment.store";
+  std::remove(filePath.c_str());
+  EnvironmentStore store;
+  ASSERT_TRUE(store.open(filePath)); //a store that does not exist yet is empty
+  EXPECT_EQ(0u, store.getMapCount());
+  StoredMap map;
+  EXPECT_FALSE(store.getCurrentMap(map));
+
+  //maps are kept sorted by name, the last one stored as current is loaded at startup
+  const char* names[] = {"office", "hallway", "lab"};
+  for (unsigned int i = 0; i < 3; i++)
+  {
+    StoredMap stored;
+    stored.name = names[i];
+    stored.mapFile = std::string("/maps/") + names[i] + ".map";
+    stored.roadmapFile = std::string("roadmap_") + names[i] + ".txt";
+    stored.mapSize = 1000 + i;
+    stored.mapTime = 2000 + i;
+    for (unsigned int w = 0; w <= i; w++)
+    {
+      StoredWaypoint waypoint = {float(10 * i + w), float(w), 0.5f};
+      stored.v_waypoints.push_back(waypoint);
+    }
+    ASSERT_TRUE(store.putMap(stored, i == 1));
+  }
+
+  //everything is read back from the mapped file after a restart
+  EnvironmentStore reopened;
+  ASSERT_TRUE(reopened.open(filePath));
+  EXPECT_EQ(3u, reopened.getMapCount());
+  ASSERT_TRUE(reopened.getCurrentMap(map));
+  EXPECT_EQ("hallway", map.name);
+  EXPECT_EQ("/maps/hallway.map", map.mapFile);
+  ASSERT_EQ(2u, map.v_waypoints.size());
+  EXPECT_EQ(11, map.v_waypoints[1].x);
+  ASSERT_TRUE(reopened.findMap("lab", map));
+  EXPECT_EQ("roadmap_lab.txt", map.roadmapFile);
+  EXPECT_EQ(1002, map.mapSize);
+  EXPECT_EQ(2002, map.mapTime);
+  EXPECT_EQ(3u, map.v_waypoints.size());
+  EXPECT_FALSE(reopened.findMap("garage", map));
+
+  //replacing the waypoints of a map leaves the others in place
+  ASSERT_TRUE(reopened.findMap("office", map));
+  map.v_waypoints.clear();
+  ASSERT_TRUE(reopened.putMap(map, false));
+  ASSERT_TRUE(reopened.findMap("office", map));
+  EXPECT_TRUE(map.v_waypoints.empty());
+  ASSERT_TRUE(reopened.findMap("lab", map));
+  EXPECT_EQ(3u, map.v_waypoints.size());
+  ASSERT_TRUE(reopened.getCurrentMap(map));
+  EXPECT_EQ("hallway", map.name);
+
+  //maps with the same file name in different directories are stored under different names
+  std::string officeName = EnvironmentStore::mapName("/maps/office.map");
+  EXPECT_EQ(0u, officeName.find("office_"));
+  EXPECT_NE(officeName, EnvironmentStore::mapName("/maps/old/office.map"));
+  EXPECT_EQ(officeName, EnvironmentStore::mapName("/maps/office.map"));
+  EXPECT_EQ(0u, EnvironmentStore::mapName("/maps/floor.2.map").find("floor_2_"));
+  EXPECT_LT(EnvironmentStore::mapName("/maps/" + std::string(200, 'a') + ".map").size(), size_t(STORE_NAME_SIZE));
+
+  //the waypoints of a map belong to its file as it was stored
+  std::string mapPath = "/tmp/globalnav_test_environment.map";
+  FILE* p_file = fopen(mapPath.c_str(), "w");
+  fputs("map", p_file);
+  fclose(p_file);
+  map.mapFile = mapPath;
+  ASSERT_TRUE(EnvironmentStore::statMapFile(map));
+  EXPECT_EQ(3, map.mapSize);
+  EXPECT_TRUE(EnvironmentStore::isUnchanged(map));
+  p_file = fopen(mapPath.c_str(), "w");
+  fputs("another map", p_file);
+  fclose(p_file);
+  EXPECT_FALSE(EnvironmentStore::isUnchanged(map));
+  std::remove(mapPath.c_str());
+  EXPECT_FALSE(EnvironmentStore::isUnchanged(map));
+
+  //a file that is not a store is ignored
+  p_file = fopen(filePath.c_str(), "w");
+  fputs("not a store, but long enough for a header", p_file);
+  fclose(p_file);
+  EXPECT_FALSE(reopened.open(filePath));
+  EXPECT_EQ(0u, reopened.getMapCount());
+  std::remove(filePath.c_str());
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -48,6 +48,15 @@ class MapData():
 	def getOccupancyAt(self,x,y):
 		return self.data[y*self.xdim+x]
 		
+	#set the cells of a list of CellRun msgs
+	def applyRuns(self,runs):
+		self.data = list(self.data)
+		for run in runs:
+			if run.y < self.ydim and run.x < self.xdim:
+				start = run.y*self.xdim+run.x
+				length = min(run.length, self.xdim-run.x)
+				self.data[start:start+length] = [run.value]*length
+		
 class Waypoint():
 	def __init__(self,x,y,theta,name,type):
 		self.x = x
@@ -75,6 +84,7 @@ class GlobalNavGUI(QWidget):
 	#signals
 	sigPathUpdate = QtCore.pyqtSignal(object)
 	sigDebugOut = QtCore.pyqtSignal(object)
+	sigMapPatch = QtCore.pyqtSignal(object)
 	
 	def __init__(self):
 		super(GlobalNavGUI, self).__init__()
@@ -98,12 +108,14 @@ class GlobalNavGUI(QWidget):
 		#signal subscribers
 		self.sigPathUpdate.connect(self.updatePath)
 		self.sigDebugOut.connect(self.debugOutput)		
+		self.sigMapPatch.connect(self.applyMapPatch)
 		self._widget.start_searcher.currentIndexChanged.connect(self.setCoordsStart)
 		self._widget.target_searcher.currentIndexChanged.connect(self.setCoordsTarget)
 
 		#ROS subscribers
 		rospy.Subscriber("/globalnav/waypoints", Path, self.updatePathCallback)
 		rospy.Subscriber("rosout_agg",Log, self.debugOutCallback)
+		rospy.Subscriber("/globalnav/map_updates", MapPatch, self.mapPatchCallback)
 		
 		#ROS publishers		
 		self.query_pub = rospy.Publisher('/globalnav/user_input_query',user_input_query)	
@@ -115,6 +127,7 @@ class GlobalNavGUI(QWidget):
 		self.loadNewMap_srv = rospy.ServiceProxy('/globalnav/update_map_req',mapreader_srv)
 		self.updateFixedWaypoints_srv = rospy.ServiceProxy('/globalnav/edit_fixedWPs',edit_fixedWPs_srv)
 		self.getPath_query_srv = rospy.ServiceProxy('/globalnav/path_query',path_query_srv)
+		self.getMapChanges_srv = rospy.ServiceProxy('/globalnav/map_changes',map_changes_srv)
 
 		#button handlers
 		self._widget.GO_button.clicked.connect(self.sendQuery)
@@ -225,6 +238,8 @@ class GlobalNavGUI(QWidget):
 				
 				self._widget.info_textbox.append("Map dimensions x%d * y%d, measured in absolute gridcells" %(xdim,ydim))
 				self.mapdata = MapData(xdim,ydim,res,ret.map.data)
+				self.mapVersion = ret.version
+				self.mapEdit = 0
 				
 				self.updateView(xdim,ydim,fileName)
 
@@ -258,6 +273,30 @@ class GlobalNavGUI(QWidget):
 		if hasattr(self, "mapdata"):
 			self.sigPathUpdate.emit(path)
 		
+	def mapPatchCallback(self,patch):
+		if hasattr(self, "mapdata"):
+			self.sigMapPatch.emit(patch)
+			
+	#on receiving an edit of the map, patch the drawn map. when patches were missed, fetch the changes since
+	def applyMapPatch(self,patch):
+		if patch.map_version != self.mapVersion or patch.to_edit <= self.mapEdit:
+			return
+		if patch.from_edit == self.mapEdit:
+			self.mapdata.applyRuns(patch.runs)
+			self.mapEdit = patch.to_edit
+		else:
+			try:
+				ret = self.getMapChanges_srv(self.mapVersion, self.mapEdit)
+				if ret.full:
+					return
+				self.mapdata.applyRuns(ret.runs)
+				self.mapEdit = ret.edit
+			except rospy.ServiceException, e:
+				self._widget.debug_textbrowser.append("Service call failed: %s"%e)
+				return
+		self.gScene.resetMap()
+		self.drawEnvironmentMap()
+		
 	#on receiving new path data, redraw the path
 	def updatePath(self,path):
 		self.gScene.resetMap()
@@ -419,6 +458,8 @@ class GlobalNavGUI(QWidget):
 				
 				self._widget.info_textbox.append("Map dimensions x%d * y%d, measured in absolute gridcells" %(xdim,ydim))
 				self.mapdata = MapData(xdim,ydim,res,ret.map.data)
+				self.mapVersion = ret.version
+				self.mapEdit = 0
 				
 				self.updateView(xdim,ydim,fileName)
 				
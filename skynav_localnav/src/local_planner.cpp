@@ -160,6 +160,21 @@ bool servServerPclWaypointCheckCallback(skynav_msgs::waypoint_check::Request &re
 		nwTargetPoint.x = (*newPoint).x;
 		nwTargetPoint.y = (*newPoint).y;
 		resp.newPos = nwTargetPoint;
+
+		//the outlines let global_planner repair the whole path around the objects
+		boost::mutex::scoped_lock lock(mMutex);
+		for(Pcl2Vector::iterator outlineIt = mClusterOutlines.begin(); outlineIt!= mClusterOutlines.end(); ++outlineIt)
+		{
+			pcl::PointCloud<pcl::PointXYZ> cloud;
+			pcl::fromPCLPointCloud2((*outlineIt), cloud);
+			for(pcl::PointCloud<pcl::PointXYZ>::iterator pointIt = cloud.begin(); pointIt != cloud.end(); ++pointIt)
+			{
+				geometry_msgs::Point obstacle;
+				obstacle.x = (*pointIt).x;
+				obstacle.y = (*pointIt).y;
+				resp.obstacles.push_back(obstacle);
+			}
+		}
 		
 		ROS_INFO("New waypoint at(%f,%f)",resp.newPos.x, resp.newPos.y);
 		return true;
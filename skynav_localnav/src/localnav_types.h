@@ -6,6 +6,7 @@
 
 typedef std::vector<pcl::PointCloud<pcl::PointXYZ>, Eigen::aligned_allocator<pcl::PointCloud<pcl::PointXYZ> > > PclXYZVector;
 typedef std::vector<pcl::PCLPointCloud2, Eigen::aligned_allocator<pcl::PCLPointCloud2> > Pcl2Vector;
+typedef std::vector<pcl::PointCloud<pcl::PointXYZ>::ConstPtr> PclXYZPtrVector;	//shared clouds, as received
 
 typedef boost::optional<pcl::PointXYZ> pclOptionPoint;
 
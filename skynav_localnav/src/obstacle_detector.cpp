@@ -11,24 +11,23 @@ ros::ServiceClient servClientCurrentPose;
 
 tf::TransformListener* mTransformListener;
 
-Pcl2Vector mCloudSet;		//the set of pointclouds received in one loop
+PclXYZPtrVector mCloudSet;		//the set of pointclouds received in one loop, shared with the subscriber
+pcl::PointCloud<pcl::PointXYZ>::Ptr mEnvironmentCloud (new pcl::PointCloud<pcl::PointXYZ>);	//the clouds of a loop in one, its memory is reused by the next loop
 
 boost::mutex mMutex;
 
 //output a pointcloud to a PCD file
-void writeOutputPCD(const pcl::PCLPointCloud2& inputCloud)
+void writeOutputPCD(const pcl::PointCloud<pcl::PointXYZ>& inputCloud)
 {	
 	//dont do anything and return when empty input
-	if((inputCloud.width * inputCloud.height)==0)
+	if(inputCloud.empty())
 	{
 		//ROS_WARN("empty inputcloud, nothing to be done");
 		return;
 	}
 	
-	pcl::PointCloud<pcl::PointXYZ>::Ptr cloud (new pcl::PointCloud<pcl::PointXYZ>);
-	pcl::fromPCLPointCloud2(inputCloud, *cloud);
 	try{
-		pcl::io::savePCDFileASCII (ros::package::getPath("skynav_localnav")+"/export/EXPORT.pcd", *cloud);
+		pcl::io::savePCDFileASCII (ros::package::getPath("skynav_localnav")+"/export/EXPORT.pcd", inputCloud);
 	}catch(std::exception& e){
 		ROS_ERROR("obstacle_detector %s",e.what());
 	}	
@@ -52,56 +51,56 @@ void publishObjects()
 		return;
 	}	
 	
+	ros::WallTime start = ros::WallTime::now();
+
 	//declare pointclouds
-	pcl::PCLPointCloud2 cloud;	
-	pcl::PCLPointCloud2 cloud_filtered;
-	Pcl2Vector cloud_clusters;
+	pcl::PointCloud<pcl::PointXYZ>::Ptr cloud = mEnvironmentCloud;
+	pcl::PointCloud<pcl::PointXYZ>::Ptr cloud_filtered (new pcl::PointCloud<pcl::PointXYZ>);
+	PclXYZVector cloud_clusters;
 	skynav_msgs::PointCloudVector msg;
 
 	//construct full pointcloud and apply filter(s)
-	cloud = constructEnvironmentCloud(mCloudSet);	
-	cloud_filtered = voxelfilter(cloud);	
+	constructEnvironmentCloud(mCloudSet, *cloud);
+	voxelfilter(cloud, *cloud_filtered);
 
-	//publish pointclouds
-	cloud.header.frame_id = "/map";		
-	cloud_filtered.header.frame_id = "/map";		
-	pubCloudRaw.publish(cloud);
-	pubCloud.publish(cloud_filtered);
+	//publish pointclouds, each is serialised once by the publisher
+	cloud->header.frame_id = "/map";		
+	cloud_filtered->header.frame_id = "/map";		
+	pubCloudRaw.publish(*cloud);
+	pubCloud.publish(*cloud_filtered);
 
 	//extract and publish an message with clusters, for local planner purpose
-	cloud_clusters = extractClusters(cloud_filtered);
+	extractClusters(cloud_filtered, cloud_clusters);
 	
-	//TODO these converstions are dirty and unwanted!
-	for(Pcl2Vector::iterator it = cloud_clusters.begin();it!=cloud_clusters.end();++it)
+	msg.clouds.resize(cloud_clusters.size());
+	for(size_t i = 0; i < cloud_clusters.size(); i++)
 	{
-		pcl::PointCloud<pcl::PointXYZ>::Ptr pclPC (new pcl::PointCloud<pcl::PointXYZ>);
-		sensor_msgs::PointCloud2 cluster;
-		pcl::fromPCLPointCloud2((*it), *pclPC);
-		pcl::toROSMsg(*pclPC, cluster);
-		
-		msg.clouds.push_back(cluster);
-		pubClusters.publish(cluster);
+		pcl::toROSMsg(cloud_clusters[i], msg.clouds[i]);
+		pubClusters.publish(msg.clouds[i]);
 	}
 	pubPCVector.publish(msg);
+
+	ROS_DEBUG("obstacle_detector: %zu clouds, %zu points, %zu clusters in %.3f ms", mCloudSet.size(), cloud->size(),
+			cloud_clusters.size(), (ros::WallTime::now() - start).toSec() * 1000);
 		
 	//clean up data
 	forgetObjects();	
 
 //----FOR TESTING PURPOSES-----
 	//write cloud to pcd file		
-	//writeOutputPCD(cloud);
+	//writeOutputPCD(*cloud);
 //-----------------------------	
 }
 
 
-//add the inputCloud to the global vector of pointclouds
-void addToEnvironmentCloudSet(const pcl::PCLPointCloud2& inputCloud){
+//add the inputCloud to the global vector of pointclouds, the cloud is shared and not copied
+void addToEnvironmentCloudSet(const pcl::PointCloud<pcl::PointXYZ>::ConstPtr& inputCloud){
 	boost::mutex::scoped_lock lock(mMutex);
 	mCloudSet.push_back(inputCloud);
 }
 
 
-/* subscribe on the sensor_msgs::PointCloud2 publisher, upon recieve convert to pcl::PCLPointCLoud2.
+/* subscribe on the sensor_msgs::PointCloud2 publisher, upon recieve convert to pcl::PointCloud<pcl::PointXYZ>.
  * determine and devide the cloud in multiple clusters for further use.
  *  
  * note on pcl conversion
@@ -110,9 +109,9 @@ void addToEnvironmentCloudSet(const pcl::PCLPointCloud2& inputCloud){
  * is done on the fly by the subscriber."
  * source: http://wiki.ros.org/pcl/Overview
  */
-void subPointCloudDataCallback(const pcl::PCLPointCloud2ConstPtr& msg) 
+void subPointCloudDataCallback(const pcl::PointCloud<pcl::PointXYZ>::ConstPtr& msg) 
 {
-	addToEnvironmentCloudSet(*msg);	
+	addToEnvironmentCloudSet(msg);	
 }
 
 
@@ -126,9 +125,9 @@ int main(int argc, char **argv)
     //pubs
     pubPCVector = n.advertise<skynav_msgs::PointCloudVector>("pointcloudVector",1);
     
-    pubCloud 	= 	n.advertise<pcl::PCLPointCloud2>("pointCloudData",10);
-    pubCloudRaw = 	n.advertise<pcl::PCLPointCloud2>("pointCloudDataRaw",10);
-    pubClusters = 	n.advertise<pcl::PCLPointCloud2>("pointCloudDataClusters",10);
+    pubCloud 	= 	n.advertise<pcl::PointCloud<pcl::PointXYZ> >("pointCloudData",10);
+    pubCloudRaw = 	n.advertise<pcl::PointCloud<pcl::PointXYZ> >("pointCloudDataRaw",10);
+    pubClusters = 	n.advertise<sensor_msgs::PointCloud2>("pointCloudDataClusters",10);
 
     //subs
 	ros::Subscriber subSensorCloud = n_control.subscribe("cloud", 10, subPointCloudDataCallback);
@@ -16,6 +16,7 @@
 #include <pcl/ModelCoefficients.h>
 #include <pcl/filters/project_inliers.h>
 #include <pcl/io/pcd_io.h>
+#include <pcl/common/io.h>
 #include <pcl_conversions/pcl_conversions.h>
 #include <pcl/PCLPointCloud2.h>
 
@@ -23,15 +24,19 @@
 
 #include "localnav_types.h"
 
-pcl::PCLPointCloud2 voxelfilter(const pcl::PCLPointCloud2& inputCloud);
+/*
+ * the obstacle detection works on pcl::PointCloud<pcl::PointXYZ> throughout: the clouds are deserialised once when
+ * they are received and serialised once for every cloud that is published
+ */
+void voxelfilter(const pcl::PointCloud<pcl::PointXYZ>::ConstPtr& inputCloud, pcl::PointCloud<pcl::PointXYZ>& outputCloud);
 
-Pcl2Vector extractClusters(const pcl::PCLPointCloud2& inputCloud);
+void extractClusters(const pcl::PointCloud<pcl::PointXYZ>::ConstPtr& inputCloud, PclXYZVector& outputClusters);
 
-pcl::PCLPointCloud2 concatinateClouds(const pcl::PCLPointCloud2& inputCloudA, const pcl::PCLPointCloud2& inputCloudB);
+pcl::PointCloud<pcl::PointXYZ> concatinateClouds(const pcl::PointCloud<pcl::PointXYZ>& inputCloudA, const pcl::PointCloud<pcl::PointXYZ>& inputCloudB);
 
-pcl::PCLPointCloud2 projectOnXYPlane(const pcl::PCLPointCloud2& inputCloud);
+void projectOnXYPlane(const pcl::PointCloud<pcl::PointXYZ>::ConstPtr& inputCloud, pcl::PointCloud<pcl::PointXYZ>& outputCloud);
 
-pcl::PCLPointCloud2 constructEnvironmentCloud(const Pcl2Vector& cloudSet);
+void constructEnvironmentCloud(const PclXYZPtrVector& cloudSet, pcl::PointCloud<pcl::PointXYZ>& cloud);
 
 
 #endif
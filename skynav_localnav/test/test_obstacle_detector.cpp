@@ -50,7 +50,10 @@ TEST(ObstacleDetector_LibTestSuite, voxelFilter)
 TEST(ObstacleDetector_LibTestSuite, extract_clusters)
 {    
 	pcl::PCLPointCloud2 input = read(ros::package::getPath("skynav_tests")+"/include/EXPORT8.pcd");  
-	Pcl2Vector clusters = extractClusters(input);  
+	pcl::PointCloud<pcl::PointXYZ>::Ptr cloud (new pcl::PointCloud<pcl::PointXYZ>);
+	pcl::fromPCLPointCloud2(input, *cloud);
+	PclXYZVector clusters;
+	extractClusters(cloud, clusters);  
     EXPECT_EQ(27, clusters.size() );
 }
 
@@ -63,8 +66,26 @@ TEST(ObstacleDetector_LibTestSuite, environmentcloud_reconstruct)
 	pcl::PCLPointCloud2 input4 = read(ros::package::getPath("skynav_tests")+"/include/EXPORT4.pcd");  
 	pcl::PCLPointCloud2 input5 = read(ros::package::getPath("skynav_tests")+"/include/EXPORT5.pcd");  
 
-    //pass
-    //EXPECT_TRUE();
+	PclXYZPtrVector cloudSet;
+	size_t points = 0;
+	const pcl::PCLPointCloud2* inputs[] = {&input, &input2, &input3, &input4, &input5};
+	for (int i = 0; i < 5; i++)
+	{
+		pcl::PointCloud<pcl::PointXYZ>::Ptr cloud (new pcl::PointCloud<pcl::PointXYZ>);
+		pcl::fromPCLPointCloud2(*inputs[i], *cloud);
+		points += cloud->size();
+		cloudSet.push_back(cloud);
+	}
+	pcl::PointCloud<pcl::PointXYZ> environment;
+	constructEnvironmentCloud(cloudSet, environment);
+	ASSERT_EQ(points, environment.size());
+	EXPECT_EQ(points, environment.width * environment.height);
+	EXPECT_EQ(cloudSet[4]->points.back().x, environment.points.back().x);
+
+	//the buffer is reused, a smaller set leaves only its own points
+	cloudSet.resize(1);
+	constructEnvironmentCloud(cloudSet, environment);
+	EXPECT_EQ(cloudSet[0]->size(), environment.size());
 }
 
 
@@ -0,0 +1,278 @@
+/*
+ * shared_map.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef SHARED_MAP_H_
+#define SHARED_MAP_H_
+
+#include <string>
+#include <cstring>
+#include <cstdio>
+#include <stdint.h>
+#include <vector>
+#include <algorithm>
+#include <boost/interprocess/shared_memory_object.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+/*
+ * an occupancy grid in a named shared memory segment, written once by map_reader and mapped by the nodes that use
+ * the map, so the cells are neither copied nor serialised on their way. the services pass the name and version.
+ *
+ * the cells are stored in square tiles. a tile whose cells in the map all have one value is stored as that value
+ * only, so a site map of mostly free or unknown space takes memory for its detail instead of its area. after the
+ * header come the slot of every tile (0 for a tile of one value), the value of every such tile, and then the cells
+ * of the other tiles, row by row within each tile. cells of a tile beyond the edge of the map are 0.
+ *
+ * every map gets a segment of its own, named after its version. map_reader removes the segment of the previous map
+ * when it loads a new one: nodes that still have it mapped keep their view, new opens fail and ask for the new map.
+ */
+const char SHARED_MAP_MAGIC[8] = {'S', 'K', 'Y', 'N', 'A', 'V', 'T', 'M'};
+
+#define SHARED_MAP_TILE_SHIFT 6	//2^6 cells along the side of a tile
+#define SHARED_MAP_TILE_SIZE (1u << SHARED_MAP_TILE_SHIFT)
+#define SHARED_MAP_TILE_MASK (SHARED_MAP_TILE_SIZE - 1)
+#define SHARED_MAP_TILE_CELLS (SHARED_MAP_TILE_SIZE * SHARED_MAP_TILE_SIZE)
+
+struct Shared_Map_Header {
+	char magic[8];
+	uint32_t version;
+	uint32_t width;
+	uint32_t height;
+	float resolution;
+	uint32_t tilesX;
+	uint32_t tilesY;
+	uint32_t tileCount;	//tiles that hold their cells
+};
+
+class Shared_Map {
+private:
+	boost::interprocess::mapped_region region_;
+	std::string name_;
+
+	Shared_Map_Header* header() const {
+		return (Shared_Map_Header*) region_.get_address();
+	}
+
+	static size_t tableSize(size_t tiles) {
+		return (sizeof(Shared_Map_Header) + tiles * (sizeof(uint32_t) + 1) + 7) & ~size_t(7);
+	}
+
+	uint32_t* slots() const {
+		return (uint32_t*) ((char*) region_.get_address() + sizeof(Shared_Map_Header));
+	}
+
+	int8_t* uniforms() const {
+		return (int8_t*) (slots() + header()->tilesX * header()->tilesY);
+	}
+
+	int8_t* tileCells(uint32_t slot) const {
+		return (int8_t*) region_.get_address() + tableSize(header()->tilesX * header()->tilesY)
+				+ size_t(slot - 1) * SHARED_MAP_TILE_CELLS;
+	}
+
+	//whether the cells of a tile that lie on the map all have one value
+	static bool uniformTile(const int8_t* p_cells, uint32_t width, uint32_t height, uint32_t tx, uint32_t ty,
+			int8_t &value) {
+		uint32_t x0 = tx << SHARED_MAP_TILE_SHIFT;
+		uint32_t y0 = ty << SHARED_MAP_TILE_SHIFT;
+		uint32_t x1 = std::min(width, x0 + SHARED_MAP_TILE_SIZE);
+		uint32_t y1 = std::min(height, y0 + SHARED_MAP_TILE_SIZE);
+		value = p_cells[size_t(y0) * width + x0];
+		for (uint32_t y = y0; y < y1; y++) {
+			const int8_t* p_row = p_cells + size_t(y) * width;
+			for (uint32_t x = x0; x < x1; x++) {
+				if (p_row[x] != value) {
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+public:
+	Shared_Map() {
+	}
+	virtual ~Shared_Map() {
+	}
+
+	static std::string segmentName(uint32_t version) {
+		char name[32];
+		snprintf(name, sizeof(name), "skynav_map_%u", version);
+		return name;
+	}
+
+	static void remove(const std::string &name) {
+		boost::interprocess::shared_memory_object::remove(name.c_str());
+	}
+
+	/*
+	 * create the segment of a new map from its cells, row by row. the tiles of one value are found first, the
+	 * segment only holds the cells of the others. a segment with the same name that was left behind is replaced
+	 */
+	bool create(uint32_t version, uint32_t width, uint32_t height, float resolution, const int8_t* p_cells) {
+		using namespace boost::interprocess;
+		uint32_t tilesX = (width + SHARED_MAP_TILE_MASK) >> SHARED_MAP_TILE_SHIFT;
+		uint32_t tilesY = (height + SHARED_MAP_TILE_MASK) >> SHARED_MAP_TILE_SHIFT;
+		std::vector<int8_t> uniform(size_t(tilesX) * tilesY);
+		std::vector<uint32_t> slot(size_t(tilesX) * tilesY, 0);
+		uint32_t tileCount = 0;
+		for (uint32_t ty = 0; ty < tilesY; ty++) {
+			for (uint32_t tx = 0; tx < tilesX; tx++) {
+				size_t t = size_t(ty) * tilesX + tx;
+				if (!uniformTile(p_cells, width, height, tx, ty, uniform[t])) {
+					slot[t] = ++tileCount;
+				}
+			}
+		}
+
+		std::string name = segmentName(version);
+		remove(name);
+		try {
+			shared_memory_object segment(create_only, name.c_str(), read_write);
+			segment.truncate(tableSize(slot.size()) + size_t(tileCount) * SHARED_MAP_TILE_CELLS);
+			mapped_region region(segment, read_write);
+			region_.swap(region);
+		} catch (interprocess_exception &e) {
+			return false;
+		}
+		name_ = name;
+		memcpy(header()->magic, SHARED_MAP_MAGIC, sizeof(SHARED_MAP_MAGIC));
+		header()->version = version;
+		header()->width = width;
+		header()->height = height;
+		header()->resolution = resolution;
+		header()->tilesX = tilesX;
+		header()->tilesY = tilesY;
+		header()->tileCount = tileCount;
+		if (!slot.empty()) {
+			memcpy(slots(), &slot[0], slot.size() * sizeof(uint32_t));
+			memcpy(uniforms(), &uniform[0], uniform.size());
+		}
+
+		//the segment is zero filled, only the cells on the map are copied
+		for (size_t t = 0; t < slot.size(); t++) {
+			if (slot[t] == 0) {
+				continue;
+			}
+			uint32_t x0 = (t % tilesX) << SHARED_MAP_TILE_SHIFT;
+			uint32_t y0 = (t / tilesX) << SHARED_MAP_TILE_SHIFT;
+			uint32_t columns = std::min(width - x0, SHARED_MAP_TILE_SIZE);
+			uint32_t rows = std::min(height - y0, SHARED_MAP_TILE_SIZE);
+			int8_t* p_tile = tileCells(slot[t]);
+			for (uint32_t y = 0; y < rows; y++) {
+				memcpy(p_tile + (y << SHARED_MAP_TILE_SHIFT), p_cells + size_t(y0 + y) * width + x0, columns);
+			}
+		}
+		return true;
+	}
+
+	//map the segment of a map read-only. false if it is gone, or holds another version
+	bool open(const std::string &name, uint32_t version) {
+		using namespace boost::interprocess;
+		try {
+			shared_memory_object segment(open_only, name.c_str(), read_only);
+			mapped_region region(segment, read_only);
+			if (region.get_size() < sizeof(Shared_Map_Header)) {
+				return false;
+			}
+			region_.swap(region);
+		} catch (interprocess_exception &e) {
+			return false;
+		}
+		name_ = name;
+		if (memcmp(header()->magic, SHARED_MAP_MAGIC, sizeof(SHARED_MAP_MAGIC)) != 0 || header()->version != version
+				|| region_.get_size() < tableSize(size_t(header()->tilesX) * header()->tilesY)
+						+ size_t(header()->tileCount) * SHARED_MAP_TILE_CELLS) {
+			close();
+			return false;
+		}
+		return true;
+	}
+
+	//unmap the segment, it stays in place for the other nodes
+	void close() {
+		boost::interprocess::mapped_region region;
+		region_.swap(region);
+		name_.clear();
+	}
+
+	bool isOpen() const {
+		return region_.get_address() != NULL;
+	}
+
+	const std::string& getName() const {
+		return name_;
+	}
+
+	uint32_t getVersion() const {
+		return header()->version;
+	}
+
+	uint32_t getWidth() const {
+		return header()->width;
+	}
+
+	uint32_t getHeight() const {
+		return header()->height;
+	}
+
+	float getResolution() const {
+		return header()->resolution;
+	}
+
+	uint32_t getTilesX() const {
+		return header()->tilesX;
+	}
+
+	uint32_t getTilesY() const {
+		return header()->tilesY;
+	}
+
+	uint32_t getTileCount() const {
+		return header()->tileCount;
+	}
+
+	//the cells of a tile row by row, NULL when all its cells on the map have the value getUniform()
+	const int8_t* getTile(uint32_t tx, uint32_t ty) const {
+		uint32_t slot = slots()[ty * header()->tilesX + tx];
+		return slot ? tileCells(slot) : NULL;
+	}
+
+	int8_t getUniform(uint32_t tx, uint32_t ty) const {
+		return uniforms()[ty * header()->tilesX + tx];
+	}
+
+	int8_t getCell(uint32_t x, uint32_t y) const {
+		uint32_t tx = x >> SHARED_MAP_TILE_SHIFT;
+		uint32_t ty = y >> SHARED_MAP_TILE_SHIFT;
+		const int8_t* p_tile = getTile(tx, ty);
+		return p_tile ? p_tile[((y & SHARED_MAP_TILE_MASK) << SHARED_MAP_TILE_SHIFT) | (x & SHARED_MAP_TILE_MASK)] :
+				getUniform(tx, ty);
+	}
+
+	//copy the cells row by row into width * height cells, as in nav_msgs/OccupancyGrid
+	void copyTo(int8_t* p_out) const {
+		uint32_t width = getWidth();
+		for (uint32_t ty = 0; ty < getTilesY(); ty++) {
+			for (uint32_t tx = 0; tx < getTilesX(); tx++) {
+				uint32_t x0 = tx << SHARED_MAP_TILE_SHIFT;
+				uint32_t y0 = ty << SHARED_MAP_TILE_SHIFT;
+				uint32_t columns = std::min(width - x0, SHARED_MAP_TILE_SIZE);
+				uint32_t rows = std::min(getHeight() - y0, SHARED_MAP_TILE_SIZE);
+				const int8_t* p_tile = getTile(tx, ty);
+				for (uint32_t y = 0; y < rows; y++) {
+					int8_t* p_row = p_out + size_t(y0 + y) * width + x0;
+					if (p_tile) {
+						memcpy(p_row, p_tile + (y << SHARED_MAP_TILE_SHIFT), columns);
+					} else {
+						memset(p_row, getUniform(tx, ty), columns);
+					}
+				}
+			}
+		}
+	}
+};
+
+#endif /* SHARED_MAP_H_ */
@@ -13,8 +13,21 @@
 #include <stdio.h>
 #include <string>
 #include <ios>
+#include <cstring>
+#include <cctype>
+#include <climits>
+#include <cstdlib>
+#include <limits>
+#include <list>
+#include <map>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <boost/shared_ptr.hpp>
 
 #include <skynav_msgs/mapreader_srv.h>
+#include <skynav_slam/shared_map.h>
 
 const int LOOP_RATE = 1;
 const int NO_LOOP = 0;
@@ -22,6 +35,28 @@ const int NO_LOOP = 0;
 const int OCCUPIED = 100;
 const int CFREE = 0;
 
+/*
+ * the binary map format: the header, followed by the cells row by row as int8 occupancy values.
+ * RLE stores the cells as runs of a uint32 length and an int8 value, 5 bytes each. little endian, as the robots
+ */
+const char BINARY_MAP_MAGIC[8] = {'S', 'K', 'Y', 'N', 'A', 'V', 'M', 'P'};
+const uint32_t BINARY_MAP_VERSION = 1;
+const uint32_t ENCODING_RAW = 0;
+const uint32_t ENCODING_RLE = 1;
+const size_t RLE_RUN_SIZE = 5;
+const size_t MAX_MAP_CELLS = size_t(1) << 28;	//a map file with more cells is taken for a damaged one
+const float PGM_FREE_THRESHOLD = 0.196;	//pixels darker than this fraction of black are objects, as map_server
+const int MAP_CACHE_MB = 256;	//memory for the cells of the cached maps, parameter ~map_cache_mb
+
+struct Binary_Map_Header {
+	char magic[8];
+	uint32_t version;
+	uint32_t width;
+	uint32_t height;
+	float resolution;
+	uint32_t encoding;
+};
+
 struct Map_Info {
 	float mapHight;
 	float mapWidth;
@@ -32,6 +67,402 @@ struct Map_Info {
 	}
 };
 
+//a file mapped read-only into memory, for as long as the object lives
+class Mapped_File {
+private:
+	int fd_;
+	const char* p_data_;
+	size_t size_;
+
+public:
+	Mapped_File(const std::string &file_path);
+	virtual ~Mapped_File();
+
+	bool good() const;
+	const char* data() const;
+	size_t size() const;
+};
+
+Mapped_File::Mapped_File(const std::string &file_path) :
+		fd_(-1), p_data_(NULL), size_(0) {
+	fd_ = open(file_path.c_str(), O_RDONLY);
+	struct stat st;
+	if (fd_ < 0 || fstat(fd_, &st) != 0 || st.st_size == 0) {
+		return;
+	}
+	void* p_map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd_, 0);
+	if (p_map == MAP_FAILED) {
+		return;
+	}
+	madvise(p_map, st.st_size, MADV_SEQUENTIAL); //the file is read once, front to back
+	p_data_ = (const char*) p_map;
+	size_ = st.st_size;
+}
+
+Mapped_File::~Mapped_File() {
+	if (p_data_) {
+		munmap((void*) p_data_, size_);
+	}
+	if (fd_ >= 0) {
+		close(fd_);
+	}
+}
+
+bool Mapped_File::good() const {
+	return p_data_ != NULL;
+}
+
+const char* Mapped_File::data() const {
+	return p_data_;
+}
+
+size_t Mapped_File::size() const {
+	return size_;
+}
+
+/*
+ * '#' is an object, any other character free space.
+ * without branches, so the compiler turns the loop into vector compares (see CMakeLists.txt)
+ */
+void classifyRow(const char* p_in, size_t n, int8_t* p_out) {
+	for (size_t i = 0; i < n; i++) {
+		p_out[i] = (p_in[i] == '#') * OCCUPIED;
+	}
+}
+
+/*
+ * the ASCII map: one line per row, a character per cell. '\r' before a line end is ignored.
+ * the width is the length of the first line, shorter lines are free space to the end, longer ones are cut off
+ */
+bool parseAsciiMap(const char* p_data, size_t size, Map_Info &info) {
+	const char* p_end = p_data + size;
+	size_t width = 0;
+	size_t height = 0;
+	for (const char* p_line = p_data; p_line < p_end; height++) {
+		const char* p_eol = (const char*) memchr(p_line, '\n', p_end - p_line);
+		if (height == 0) {
+			width = (p_eol ? p_eol : p_end) - p_line;
+			if (width > 0 && p_line[width - 1] == '\r') {
+				width--;
+			}
+		}
+		p_line = p_eol ? p_eol + 1 : p_end;
+	}
+	if (width == 0) {
+		ROS_ERROR("map has no cells");
+		return false;
+	}
+
+	info.mOccupancydata.assign(width * height, CFREE);
+	int8_t* p_row = &info.mOccupancydata[0];
+	bool ragged = false;
+	for (const char* p_line = p_data; p_line < p_end; p_row += width) {
+		const char* p_eol = (const char*) memchr(p_line, '\n', p_end - p_line);
+		size_t length = (p_eol ? p_eol : p_end) - p_line;
+		if (length > 0 && p_line[length - 1] == '\r') {
+			length--;
+		}
+		ragged = ragged || length != width;
+		classifyRow(p_line, std::min(length, width), p_row);
+		p_line = p_eol ? p_eol + 1 : p_end;
+	}
+	if (ragged) {
+		ROS_WARN("map lines differ in length, rows are cut off or filled with free space to %zu cells", width);
+	}
+	info.mapWidth = width;
+	info.mapHight = height;
+	//TODO resolution!! default = 1
+	info.resolution = 1;
+	return true;
+}
+
+//next number in a PGM header, skipping white space and comments
+bool readPgmNumber(const char* &p, const char* p_end, unsigned long &value) {
+	while (p < p_end && (isspace(*p) || *p == '#')) {
+		if (*p == '#') {
+			while (p < p_end && *p != '\n') {
+				p++;
+			}
+		} else {
+			p++;
+		}
+	}
+	if (p == p_end || !isdigit(*p)) {
+		return false;
+	}
+	value = 0;
+	while (p < p_end && isdigit(*p)) {
+		unsigned long digit = *p - '0';
+		if (value > (0xffffffffUL - digit) / 10) {
+			return false; //numbers in the header are bounded to uint32, as in the binary map header
+		}
+		value = value * 10 + digit;
+		p++;
+	}
+	return true;
+}
+
+//a map of width x height cells, stored in bytes per cell, is not empty and its size does not overflow
+bool validMapSize(unsigned long width, unsigned long height, size_t bytes) {
+	return width != 0 && height != 0 && width <= std::numeric_limits<size_t>::max() / height / bytes
+			&& size_t(width) * height <= MAX_MAP_CELLS;
+}
+
+/*
+ * a binary (P5) PGM image, the first row of the image is the first row of the map. dark pixels are objects,
+ * pixels that are neither white nor black (unknown space) are objects too, the planner only knows free and objects
+ */
+bool parsePgmMap(const char* p_data, size_t size, Map_Info &info) {
+	const char* p = p_data + 2;
+	const char* p_end = p_data + size;
+	unsigned long width, height, maxval;
+	if (!readPgmNumber(p, p_end, width) || !readPgmNumber(p, p_end, height) || !readPgmNumber(p, p_end, maxval)
+			|| maxval == 0 || maxval > 65535 || p == p_end) {
+		ROS_ERROR("invalid PGM header");
+		return false;
+	}
+	p++; //a single white space ends the header
+	size_t bytes = maxval < 256 ? 1 : 2;
+	if (!validMapSize(width, height, bytes)) {
+		ROS_ERROR("PGM of %lu x %lu pixels is not supported", width, height);
+		return false;
+	}
+	if (size_t(p_end - p) < width * height * bytes) {
+		ROS_ERROR("PGM holds less than %lu x %lu pixels", width, height);
+		return false;
+	}
+
+	info.mOccupancydata.resize(width * height);
+	int8_t* p_out = &info.mOccupancydata[0];
+	const unsigned char* p_in = (const unsigned char*) p;
+	unsigned int threshold = maxval * (1 - PGM_FREE_THRESHOLD);
+	if (bytes == 1) {
+		for (size_t i = 0; i < width * height; i++) {
+			p_out[i] = (p_in[i] <= threshold) * OCCUPIED;
+		}
+	} else {
+		for (size_t i = 0; i < width * height; i++) {
+			p_out[i] = ((unsigned int) (p_in[2 * i] << 8 | p_in[2 * i + 1]) <= threshold) * OCCUPIED;
+		}
+	}
+	info.mapWidth = width;
+	info.mapHight = height;
+	info.resolution = 1;
+	return true;
+}
+
+//the binary map format, raw or run-length encoded
+bool parseBinaryMap(const char* p_data, size_t size, Map_Info &info) {
+	Binary_Map_Header header;
+	if (size < sizeof(header)) {
+		ROS_ERROR("binary map header is cut off");
+		return false;
+	}
+	memcpy(&header, p_data, sizeof(header));
+	if (header.version != BINARY_MAP_VERSION) {
+		ROS_ERROR("binary map version %u is not supported", header.version);
+		return false;
+	}
+	if (!validMapSize(header.width, header.height, 1)) {
+		ROS_ERROR("binary map of %u x %u cells is not supported", header.width, header.height);
+		return false;
+	}
+	const char* p = p_data + sizeof(header);
+	size_t cells = size_t(header.width) * header.height;
+	size_t left = size - sizeof(header);
+	if (header.encoding == ENCODING_RAW) {
+		if (left < cells) {
+			ROS_ERROR("binary map holds less than %u x %u cells", header.width, header.height);
+			return false;
+		}
+		info.mOccupancydata.assign((const int8_t*) p, (const int8_t*) p + cells);
+	} else if (header.encoding == ENCODING_RLE) {
+		//the runs are checked before the cells are allocated, a damaged header allocates nothing
+		size_t total = 0;
+		bool fits = left % RLE_RUN_SIZE == 0;
+		for (size_t offset = 0; fits && offset < left; offset += RLE_RUN_SIZE) {
+			uint32_t length;
+			memcpy(&length, p + offset, sizeof(length));
+			fits = length <= cells - total;
+			total += fits ? length : 0;
+		}
+		if (!fits || total != cells) {
+			ROS_ERROR("binary map runs do not add up to %u x %u cells", header.width, header.height);
+			return false;
+		}
+		info.mOccupancydata.resize(cells);
+		size_t filled = 0;
+		for (; left > 0; p += RLE_RUN_SIZE, left -= RLE_RUN_SIZE) {
+			uint32_t length;
+			memcpy(&length, p, sizeof(length));
+			memset(&info.mOccupancydata[0] + filled, p[sizeof(length)], length);
+			filled += length;
+		}
+	} else {
+		ROS_ERROR("binary map encoding %u is not supported", header.encoding);
+		return false;
+	}
+	info.mapWidth = header.width;
+	info.mapHight = header.height;
+	info.resolution = header.resolution;
+	return true;
+}
+
+/*
+ * read a map file into info. the file is mapped into memory and parsed in place, the format is recognised by its
+ * first bytes: the binary map format, a binary PGM image, or else the ASCII map
+ */
+bool parseMapFile(const std::string &file_path, Map_Info &info) {
+	Mapped_File file(file_path);
+	if (!file.good()) {
+		ROS_ERROR("file %s does not exist or is empty", file_path.c_str());
+		return false;
+	}
+	info.mOccupancydata.clear();
+	if (file.size() >= sizeof(BINARY_MAP_MAGIC) && memcmp(file.data(), BINARY_MAP_MAGIC, sizeof(BINARY_MAP_MAGIC)) == 0) {
+		return parseBinaryMap(file.data(), file.size(), info);
+	}
+	if (file.size() >= 2 && file.data()[0] == 'P' && file.data()[1] == '5') {
+		return parsePgmMap(file.data(), file.size(), info);
+	}
+	return parseAsciiMap(file.data(), file.size(), info);
+}
+
+/*
+ * write a map in the binary map format, run-length encoded or raw.
+ * written to a temporary file first, so a reader never sees half a map
+ */
+bool writeBinaryMap(const std::string &file_path, const Map_Info &info, bool rle) {
+	std::string tmp_path = file_path + ".tmp";
+	FILE* p_file = fopen(tmp_path.c_str(), "wb");
+	if (!p_file) {
+		ROS_ERROR("can not write %s", tmp_path.c_str());
+		return false;
+	}
+	Binary_Map_Header header;
+	memcpy(header.magic, BINARY_MAP_MAGIC, sizeof(header.magic));
+	header.version = BINARY_MAP_VERSION;
+	header.width = info.mapWidth;
+	header.height = info.mapHight;
+	header.resolution = info.resolution;
+	header.encoding = rle ? ENCODING_RLE : ENCODING_RAW;
+	bool ok = fwrite(&header, sizeof(header), 1, p_file) == 1;
+
+	const std::vector<int8_t> &data = info.mOccupancydata;
+	if (!rle) {
+		ok = ok && (data.empty() || fwrite(&data[0], data.size(), 1, p_file) == 1);
+	}
+	for (size_t i = 0; rle && ok && i < data.size();) {
+		size_t j = i;
+		while (j < data.size() && data[j] == data[i] && j - i < 0xffffffffu) {
+			j++;
+		}
+		char run[RLE_RUN_SIZE];
+		uint32_t length = j - i;
+		memcpy(run, &length, sizeof(length));
+		run[sizeof(length)] = data[i];
+		ok = fwrite(run, RLE_RUN_SIZE, 1, p_file) == 1;
+		i = j;
+	}
+	ok = (fclose(p_file) == 0) && ok;
+	if (!ok || rename(tmp_path.c_str(), file_path.c_str()) != 0) {
+		ROS_ERROR("writing %s failed", file_path.c_str());
+		remove(tmp_path.c_str());
+		return false;
+	}
+	return true;
+}
+
+/*
+ * the maps that were read last, so a map that is asked for again is not parsed again. a map is known by the canonical
+ * path of its file and only taken from the cache while the file has the modification time and size it had when it
+ * was parsed, so a map that was edited is read again. the maps used longest ago are dropped when the cells of all
+ * maps take more memory than the limit, a map larger than the limit is not cached at all
+ */
+class Map_Cache {
+private:
+	struct Entry {
+		std::string path;
+		struct timespec mtime;
+		off_t size;
+		boost::shared_ptr<const Map_Info> p_info;
+	};
+	typedef std::list<Entry>::iterator Entry_It;
+
+	std::list<Entry> entries_;	//most recently used first
+	std::map<std::string, Entry_It> index_;	//the entries by path
+	size_t capacity_;
+	size_t used_;
+
+	static size_t bytes(const Entry &entry) {
+		return entry.p_info->mOccupancydata.size();
+	}
+
+	void erase(Entry_It it) {
+		used_ -= bytes(*it);
+		index_.erase(it->path);
+		entries_.erase(it);
+	}
+
+public:
+	Map_Cache(size_t capacity) :
+			capacity_(capacity), used_(0) {
+	}
+
+	void setCapacity(size_t capacity) {
+		capacity_ = capacity;
+		while (used_ > capacity_) {
+			erase(--entries_.end());
+		}
+	}
+
+	size_t getCount() const {
+		return entries_.size();
+	}
+
+	size_t getUsed() const {
+		return used_;
+	}
+
+	//the map parsed from the file at path when st is the state of the file it was parsed from, else an empty pointer
+	boost::shared_ptr<const Map_Info> find(const std::string &path, const struct stat &st) {
+		std::map<std::string, Entry_It>::iterator found = index_.find(path);
+		if (found == index_.end()) {
+			return boost::shared_ptr<const Map_Info>();
+		}
+		Entry_It it = found->second;
+		if (it->mtime.tv_sec != st.st_mtim.tv_sec || it->mtime.tv_nsec != st.st_mtim.tv_nsec
+				|| it->size != st.st_size) {
+			erase(it);	//the file was changed
+			return boost::shared_ptr<const Map_Info>();
+		}
+		entries_.splice(entries_.begin(), entries_, it);
+		return it->p_info;
+	}
+
+	//keep the map parsed from the file at path, st is the state of the file it was parsed from
+	void insert(const std::string &path, const struct stat &st, const boost::shared_ptr<const Map_Info> &p_info) {
+		std::map<std::string, Entry_It>::iterator found = index_.find(path);
+		if (found != index_.end()) {
+			erase(found->second);
+		}
+		Entry entry;
+		entry.path = path;
+		entry.mtime = st.st_mtim;
+		entry.size = st.st_size;
+		entry.p_info = p_info;
+		if (bytes(entry) > capacity_) {
+			return;
+		}
+		entries_.push_front(entry);
+		index_[path] = entries_.begin();
+		used_ += bytes(entry);
+		while (used_ > capacity_) {
+			erase(--entries_.end());
+		}
+	}
+};
+
 class Map_Reader {
 private:
 	std::string node_name_;
@@ -41,12 +472,17 @@ private:
 	//service
 	ros::ServiceServer read_map_serv_;
 
-	Map_Info* p_mMap_Info;
+	boost::shared_ptr<const Map_Info> p_mMap_Info;	//the map that was read, until it is shared
+	Map_Cache map_cache_;
+	Shared_Map shared_map_;	//the cells of the last map read, for the other nodes
+	uint32_t map_version_;
 
 public:
 	Map_Reader(std::string node_name);
 	virtual ~Map_Reader() {
-		delete p_mMap_Info;
+		if (shared_map_.isOpen()) {
+			Shared_Map::remove(shared_map_.getName());
+		}
 		delete node_;
 	}
 	;
@@ -55,33 +491,33 @@ public:
 	bool respond(skynav_msgs::mapreader_srv::Request &req,
 			skynav_msgs::mapreader_srv::Response &res);
 	bool parseMap(std::string filepath);
-
-	Map_Info* getMapData() const;
+	bool shareMap();
 };
 
 Map_Reader::Map_Reader(std::string node_name) :
-		node_name_(node_name) {
+		node_name_(node_name), map_cache_(size_t(MAP_CACHE_MB) << 20) {
 
 	node_ = new ros::NodeHandle("/SLAM");
 
 	read_map_serv_ = node_->advertiseService("map_read_req",&Map_Reader::respond, this);
 
-	p_mMap_Info = new Map_Info();
+	int cache_mb;
+	ros::NodeHandle("~").param("map_cache_mb", cache_mb, MAP_CACHE_MB);
+	map_cache_.setCapacity(size_t(std::max(cache_mb, 0)) << 20);
+	map_version_ = time(NULL); //versions are not repeated when map_reader is restarted
 }
 
 bool Map_Reader::respond(skynav_msgs::mapreader_srv::Request &req,
 		skynav_msgs::mapreader_srv::Response &res) {
 	if (req.request) {
 		ROS_INFO("received map read request");
-		if (parseMap(req.file_path)) {
+		if (parseMap(req.file_path) && shareMap()) {
 			res.response = 1;
-			res.map.info.height = this->getMapData()->mapHight;
-			res.map.info.width = this->getMapData()->mapWidth;
-			res.map.info.resolution = this->getMapData()->resolution;
-			res.map.data.clear();
-			for(int i = 0; i<this->getMapData()->mOccupancydata.size(); i++){
-				res.map.data.push_back(this->getMapData()->mOccupancydata[i]);
-			}
+			res.map.info.height = shared_map_.getHeight();
+			res.map.info.width = shared_map_.getWidth();
+			res.map.info.resolution = shared_map_.getResolution();
+			res.segment = shared_map_.getName();
+			res.version = shared_map_.getVersion();
 			return true;
 		}
 	}
@@ -89,62 +525,77 @@ bool Map_Reader::respond(skynav_msgs::mapreader_srv::Request &req,
 	return false;
 }
 
+/*
+ * read a map, from the cache when its file did not change since it was parsed. a map that is parsed is cached when
+ * its file did not change while it was parsed either
+ */
 bool Map_Reader::parseMap(std::string file_path) {
-	ROS_INFO("parsing map %s", file_path.c_str());
-
-	std::ifstream file(file_path.c_str());
-	file.unsetf(std::ios_base::skipws);
-	std::vector<char> tempArray;
-	if (file.good()) {
-		p_mMap_Info->mOccupancydata.clear();
-		int xDim = 0;
-		int yDim = 0;
-
-		for (char c; file >> c;) {
-			tempArray.push_back(c);
-		}
-
-		std::vector<int8_t> data;
-		int object = OCCUPIED;	//integer value for gridcell occupied
-		int empty = CFREE;		//integer value for gridcell empty
-		for (int i = 0; i < tempArray.size(); i++) {
-			if (tempArray[i] == '#') {
-				data.push_back(object);
-			} else if (tempArray[i] == '\n') {
-				yDim += 1;
-			} else {
-				data.push_back(empty);
-
-			}
-		}
-		xDim = data.size() / yDim;
-
-		this->p_mMap_Info->mapWidth = xDim;
-		this->p_mMap_Info->mapHight = yDim;
-		//TODO resolution!! default = 1
-		this->p_mMap_Info->resolution = 1;
-
-		this->p_mMap_Info->mOccupancydata = data;
-
-		data.clear();
-		tempArray.clear();
-
-		ROS_INFO("parsing map done");
+	char canonical[PATH_MAX];
+	struct stat st;
+	if (!realpath(file_path.c_str(), canonical) || stat(canonical, &st) != 0) {
+		ROS_ERROR("file %s does not exist", file_path.c_str());
+		return false;
+	}
+	p_mMap_Info = map_cache_.find(canonical, st);
+	if (p_mMap_Info) {
+		ROS_INFO("map %s taken from the cache", canonical);
 		return true;
 	}
-	ROS_ERROR("file %s does not exist", file_path.c_str());
-	return false;
+
+	ROS_INFO("parsing map %s", canonical);
+	ros::WallTime start = ros::WallTime::now();
+	boost::shared_ptr<Map_Info> p_info(new Map_Info());
+	if (!parseMapFile(canonical, *p_info)) {
+		return false;
+	}
+	ROS_INFO("parsing map done, %.0f x %.0f cells in %.3f s", p_info->mapWidth, p_info->mapHight,
+			(ros::WallTime::now() - start).toSec());
+	struct stat parsed;
+	if (stat(canonical, &parsed) == 0 && parsed.st_mtim.tv_sec == st.st_mtim.tv_sec
+			&& parsed.st_mtim.tv_nsec == st.st_mtim.tv_nsec && parsed.st_size == st.st_size) {
+		map_cache_.insert(canonical, st, p_info);
+		ROS_INFO("%zu maps cached in %zu bytes", map_cache_.getCount(), map_cache_.getUsed());
+	}
+	p_mMap_Info = p_info;
+	return true;
 }
 
-Map_Info* Map_Reader::getMapData() const {
-	return p_mMap_Info;
+/*
+ * place the map that was read in a new shared memory segment and remove the segment of the previous map.
+ * the cells are only kept in the segment, in tiles, and in the cache
+ */
+bool Map_Reader::shareMap() {
+	Shared_Map shared_map;
+	if (p_mMap_Info->mOccupancydata.empty()
+			|| !shared_map.create(++map_version_, p_mMap_Info->mapWidth, p_mMap_Info->mapHight,
+					p_mMap_Info->resolution, &p_mMap_Info->mOccupancydata[0])) {
+		ROS_ERROR("no shared memory segment for the map");
+		return false;
+	}
+	p_mMap_Info.reset();
+	ROS_INFO("map shared in %u of %u tiles", shared_map.getTileCount(), shared_map.getTilesX() * shared_map.getTilesY());
+	if (shared_map_.isOpen()) {
+		Shared_Map::remove(shared_map_.getName());
+	}
+	shared_map_.close();
+	shared_map_.open(shared_map.getName(), map_version_);
+	return true;
 }
 
 void Map_Reader::loop() {
 	ros::spin();
 }
 
+/*
+ * map_reader serves the maps to the other nodes.
+ * map_reader --convert <map> <binary map> [--rle] converts a map to the binary map format and exits
+ */
 int main(int argc, char ** argv) {
+	if (argc >= 4 && std::string(argv[1]) == "--convert") {
+		Map_Info info;
+		bool rle = argc >= 5 && std::string(argv[4]) == "--rle";
+		return parseMapFile(argv[2], info) && writeBinaryMap(argv[3], info, rle) ? 0 : 1;
+	}
 	std::string node_name = "map_reader";
 	ros::init(argc, argv, node_name);
 	